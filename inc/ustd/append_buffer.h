@@ -0,0 +1,105 @@
+/**
+ * @file append_buffer.h
+ * @author gabriel
+ * @brief Fixed-capacity buffers that many threads can append to without a mutex, and that a single
+ * consumer thread drains.
+ * Producers reserve slots with an atomic operation on the reservation cursor, which never blocks, copy their
+ * element, then publish it by advancing a commit cursor in reservation order. Publishing is blocking : a
+ * producer spins until all producers that reserved before it have published, so a producer preempted between
+ * its reservation and its commit stalls the ones after it.
+ * The consumer only ever sees fully-written elements, handed out as contiguous views. Slots are reused once
+ * the consumer releases them.
+ *
+ * @code
+ * // producer threads
+ * append_buffer_push(events, &event);
+ *
+ * // consumer thread
+ * ARRAY_VIEW span = { 0 };
+ * while (append_buffer_drain(events, &span)) {
+ *     process(span);
+ *     append_buffer_release(events, span.length);
+ * }
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-07-30
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_APPEND_BUFFER_H__
+#define UNSTANDARD_APPEND_BUFFER_H__
+
+#include "array_view.h"
+
+#define APPEND_BUFFER(type_) type_ *
+#define APPEND_BUFFER_ANY void *
+
+/**
+ * @brief Creates an empty append buffer by allocating its memory. The buffer never grows, since
+ * producers may be writing in it at any time.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] size_element size, in bytes, of a single element
+ * @param[in] nb_elements_max number of elements the buffer can hold before they are released
+ * @return APPEND_BUFFER_ANY the buffer created
+ */
+APPEND_BUFFER_ANY append_buffer_create(allocator alloc, u32 size_element, size_t nb_elements_max);
+
+/**
+ * @brief Frees an append buffer from the allocator it was created with. No thread should be using the
+ * buffer anymore.
+ * The pointer to the buffer given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the buffer
+ * @param[inout] buffer pointer to the freed buffer
+ */
+void append_buffer_destroy(allocator alloc, APPEND_BUFFER_ANY *buffer);
+
+/**
+ * @brief Appends a value (by shallow copy) to a buffer. Safe to call from any number of threads at once.
+ * Returns once the value is visible to the consumer, which can mean waiting for producers that reserved
+ * a slot earlier to publish theirs.
+ *
+ * @param[inout] buffer target buffer
+ * @param[in] value pointer to the appended value
+ * @return true if the value was appended
+ * @return false if the buffer was full
+ */
+bool append_buffer_push(APPEND_BUFFER_ANY buffer, const void *value);
+
+/**
+ * @brief Hands out the oldest published elements that were not released yet, as one contiguous view.
+ * When the published elements wrap around the end of the buffer, only the part up to the end is handed
+ * out ; the rest comes with the next call. Must only be called from the consumer thread.
+ *
+ * @param[in] buffer target buffer
+ * @param[out] out_span view over the ready elements
+ * @return true if some elements were ready
+ * @return false otherwise
+ */
+bool append_buffer_drain(APPEND_BUFFER_ANY buffer, ARRAY_VIEW *out_span);
+
+/**
+ * @brief Gives back the first elements handed out by append_buffer_drain(), so producers can reuse their
+ * slots. Must only be called from the consumer thread.
+ *
+ * @param[inout] buffer target buffer
+ * @param[in] nb_elements number of released elements
+ */
+void append_buffer_release(APPEND_BUFFER_ANY buffer, size_t nb_elements);
+
+/**
+ * @brief Returns the number of published elements that were not released yet.
+ *
+ * @param[in] buffer target buffer
+ * @return size_t
+ */
+size_t append_buffer_length(APPEND_BUFFER_ANY buffer);
+
+#ifdef UNITTESTING
+void append_buffer_execute_unittests(void);
+#endif
+
+#endif
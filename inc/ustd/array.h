@@ -191,6 +191,40 @@ void array_ensure_capacity(allocator alloc, ARRAY_ANY *array, size_t additional_
  */
 void array_sort(ARRAY_ANY array, comparator_f comparator);
 
+/**
+ * @brief Re-orders an array so the element at some index is the one that would be there if the array
+ * was sorted. Elements before it are lesser or equal to it, elements after it are greater or equal.
+ * Runs in linear time on average, using a three-way quickselect.
+ *
+ * @param[inout] array a valid array.
+ * @param[in] nth index of the selected element ; nothing is done if it is out of bounds.
+ * @param[in] comparator a comparison function for the type of the element.
+ */
+void array_nth_element(ARRAY_ANY array, size_t nth, comparator_f comparator);
+
+/**
+ * @brief Sorts the `nb_sorted` least elements of an array at its start. The order of the other elements is unspecified.
+ *
+ * @param[inout] array a valid array.
+ * @param[in] nb_sorted number of elements to sort.
+ * @param[in] comparator a comparison function for the type of the element.
+ */
+void array_partial_sort(ARRAY_ANY array, size_t nb_sorted, comparator_f comparator);
+
+/**
+ * @brief Copies the `k` least elements of an array, sorted, into another array. The source array is not
+ * modified. Keeps a heap of `k` elements, so it is best suited for small values of `k`.
+ * Pass an inverted comparator to get the greatest elements.
+ *
+ * @param[in] array a valid array.
+ * @param[in] k number of elements to select ; brought back to the length of the array if greater.
+ * @param[in] comparator a comparison function for the type of the element.
+ * @param[out] out_array array receiving the elements, of the same stride and with enough capacity ; its previous content is lost.
+ * @return true if the elements were selected
+ * @return false if the output array cannot receive them
+ */
+bool array_top_k(ARRAY_ANY array, size_t k, comparator_f comparator, ARRAY_ANY out_array);
+
 /**
  * @brief Returns wether a section of memory is sorted (depending on info given by the user).
  *
@@ -232,6 +266,37 @@ size_t array_sorted_remove(ARRAY_ANY haystack, comparator_f comparator, void *ne
  */
 size_t array_sorted_insert(void *haystack, comparator_f comparator, void *inserted_needle);
 
+/**
+ * @brief Removes, in a single pass, all elements equal to the element before them. On a sorted array, this
+ * keeps one element of each distinct value. The first element of each run of equal elements is the one kept.
+ *
+ * @param[inout] array valid array.
+ * @param[in] comparator a comparison function for the type of the element.
+ * @return size_t the new length of the array.
+ */
+size_t array_unique(ARRAY_ANY array, comparator_f comparator);
+
+/**
+ * @brief Iterates over the runs of consecutive equal elements of an array. Each call yields the run that starts at
+ * the cursor, then moves the cursor past it. On a sorted array, each run holds all elements of one value.
+ *
+ * @code
+ * size_t cursor = 0, begin = 0, end = 0;
+ * while (array_group_runs(ids, &compare_ids, &cursor, &begin, &end)) {
+ *     // elements from begin (included) to end (excluded) are equal
+ * }
+ * @endcode
+ *
+ * @param[in] array valid array.
+ * @param[in] comparator a comparison function for the type of the element.
+ * @param[inout] cursor start of the next run, moved to the end of the yielded run.
+ * @param[out] out_begin index of the first element of the run ; can be NULL.
+ * @param[out] out_end index past the last element of the run ; can be NULL.
+ * @return true if a run was yielded
+ * @return false if the cursor reached the end of the array
+ */
+bool array_group_runs(ARRAY_ANY array, comparator_f comparator, size_t *cursor, size_t *out_begin, size_t *out_end);
+
 
 #ifdef UNITTESTING
 void array_execute_unittests(void);
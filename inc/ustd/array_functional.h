@@ -0,0 +1,104 @@
+/**
+ * @file array_functional.h
+ * @author gabriel
+ * @brief Filter, map and reduce passes over arrays, driven by callbacks.
+ * Every pass can optionally be shared between several threads : the array is cut into blocks of a few
+ * kilobytes that the threads take in turn. The calling thread takes part in the work, and the call only
+ * returns once the whole pass is done.
+ *
+ * @code
+ * static bool is_alive(const void *element, void *context) { return ((const struct entity *) element)->health > 0; }
+ *
+ * array_filter(entities, &is_alive, nullptr, &(array_parallel) { .nb_threads = 8 });
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_ARRAY_FUNCTIONAL_H__
+#define UNSTANDARD_ARRAY_FUNCTIONAL_H__
+
+#include "array.h"
+
+/// Default size, in bytes, of the blocks of elements handed to a thread at once.
+#define ARRAY_PARALLEL_BLOCK_SIZE (32768u)
+/// Maximum number of threads sharing a pass.
+#define ARRAY_PARALLEL_MAX_THREADS (64u)
+
+/**
+ * @brief Describes how a pass is shared between threads.
+ */
+typedef struct array_parallel {
+    /// number of threads working on the pass, the calling one included
+    u32 nb_threads;
+    /// number of elements in a block ; 0 picks blocks of about ARRAY_PARALLEL_BLOCK_SIZE bytes
+    size_t block_length;
+} array_parallel;
+
+/**
+ * @brief Tells if an element is kept by a filter.
+ */
+typedef bool (*array_predicate_f)(const void *element, void *context);
+
+/**
+ * @brief Computes the element of a destination array from the element of a source array.
+ */
+typedef void (*array_transform_f)(const void *element, void *out_element, void *context);
+
+/**
+ * @brief Folds an element into an accumulator of the same type. Must be associative for a parallel reduction.
+ */
+typedef void (*array_combine_f)(void *accumulator, const void *element, void *context);
+
+/**
+ * @brief Removes, in place, the elements of an array for which a predicate returns false. The order of
+ * the kept elements is preserved.
+ * The predicate can be called from several threads at once if the pass is parallel.
+ *
+ * @param[inout] array target array
+ * @param[in] predicate function telling which elements are kept
+ * @param[in] context pointer passed to each call of the predicate ; can be NULL
+ * @param[in] parallel how the pass is shared between threads ; NULL to run it on the calling thread only
+ * @return size_t the new length of the array
+ */
+size_t array_filter(ARRAY_ANY array, array_predicate_f predicate, void *context, const array_parallel *parallel);
+
+/**
+ * @brief Fills a destination array with the transformation of each element of a source array. The two
+ * arrays can have different strides.
+ * The transformation can be called from several threads at once if the pass is parallel.
+ *
+ * @param[in] array source array
+ * @param[in] transform function computing an element of the destination from an element of the source
+ * @param[in] context pointer passed to each call of the transformation ; can be NULL
+ * @param[out] out_array destination array, with enough capacity for all elements of the source ; its previous content is lost
+ * @param[in] parallel how the pass is shared between threads ; NULL to run it on the calling thread only
+ * @return true if the destination was filled
+ * @return false if the destination did not have space
+ */
+bool array_map(ARRAY_ANY array, array_transform_f transform, void *context, ARRAY_ANY out_array, const array_parallel *parallel);
+
+/**
+ * @brief Folds all elements of an array into an accumulator, in order.
+ * If the pass is parallel, each thread folds its own blocks into a copy of the initial accumulator, and
+ * the partial results are then folded into the accumulator in the order of the array. The initial value
+ * must thus be an identity of the combination (0 for a sum, 1 for a product...).
+ *
+ * @param[in] array source array
+ * @param[in] combine function folding an element into the accumulator
+ * @param[in] context pointer passed to each call of the combination ; can be NULL
+ * @param[inout] inout_accumulator value of the stride of the array, holding the initial value and receiving the result
+ * @param[in] parallel how the pass is shared between threads ; NULL to run it on the calling thread only
+ * @return true if the array was reduced
+ * @return false otherwise
+ */
+bool array_reduce(ARRAY_ANY array, array_combine_f combine, void *context, void *inout_accumulator, const array_parallel *parallel);
+
+#ifdef UNITTESTING
+void array_functional_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file array_typed.h
+ * @author gabriel
+ * @brief Generates array operations specialized for one element type and one comparator.
+ * The generated functions work on arrays created with array.h and can be freely mixed with the
+ * type-erased functions of that header : only the element copies and the comparisons change, so the
+ * compiler can inline them.
+ *
+ * @version 0.1
+ * @date 2025-07-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_ARRAY_TYPED_H__
+#define UNSTANDARD_ARRAY_TYPED_H__
+
+#include "../ustd_impl/array_impl.h"
+
+#ifdef DEBUG
+#include <assert.h>
+/// Catches typed operations on arrays created for another element size, in debug builds.
+#define ARRAY_TYPED_CHECK_STRIDE(impl_, type_) assert((impl_)->stride == sizeof(type_))
+#else
+#define ARRAY_TYPED_CHECK_STRIDE(impl_, type_) ((void) 0)
+#endif
+
+/**
+ * @brief Defines the static inline functions `array_<name_>_push`, `array_<name_>_insert`,
+ * `array_<name_>_sort`, `array_<name_>_find` and `array_<name_>_sorted_find` for arrays of `type_`.
+ * The comparator follows the comparator_f signature, so the same function can be passed to the generic
+ * functions of array.h.
+ * As in array.h, `find` passes the element first and `sorted_find` passes the needle first.
+ * The arrays must have been created with a stride of `sizeof(type_)`, which is asserted in debug builds.
+ */
+#define ARRAY_DEFINE_NAMED(name_, type_, comparator_) \
+        static inline struct array_impl *array_##name_##_impl_of(ARRAY(type_) array) \
+        { \
+            struct array_impl *target = CONTAINER_OF(array, struct array_impl, data); \
+            \
+            ARRAY_TYPED_CHECK_STRIDE(target, type_); \
+            return target; \
+        } \
+        \
+        static inline bool array_##name_##_insert(ARRAY(type_) array, size_t index, type_ value) \
+        { \
+            struct array_impl *target = nullptr; \
+            \
+            if (!array) { \
+                return false; \
+            } \
+            \
+            target = array_##name_##_impl_of(array); \
+            \
+            if ((target->length >= target->capacity) || (index > target->length)) { \
+                return false; \
+            } \
+            \
+            for (size_t i = target->length ; i > index ; i--) { \
+                array[i] = array[i - 1]; \
+            } \
+            array[index] = value; \
+            target->length += 1; \
+            \
+            return true; \
+        } \
+        \
+        static inline bool array_##name_##_push(ARRAY(type_) array, type_ value) \
+        { \
+            struct array_impl *target = nullptr; \
+            \
+            if (!array) { \
+                return false; \
+            } \
+            \
+            target = array_##name_##_impl_of(array); \
+            \
+            if (target->length >= target->capacity) { \
+                return false; \
+            } \
+            \
+            array[target->length] = value; \
+            target->length += 1; \
+            \
+            return true; \
+        } \
+        \
+        static inline void array_##name_##_heapify(ARRAY(type_) array, size_t length_heap, size_t index) \
+        { \
+            size_t imax = index; \
+            size_t left = 0; \
+            size_t right = 0; \
+            type_ tmp; \
+            \
+            for (;;) { \
+                left = (index << 1u) + 1u; \
+                right = left + 1u; \
+                imax = index; \
+                \
+                if ((right < length_heap) && (comparator_(array + right, array + imax) > 0)) { \
+                    imax = right; \
+                } \
+                if ((left < length_heap) && (comparator_(array + left, array + imax) > 0)) { \
+                    imax = left; \
+                } \
+                if (imax == index) { \
+                    return; \
+                } \
+                \
+                tmp = array[imax]; \
+                array[imax] = array[index]; \
+                array[index] = tmp; \
+                index = imax; \
+            } \
+        } \
+        \
+        static inline void array_##name_##_sort(ARRAY(type_) array) \
+        { \
+            size_t length = 0; \
+            type_ tmp; \
+            \
+            if (!array) { \
+                return; \
+            } \
+            \
+            length = array_##name_##_impl_of(array)->length; \
+            if (length < 2u) { \
+                return; \
+            } \
+            \
+            for (size_t i = (length / 2u) ; i > 0u ; i--) { \
+                array_##name_##_heapify(array, length, i - 1u); \
+            } \
+            \
+            for (size_t i = (length - 1u) ; i > 0u ; i--) { \
+                tmp = array[0]; \
+                array[0] = array[i]; \
+                array[i] = tmp; \
+                array_##name_##_heapify(array, i, 0u); \
+            } \
+        } \
+        \
+        static inline bool array_##name_##_find(ARRAY(type_) haystack, type_ needle, size_t *out_position) \
+        { \
+            size_t length = 0; \
+            \
+            if (!haystack) { \
+                return false; \
+            } \
+            \
+            length = array_##name_##_impl_of(haystack)->length; \
+            for (size_t i = 0 ; i < length ; i++) { \
+                if (comparator_(haystack + i, &needle) == 0) { \
+                    if (out_position) { \
+                        *out_position = i; \
+                    } \
+                    return true; \
+                } \
+            } \
+            \
+            return false; \
+        } \
+        \
+        static inline bool array_##name_##_sorted_find(ARRAY(type_) haystack, type_ needle, size_t *out_position) \
+        { \
+            size_t low = 0; \
+            size_t high = 0; \
+            size_t middle = 0; \
+            \
+            if (!haystack) { \
+                return false; \
+            } \
+            \
+            high = array_##name_##_impl_of(haystack)->length; \
+            while (low < high) { \
+                middle = low + ((high - low) / 2u); \
+                if (comparator_(&needle, haystack + middle) > 0) { \
+                    low = middle + 1u; \
+                } else { \
+                    high = middle; \
+                } \
+            } \
+            \
+            if (out_position) { \
+                *out_position = low; \
+            } \
+            \
+            return (low < array_##name_##_impl_of(haystack)->length) && (comparator_(&needle, haystack + low) == 0); \
+        }
+
+/**
+ * @brief Shorthand of ARRAY_DEFINE_NAMED() for types that are a single identifier (u32, f32, ...).
+ */
+#define ARRAY_DEFINE(type_, comparator_) \
+        ARRAY_DEFINE_NAMED(type_, type_, comparator_)
+
+#ifdef UNITTESTING
+void array_typed_execute_unittests(void);
+#endif
+
+#ifdef BENCHMARK
+void array_typed_execute_benchmarks(void);
+#endif
+
+#endif
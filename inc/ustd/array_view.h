@@ -0,0 +1,134 @@
+/**
+ * @file array_view.h
+ * @author gabriel
+ * @brief Non-owning, read-only views over contiguous elements : whole arrays, parts of arrays, or any
+ * memory region.
+ * Views are passed by value and never allocate : slicing, splitting and chunking a view only computes
+ * new bounds. The read-only functions of array.h are implemented over views, so both give the same results.
+ *
+ * @version 0.1
+ * @date 2025-07-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_ARRAY_VIEW_H__
+#define UNSTANDARD_ARRAY_VIEW_H__
+
+#include "array.h"
+
+/**
+ * @brief Read-only window over some contiguous elements. Does not own its memory.
+ */
+typedef struct array_view {
+    /// first element of the view
+    const byte *data;
+    /// number of elements in the view
+    size_t length;
+    /// size, in bytes, of a single element
+    u32 stride;
+} array_view;
+
+#define ARRAY_VIEW struct array_view
+
+/**
+ * @brief Creates a view over all elements of an array.
+ *
+ * @param[in] array viewed array
+ * @return ARRAY_VIEW
+ */
+ARRAY_VIEW array_view_of(const ARRAY_ANY array);
+
+/**
+ * @brief Creates a view over some memory region.
+ *
+ * @param[in] memory first element of the region
+ * @param[in] nb_elements number of elements in the region
+ * @param[in] size_element size, in bytes, of a single element
+ * @return ARRAY_VIEW
+ */
+ARRAY_VIEW array_view_from_mem(const void *memory, size_t nb_elements, u32 size_element);
+
+/**
+ * @brief Creates a view over part of another view. Indexes are brought back in bounds if they are
+ * beyond the length of the view.
+ *
+ * @param[in] view sliced view
+ * @param[in] start_index first index of the slice, included
+ * @param[in] end_index last index of the slice, excluded
+ * @return ARRAY_VIEW
+ */
+ARRAY_VIEW array_view_slice(ARRAY_VIEW view, size_t start_index, size_t end_index);
+
+/**
+ * @brief Splits a view in two at some index. The index is brought back in bounds if it is beyond the
+ * length of the view.
+ *
+ * @param[in] view split view
+ * @param[in] index first index of the right part
+ * @param[out] out_left elements before the index ; can be NULL
+ * @param[out] out_right elements from the index ; can be NULL
+ */
+void array_view_split(ARRAY_VIEW view, size_t index, ARRAY_VIEW *out_left, ARRAY_VIEW *out_right);
+
+/**
+ * @brief Takes the next chunk of at most `chunk_length` elements from the front of a view, and advances
+ * the view past it. Call it in a loop to iterate over a view chunk by chunk.
+ *
+ * @param[inout] remaining view consumed chunk by chunk
+ * @param[in] chunk_length maximum number of elements in a chunk
+ * @param[out] out_chunk next chunk
+ * @return true if a chunk was taken
+ * @return false if the view was empty
+ */
+bool array_view_next_chunk(ARRAY_VIEW *remaining, size_t chunk_length, ARRAY_VIEW *out_chunk);
+
+/**
+ * @brief Returns a pointer to the element at some index of a view.
+ *
+ * @param[in] view target view
+ * @param[in] index index of the element
+ * @return const void* pointer to the element, or NULL if the index is out of bounds
+ */
+const void *array_view_at(ARRAY_VIEW view, size_t index);
+
+/**
+ * @brief Copy the content of a view at some index and checks bounds.
+ *
+ * @see array_get()
+ */
+bool array_view_get(ARRAY_VIEW view, size_t index, void *out_value);
+
+/**
+ * @brief Iterates through a view and returns the first index for which the comparator returns 0.
+ *
+ * @see array_find()
+ */
+bool array_view_find(ARRAY_VIEW haystack, comparator_f comparator, const void *needle, size_t *out_position);
+
+/**
+ * @brief Iterates through a view and returns the last index for which the comparator returns 0.
+ *
+ * @see array_find_back()
+ */
+bool array_view_find_back(ARRAY_VIEW haystack, comparator_f comparator, const void *needle, size_t *out_position);
+
+/**
+ * @brief Returns wether the elements of a view are sorted.
+ *
+ * @see array_is_sorted()
+ */
+bool array_view_is_sorted(ARRAY_VIEW view, comparator_f comparator);
+
+/**
+ * @brief Find the position of an element in a view that is assumed to be sorted.
+ *
+ * @see array_sorted_find()
+ */
+bool array_view_sorted_find(ARRAY_VIEW haystack, comparator_f comparator, const void *needle, size_t *out_position);
+
+#ifdef UNITTESTING
+void array_view_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ * @file bitset.h
+ * @author gabriel
+ * @brief Compact sets of bits, packed in 64-bit words.
+ * A bitset takes one bit per tracked index where an `ARRAY(u8)` of flags would take a byte. Bulk operations
+ * and counts work a whole word at a time, with the processor's popcount and bit scan instructions.
+ * The words can be read directly through the BITSET pointer, up to bitset_nb_words().
+ *
+ * @code
+ * BITSET seen = bitset_create(alloc, 1000);
+ * bitset_set(seen, 42);
+ *
+ * for (size_t i = 0 ; bitset_next_set(seen, i, &i) ; i++) {
+ *     // i is set
+ * }
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-07-29
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_BITSET_H__
+#define UNSTANDARD_BITSET_H__
+
+#include "array.h"
+
+#define BITSET u64 *
+
+/// Number of bits in a single word of a bitset.
+#define BITSET_WORD_BITS (64u)
+
+/**
+ * @brief Creates a bitset of some number of bits, all cleared.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] nb_bits number of bits in the set
+ * @return BITSET the bitset created
+ */
+BITSET bitset_create(allocator alloc, size_t nb_bits);
+
+/**
+ * @brief Frees a bitset from the allocator it was created with.
+ * The pointer to the bitset given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the bitset
+ * @param[inout] bitset pointer to the freed bitset
+ */
+void bitset_destroy(allocator alloc, BITSET *bitset);
+
+/**
+ * @brief Changes the number of bits in a bitset, re-allocating it if needed. Bits added at the end are cleared.
+ *
+ * @param[in] alloc allocator used to create the bitset
+ * @param[inout] bitset target bitset
+ * @param[in] nb_bits new number of bits in the set
+ */
+void bitset_resize(allocator alloc, BITSET *bitset, size_t nb_bits);
+
+/**
+ * @brief Returns the number of bits in a bitset.
+ *
+ * @param[in] bitset target bitset
+ * @return size_t
+ */
+size_t bitset_length(const BITSET bitset);
+
+/**
+ * @brief Returns the number of words used by the bits of a bitset.
+ *
+ * @param[in] bitset target bitset
+ * @return size_t
+ */
+size_t bitset_nb_words(const BITSET bitset);
+
+/**
+ * @brief Returns the number of words a bitset can hold before being re-allocated by bitset_resize().
+ *
+ * @param[in] bitset target bitset
+ * @return size_t
+ */
+size_t bitset_capacity_words(const BITSET bitset);
+
+/**
+ * @brief Sets a bit.
+ *
+ * @param[inout] bitset target bitset
+ * @param[in] index index of the bit
+ * @return true if the index was in bounds
+ * @return false otherwise
+ */
+bool bitset_set(BITSET bitset, size_t index);
+
+/**
+ * @brief Clears a bit.
+ *
+ * @param[inout] bitset target bitset
+ * @param[in] index index of the bit
+ * @return true if the index was in bounds
+ * @return false otherwise
+ */
+bool bitset_clear(BITSET bitset, size_t index);
+
+/**
+ * @brief Returns wether a bit is set. Out of bounds bits are considered cleared.
+ *
+ * @param[in] bitset target bitset
+ * @param[in] index index of the bit
+ * @return bool
+ */
+bool bitset_test(const BITSET bitset, size_t index);
+
+/**
+ * @brief Clears all bits of a bitset.
+ *
+ * @param[inout] bitset target bitset
+ */
+void bitset_reset(BITSET bitset);
+
+/**
+ * @brief Keeps in `dest` the bits also set in `source`. Bits of `dest` beyond the length of `source` are cleared.
+ *
+ * @param[inout] dest modified bitset
+ * @param[in] source other operand
+ */
+void bitset_and(BITSET dest, const BITSET source);
+
+/**
+ * @brief Sets in `dest` the bits set in `source`. Bits of `source` beyond the length of `dest` are ignored.
+ *
+ * @param[inout] dest modified bitset
+ * @param[in] source other operand
+ */
+void bitset_or(BITSET dest, const BITSET source);
+
+/**
+ * @brief Flips in `dest` the bits set in `source`. Bits of `source` beyond the length of `dest` are ignored.
+ *
+ * @param[inout] dest modified bitset
+ * @param[in] source other operand
+ */
+void bitset_xor(BITSET dest, const BITSET source);
+
+/**
+ * @brief Clears in `dest` the bits set in `source`.
+ *
+ * @param[inout] dest modified bitset
+ * @param[in] source other operand
+ */
+void bitset_andnot(BITSET dest, const BITSET source);
+
+/**
+ * @brief Counts the set bits of a bitset.
+ *
+ * @param[in] bitset target bitset
+ * @return size_t
+ */
+size_t bitset_count(const BITSET bitset);
+
+/**
+ * @brief Finds the first set bit at or after some index.
+ *
+ * @param[in] bitset target bitset
+ * @param[in] from_index index where the search starts
+ * @param[out] out_index index of the found bit ; can be NULL
+ * @return true if a set bit was found
+ * @return false otherwise
+ */
+bool bitset_next_set(const BITSET bitset, size_t from_index, size_t *out_index);
+
+/**
+ * @brief Counts the set bits strictly before some index.
+ *
+ * @param[in] bitset target bitset
+ * @param[in] index end of the counted bits, excluded
+ * @return size_t
+ */
+size_t bitset_rank(const BITSET bitset, size_t index);
+
+/**
+ * @brief Finds the index of the n-th set bit, counting from 0.
+ *
+ * @param[in] bitset target bitset
+ * @param[in] nth rank of the searched bit
+ * @param[out] out_index index of the found bit ; can be NULL
+ * @return true if the bitset has more than `nth` set bits
+ * @return false otherwise
+ */
+bool bitset_select(const BITSET bitset, size_t nth, size_t *out_index);
+
+#ifdef UNITTESTING
+void bitset_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * @file btree.h
+ * @author gabriel
+ * @brief Ordered maps stored as B+-trees, for range queries and iteration in the order of the keys.
+ * Keys and values have a fixed size and are copied into the nodes. Nodes span a few cache lines and hold
+ * tens of keys each, so a lookup over millions of entries only touches a handful of nodes. All entries
+ * live in the leaves, which are linked together : iterating over a range is a walk along the leaves.
+ * Keys are ordered by a comparator, or compared directly as `u64` by trees made with btree_create_u64().
+ *
+ * @code
+ * btree *orders = btree_create_u64(alloc, sizeof(struct order));
+ * btree_insert(alloc, orders, &(u64) { order.timestamp }, &order);
+ *
+ * btree_iterator it = { 0 };
+ * for (bool valid = btree_lower_bound(orders, &(u64) { start }, &it) ; valid ; valid = btree_iterator_next(&it)) {
+ *     if (*(const u64 *) btree_iterator_key(&it) >= end) break;
+ * }
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-09
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_BTREE_H__
+#define UNSTANDARD_BTREE_H__
+
+#include "allocation.h"
+
+/// Size, in bytes, a node of a tree is fitted into.
+#define BTREE_NODE_SIZE (512u)
+
+/**
+ * @brief Opaque B+-tree.
+ */
+typedef struct btree btree;
+
+/**
+ * @brief Position of an entry in a tree. Invalidated by any insertion or removal.
+ */
+typedef struct btree_iterator {
+    /// leaf holding the entry
+    const void *leaf;
+    /// index of the entry in its leaf
+    size_t index;
+    /// tree of the leaf
+    const btree *tree;
+} btree_iterator;
+
+/**
+ * @brief Creates an empty tree whose keys are ordered by a comparator.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] key_size size, in bytes, of a key
+ * @param[in] value_size size, in bytes, of a value
+ * @param[in] comparator function ordering two keys
+ * @return btree* the tree created, or NULL on failure
+ */
+btree *btree_create(allocator alloc, u32 key_size, u32 value_size, comparator_f comparator);
+
+/**
+ * @brief Creates an empty tree whose keys are `u64`, compared without going through a comparator.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] value_size size, in bytes, of a value
+ * @return btree* the tree created, or NULL on failure
+ */
+btree *btree_create_u64(allocator alloc, u32 value_size);
+
+/**
+ * @brief Frees a tree and all of its nodes. The pointer given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the tree
+ * @param[inout] tree freed tree
+ */
+void btree_destroy(allocator alloc, btree **tree);
+
+/**
+ * @brief Inserts or replaces the value of a key.
+ *
+ * @param[in] alloc allocator that was used to create the tree
+ * @param[inout] tree modified tree
+ * @param[in] key inserted key
+ * @param[in] value copied value
+ * @return void* the value in the tree, valid until the next insertion or removal ; NULL on allocation failure
+ */
+void *btree_insert(allocator alloc, btree *tree, const void *key, const void *value);
+
+/**
+ * @brief Finds the value of a key.
+ *
+ * @param[in] tree searched tree
+ * @param[in] key searched key
+ * @return void* the value in the tree, valid until the next insertion or removal ; NULL if the key is not in the tree
+ */
+void *btree_find(const btree *tree, const void *key);
+
+/**
+ * @brief Removes the entry of a key.
+ *
+ * @param[in] alloc allocator that was used to create the tree
+ * @param[inout] tree modified tree
+ * @param[in] key removed key
+ * @param[out] out_value receives the removed value ; can be NULL
+ * @return true if an entry was removed
+ * @return false if the key was not in the tree
+ */
+bool btree_remove(allocator alloc, btree *tree, const void *key, void *out_value);
+
+/**
+ * @brief Returns the number of entries in a tree.
+ *
+ * @param[in] tree target tree
+ * @return size_t
+ */
+size_t btree_length(const btree *tree);
+
+/**
+ * @brief Points an iterator at the entry of the smallest key.
+ *
+ * @param[in] tree target tree
+ * @param[out] out_iterator iterator
+ * @return true if the iterator points at an entry
+ * @return false if the tree is empty
+ */
+bool btree_first(const btree *tree, btree_iterator *out_iterator);
+
+/**
+ * @brief Points an iterator at the entry of the smallest key greater than or equal to a key.
+ *
+ * @param[in] tree target tree
+ * @param[in] key searched key
+ * @param[out] out_iterator iterator
+ * @return true if the iterator points at an entry
+ * @return false if all keys are smaller
+ */
+bool btree_lower_bound(const btree *tree, const void *key, btree_iterator *out_iterator);
+
+/**
+ * @brief Moves an iterator to the entry of the next key.
+ *
+ * @param[inout] iterator moved iterator
+ * @return true if the iterator points at an entry
+ * @return false if it went past the last one
+ */
+bool btree_iterator_next(btree_iterator *iterator);
+
+/**
+ * @brief Returns the key of the entry an iterator points at.
+ *
+ * @param[in] iterator iterator pointing at an entry
+ * @return const void*
+ */
+const void *btree_iterator_key(const btree_iterator *iterator);
+
+/**
+ * @brief Returns the value of the entry an iterator points at.
+ *
+ * @param[in] iterator iterator pointing at an entry
+ * @return void*
+ */
+void *btree_iterator_value(const btree_iterator *iterator);
+
+#ifdef UNITTESTING
+void btree_execute_unittests(void);
+#endif
+
+#endif
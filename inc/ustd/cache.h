@@ -0,0 +1,150 @@
+/**
+ * @file cache.h
+ * @author gabriel
+ * @brief Bounded caches of fixed-size values, evicting entries in constant time under an LRU or CLOCK policy.
+ * All the memory of a cache is taken from its allocator once, on creation : entries, values and the hash
+ * index of the keys. Puts, gets and evictions then never allocate, and never move values.
+ * A cache is bounded by a number of entries, and optionally by a total cost (for example the size, in
+ * bytes, of the objects the values refer to). Evicted entries are handed to a callback before their slot
+ * is reused.
+ *  - LRU evicts the entry that was used the longest time ago ; each get moves an entry to the front of a list.
+ *  - CLOCK approximates LRU with a single "referenced" flag per entry, and a hand sweeping a ring of the
+ *    used entries : gets only set a flag and never touch the other entries, which is cheaper for read-heavy
+ *    caches. An eviction looks at most at twice the number of entries in the cache, whatever its capacity.
+ *
+ * @code
+ * cache *textures = cache_create(alloc, &(cache_config) {
+ *         .policy = CACHE_POLICY_CLOCK, .value_size = sizeof(texture *),
+ *         .max_entries = 512, .max_cost = 256 << 20, .on_evict = &texture_release });
+ *
+ * texture **found = cache_get(textures, texture_id);
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-08
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_CACHE_H__
+#define UNSTANDARD_CACHE_H__
+
+#include "allocation.h"
+
+/**
+ * @brief Choice of the entry evicted when a cache is full.
+ */
+typedef enum cache_policy {
+    /// least recently used entry
+    CACHE_POLICY_LRU,
+    /// first entry not referenced since the last sweep of the clock hand
+    CACHE_POLICY_CLOCK,
+} cache_policy;
+
+/**
+ * @brief Called with an entry about to be evicted from a cache.
+ */
+typedef void (*cache_evict_f)(u64 key, void *value, void *context);
+
+/**
+ * @brief Parameters of a cache.
+ */
+typedef struct cache_config {
+    /// eviction policy
+    cache_policy policy;
+    /// size, in bytes, of a value
+    u32 value_size;
+    /// maximum number of entries
+    size_t max_entries;
+    /// maximum total cost of the entries ; 0 to only bound the number of entries
+    size_t max_cost;
+    /// function called on each evicted entry ; can be NULL
+    cache_evict_f on_evict;
+    /// pointer passed to each call of on_evict
+    void *context;
+} cache_config;
+
+/**
+ * @brief Opaque cache.
+ */
+typedef struct cache cache;
+
+/**
+ * @brief Creates an empty cache, allocating all the memory it will ever use.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] config parameters of the cache
+ * @return cache* the cache created, or NULL on failure
+ */
+cache *cache_create(allocator alloc, const cache_config *config);
+
+/**
+ * @brief Frees a cache. Its entries are not handed to the eviction callback : use cache_clear() first for that.
+ * The pointer given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the cache
+ * @param[inout] target freed cache
+ */
+void cache_destroy(allocator alloc, cache **target);
+
+/**
+ * @brief Finds the value of a key, and marks its entry as used.
+ *
+ * @param[inout] target searched cache
+ * @param[in] key searched key (a hash, or any integer identifier)
+ * @return void* the value, valid until its entry is evicted or removed ; NULL if the key is not in the cache
+ */
+void *cache_get(cache *target, u64 key);
+
+/**
+ * @brief Inserts or replaces the value of a key, evicting entries as needed to stay within the bounds of the cache.
+ *
+ * A replaced value is overwritten without going through the eviction callback.
+ *
+ * @param[inout] target modified cache
+ * @param[in] key inserted key
+ * @param[in] value copied value
+ * @param[in] cost cost of the entry, counted against max_cost
+ * @return void* the value in the cache ; NULL if the cost alone exceeds the maximum cost of the cache
+ */
+void *cache_put(cache *target, u64 key, const void *value, size_t cost);
+
+/**
+ * @brief Removes the entry of a key, without calling the eviction callback.
+ *
+ * @param[inout] target modified cache
+ * @param[in] key removed key
+ * @param[out] out_value receives the removed value ; can be NULL
+ * @return true if an entry was removed
+ * @return false if the key was not in the cache
+ */
+bool cache_remove(cache *target, u64 key, void *out_value);
+
+/**
+ * @brief Evicts all entries of a cache, calling the eviction callback on each of them.
+ *
+ * @param[inout] target cleared cache
+ */
+void cache_clear(cache *target);
+
+/**
+ * @brief Returns the number of entries in a cache.
+ *
+ * @param[in] target cache
+ * @return size_t
+ */
+size_t cache_count(const cache *target);
+
+/**
+ * @brief Returns the total cost of the entries in a cache.
+ *
+ * @param[in] target cache
+ * @return size_t
+ */
+size_t cache_cost(const cache *target);
+
+#ifdef UNITTESTING
+void cache_execute_unittests(void);
+#endif
+
+#endif
@@ -132,6 +132,9 @@ size_t c_string_length(const char *str, size_t limit, bool keep_terminator);
 /* Simple hash function to hash anything. */
 u32 hash_jenkins_one_at_a_time(const byte *key, size_t length, u32 seed);
 
+/* Mixes all bits of an integer into a hash, without going through its bytes. */
+u32 hash_integer(u64 key, u32 seed);
+
 /* Compares two 4-bytes hashes as if they were unsigned integers. */
 i32 hash_compare(const void *lhs, const void *rhs);
 
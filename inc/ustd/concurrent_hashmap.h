@@ -0,0 +1,143 @@
+/**
+ * @file concurrent_hashmap.h
+ * @author gabriel
+ * @brief Hashmaps shared between threads, split into independently locked shards.
+ * Each shard is a regular hashmap guarded by its own reader-writer lock, and the low bits of a hash pick
+ * the shard of a key. Lookups only take a shard for reading, so readers never block each other, and
+ * writers only block the threads working on the same shard.
+ * Since elements move when a shard is written to, values are copied in and out instead of being accessed
+ * through an index.
+ *
+ * @code
+ * concurrent_hashmap *sessions = concurrent_hashmap_create(alloc, sizeof(struct session), 16, 1024);
+ *
+ * // any thread
+ * concurrent_hashmap_set_hashed(alloc, sessions, session.id, &session);
+ * concurrent_hashmap_get_hashed(sessions, id, &session);
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-04
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_CONCURRENT_HASHMAP_H__
+#define UNSTANDARD_CONCURRENT_HASHMAP_H__
+
+#include "hashmap.h"
+
+/// Maximum number of shards of a concurrent hashmap.
+#define CONCURRENT_HASHMAP_MAX_SHARDS (1024u)
+
+/**
+ * @brief Opaque concurrent hashmap.
+ */
+typedef struct concurrent_hashmap concurrent_hashmap;
+
+/**
+ * @brief Creates an empty concurrent hashmap.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] element_size size, in bytes, of a single value
+ * @param[in] nb_shards number of shards, rounded up to a power of two and capped to CONCURRENT_HASHMAP_MAX_SHARDS
+ * @param[in] starting_capacity initial number of values held by each shard
+ * @return concurrent_hashmap* the hashmap created, or NULL on failure
+ */
+concurrent_hashmap *concurrent_hashmap_create(allocator alloc, size_t element_size, size_t nb_shards, size_t starting_capacity);
+
+/**
+ * @brief Releases a concurrent hashmap. No other thread may be using it.
+ *
+ * @param[in] alloc allocator used to create the hashmap
+ * @param[inout] map destroyed hashmap, set to NULL
+ */
+void concurrent_hashmap_destroy(allocator alloc, concurrent_hashmap **map);
+
+/**
+ * @brief Inserts or replaces the value associated to a hash, growing its shard if needed.
+ *
+ * @param[in] alloc allocator used to create the hashmap
+ * @param[in] map target hashmap
+ * @param[in] hash hash of the key
+ * @param[in] value copied value
+ * @return true if the value was stored
+ * @return false otherwise
+ */
+bool concurrent_hashmap_set_hashed(allocator alloc, concurrent_hashmap *map, u32 hash, const void *value);
+
+/**
+ * @brief Copies out the value associated to a hash.
+ *
+ * @param[in] map target hashmap
+ * @param[in] hash hash of the key
+ * @param[out] out_value receives a copy of the value ; can be NULL to only test the presence of the key
+ * @return true if the hash was found
+ * @return false otherwise
+ */
+bool concurrent_hashmap_get_hashed(concurrent_hashmap *map, u32 hash, void *out_value);
+
+/**
+ * @brief Removes the value associated to a hash.
+ *
+ * @param[in] map target hashmap
+ * @param[in] hash hash of the key
+ * @return true if a value was removed
+ * @return false otherwise
+ */
+bool concurrent_hashmap_remove_hashed(concurrent_hashmap *map, u32 hash);
+
+/**
+ * @brief Inserts or replaces the value associated to a key (see hashmap_hash_of()).
+ *
+ * @param[in] alloc allocator used to create the hashmap
+ * @param[in] map target hashmap
+ * @param[in] key NUL-terminated key
+ * @param[in] value copied value
+ * @return true if the value was stored
+ * @return false otherwise
+ */
+bool concurrent_hashmap_set(allocator alloc, concurrent_hashmap *map, const char *key, const void *value);
+
+/**
+ * @brief Copies out the value associated to a key (see hashmap_hash_of()).
+ *
+ * @param[in] map target hashmap
+ * @param[in] key NUL-terminated key
+ * @param[out] out_value receives a copy of the value ; can be NULL to only test the presence of the key
+ * @return true if the key was found
+ * @return false otherwise
+ */
+bool concurrent_hashmap_get(concurrent_hashmap *map, const char *key, void *out_value);
+
+/**
+ * @brief Removes the value associated to a key (see hashmap_hash_of()).
+ *
+ * @param[in] map target hashmap
+ * @param[in] key NUL-terminated key
+ * @return true if a value was removed
+ * @return false otherwise
+ */
+bool concurrent_hashmap_remove(concurrent_hashmap *map, const char *key);
+
+/**
+ * @brief Counts the values of all shards. The result may already be outdated if other threads are writing.
+ *
+ * @param[in] map target hashmap
+ * @return size_t
+ */
+size_t concurrent_hashmap_count(concurrent_hashmap *map);
+
+/**
+ * @brief Returns the number of shards of a hashmap.
+ *
+ * @param[in] map target hashmap
+ * @return size_t
+ */
+size_t concurrent_hashmap_nb_shards(const concurrent_hashmap *map);
+
+#ifdef UNITTESTING
+void concurrent_hashmap_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file deque.h
+ * @author gabriel
+ * @brief Double-ended queues stored as ring buffers, with O(1) pushes and pops at both ends.
+ * A deque shares its header layout with the arrays of array.h, so `deque_length()` and
+ * `deque_capacity()` are the array ones. Elements wrap around the end of the buffer, so they must be
+ * accessed through `deque_get()` or `deque_at()` rather than by direct indexing.
+ *
+ * A deque can either be allocated (and grown) with an allocator, or placed in some fixed memory region
+ * with `deque_create_in()` : it then never allocates, and pushes fail when it is full.
+ *
+ * @version 0.1
+ * @date 2025-07-22
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_DEQUE_H__
+#define UNSTANDARD_DEQUE_H__
+
+#include "array.h"
+
+#define DEQUE(type_) type_ *
+#define DEQUE_ANY void *
+
+#define deque_length(deque_) \
+        array_length(deque_)
+
+#define deque_capacity(deque_) \
+        array_capacity(deque_)
+
+/**
+ * @brief Creates an empty deque by allocating its memory.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] size_element size, in bytes, of a single element
+ * @param[in] nb_elements_max number of elements the deque can hold before growing
+ * @return DEQUE_ANY the deque created
+ */
+DEQUE_ANY deque_create(allocator alloc, u32 size_element, size_t nb_elements_max);
+
+/**
+ * @brief Creates an empty, fixed-capacity deque inside some memory region.
+ * Part of the memory is used for the deque header, the rest is given to the elements.
+ *
+ * @param[inout] mem memory the deque lives in, aligned for a size_t
+ * @param[in] length length in bytes of the memory region
+ * @param[in] size_element size, in bytes, of a single element
+ * @return DEQUE_ANY the deque created, or NULL if the region cannot hold a single element
+ */
+DEQUE_ANY deque_create_in(byte *mem, size_t length, u32 size_element);
+
+/**
+ * @brief Frees a deque from the allocator it was created with.
+ * The pointer to the deque given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the deque
+ * @param[inout] deque pointer to the freed deque
+ */
+void deque_destroy(allocator alloc, DEQUE_ANY *deque);
+
+/**
+ * @brief Re-allocates a deque if it needs extra space to store additional elements.
+ * The elements are unwrapped at the start of the new buffer. Must not be used on a deque created with
+ * `deque_create_in()`.
+ *
+ * @param[in] alloc allocator used to create the deque
+ * @param[inout] deque target deque
+ * @param[in] additional_capacity number of supplemental elements the deque should be able to hold
+ */
+void deque_ensure_capacity(allocator alloc, DEQUE_ANY *deque, size_t additional_capacity);
+
+/**
+ * @brief Pushes a value (by shallow copy) after the last element of a deque.
+ *
+ * @param[inout] deque target deque
+ * @param[in] value pointer to the pushed value
+ * @return true if the element was pushed
+ * @return false if the deque was full
+ */
+bool deque_push_back(DEQUE_ANY deque, const void *value);
+
+/**
+ * @brief Pushes a value (by shallow copy) before the first element of a deque.
+ *
+ * @param[inout] deque target deque
+ * @param[in] value pointer to the pushed value
+ * @return true if the element was pushed
+ * @return false if the deque was full
+ */
+bool deque_push_front(DEQUE_ANY deque, const void *value);
+
+/**
+ * @brief Removes the last element of a deque.
+ *
+ * @param[inout] deque target deque
+ * @param[out] out_value pointer to some memory where the removed value is copied ; can be NULL
+ * @return true if an element was removed
+ * @return false if the deque was empty
+ */
+bool deque_pop_back(DEQUE_ANY deque, void *out_value);
+
+/**
+ * @brief Removes the first element of a deque.
+ *
+ * @param[inout] deque target deque
+ * @param[out] out_value pointer to some memory where the removed value is copied ; can be NULL
+ * @return true if an element was removed
+ * @return false if the deque was empty
+ */
+bool deque_pop_front(DEQUE_ANY deque, void *out_value);
+
+/**
+ * @brief Pushes several contiguous values after the last element of a deque.
+ * Either all values are pushed, or none.
+ *
+ * @param[inout] deque target deque
+ * @param[in] memory pointer to the first pushed value
+ * @param[in] nb_elements number of pushed values
+ * @return true if the values were pushed
+ * @return false if the deque did not have space for all of them
+ */
+bool deque_push_back_mem(DEQUE_ANY deque, const void *memory, size_t nb_elements);
+
+/**
+ * @brief Removes up to some number of elements from the front of a deque, copying them to contiguous memory.
+ *
+ * @param[inout] deque target deque
+ * @param[out] out_memory memory receiving the removed values ; can be NULL
+ * @param[in] nb_elements maximum number of removed values
+ * @return size_t number of values actually removed
+ */
+size_t deque_pop_front_mem(DEQUE_ANY deque, void *out_memory, size_t nb_elements);
+
+/**
+ * @brief Copies the element at some position from the front of the deque, and checks bounds.
+ *
+ * @param[in] deque target deque
+ * @param[in] index position from the first element
+ * @param[out] out_value pointer to some memory where the value is copied ; can be NULL
+ * @return true if the index is valid
+ * @return false if the index is out of bounds
+ */
+bool deque_get(DEQUE_ANY deque, size_t index, void *out_value);
+
+/**
+ * @brief Returns a pointer to the element at some position from the front of the deque.
+ *
+ * @param[in] deque target deque
+ * @param[in] index position from the first element
+ * @return void* pointer to the element, or NULL if the index is out of bounds
+ */
+void *deque_at(DEQUE_ANY deque, size_t index);
+
+/**
+ * @brief Clears a deque of all its content.
+ *
+ * @param[inout] deque cleared deque
+ */
+void deque_clear(DEQUE_ANY deque);
+
+#ifdef UNITTESTING
+void deque_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * @file filter.h
+ * @author gabriel
+ * @brief Probabilistic membership filters, to answer "certainly not there" without touching the actual table.
+ * Both filters work on hashes (see the hashmap_hash_of*() functions) and may answer "maybe there" for a hash
+ * that was never inserted, at a rate chosen on creation. They never answer "not there" for an inserted hash.
+ *  - Bloom filters are cut into blocks of one cache line : all bits of a hash live in the same block, so a
+ *    lookup reads a single line. They cannot forget a hash.
+ *  - Cuckoo filters keep a small fingerprint of each hash in one of two buckets, and can remove hashes.
+ *    Insertions can fail once the filter is almost full.
+ *
+ * Filters can be serialized into a buffer, to be stored next to an on-disk table and loaded back on
+ * the same kind of machine.
+ *
+ * @code
+ * bloom_filter *known = bloom_filter_create(alloc, 100000, 0.01);
+ * bloom_filter_insert(known, hashmap_hash_of(name, 0));
+ *
+ * if (bloom_filter_may_contain(known, hashmap_hash_of(other_name, 0))) {
+ *     // only now, search the hashmap
+ * }
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_FILTER_H__
+#define UNSTANDARD_FILTER_H__
+
+#include "allocation.h"
+
+/// Size, in bytes, of a block of a bloom filter.
+#define BLOOM_FILTER_BLOCK_SIZE (64u)
+/// Number of fingerprints held by a bucket of a cuckoo filter.
+#define CUCKOO_FILTER_BUCKET_SIZE (4u)
+/// Number of fingerprints moved around before an insertion in a cuckoo filter gives up.
+#define CUCKOO_FILTER_MAX_KICKS (500u)
+
+/**
+ * @brief Opaque blocked bloom filter.
+ */
+typedef struct bloom_filter bloom_filter;
+
+/**
+ * @brief Opaque cuckoo filter.
+ */
+typedef struct cuckoo_filter cuckoo_filter;
+
+/**
+ * @brief Creates an empty bloom filter sized for some number of hashes.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] nb_elements expected number of inserted hashes
+ * @param[in] false_positive_rate wanted rate of false "maybe there" answers once all hashes are inserted, in ]0, 1[
+ * @return bloom_filter* the filter created, or NULL on failure
+ */
+bloom_filter *bloom_filter_create(allocator alloc, size_t nb_elements, f64 false_positive_rate);
+
+/**
+ * @brief Frees a bloom filter. The pointer given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the filter
+ * @param[inout] filter freed filter
+ */
+void bloom_filter_destroy(allocator alloc, bloom_filter **filter);
+
+/**
+ * @brief Adds a hash to a bloom filter.
+ *
+ * @param[inout] filter target filter
+ * @param[in] hash inserted hash
+ */
+void bloom_filter_insert(bloom_filter *filter, u64 hash);
+
+/**
+ * @brief Tells if a hash might have been inserted in a bloom filter.
+ *
+ * @param[in] filter target filter
+ * @param[in] hash searched hash
+ * @return true if the hash might have been inserted
+ * @return false if it was certainly not
+ */
+bool bloom_filter_may_contain(const bloom_filter *filter, u64 hash);
+
+/**
+ * @brief Forgets all hashes inserted in a bloom filter.
+ *
+ * @param[inout] filter target filter
+ */
+void bloom_filter_clear(bloom_filter *filter);
+
+/**
+ * @brief Serializes a bloom filter into a buffer.
+ *
+ * @param[in] filter serialized filter
+ * @param[out] out_buffer receiving buffer ; can be NULL to only get the needed size
+ * @param[in] buffer_size size, in bytes, of the buffer
+ * @return size_t number of bytes needed by the filter ; nothing is written if it is more than buffer_size
+ */
+size_t bloom_filter_serialize(const bloom_filter *filter, byte *out_buffer, size_t buffer_size);
+
+/**
+ * @brief Creates a bloom filter from a buffer filled by bloom_filter_serialize().
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] buffer serialized filter
+ * @param[in] buffer_size size, in bytes, of the buffer
+ * @return bloom_filter* the filter created, or NULL if the buffer does not hold a bloom filter
+ */
+bloom_filter *bloom_filter_deserialize(allocator alloc, const byte *buffer, size_t buffer_size);
+
+/**
+ * @brief Creates an empty cuckoo filter sized for some number of hashes. They fill at most 90% of its slots,
+ * below the load where insertions start to fail. Fingerprints are packed, so higher rates take less memory.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] nb_elements expected number of inserted hashes
+ * @param[in] false_positive_rate wanted rate of false "maybe there" answers, in ]0, 1[ ; rates under about 1e-4 are rounded up to it
+ * @return cuckoo_filter* the filter created, or NULL on failure
+ */
+cuckoo_filter *cuckoo_filter_create(allocator alloc, size_t nb_elements, f64 false_positive_rate);
+
+/**
+ * @brief Frees a cuckoo filter. The pointer given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the filter
+ * @param[inout] filter freed filter
+ */
+void cuckoo_filter_destroy(allocator alloc, cuckoo_filter **filter);
+
+/**
+ * @brief Adds a hash to a cuckoo filter. The same hash can be added several times, and must then be
+ * removed as many times.
+ *
+ * @param[inout] filter target filter
+ * @param[in] hash inserted hash
+ * @return true if the hash was inserted
+ * @return false if the filter is full
+ */
+bool cuckoo_filter_insert(cuckoo_filter *filter, u64 hash);
+
+/**
+ * @brief Tells if a hash might have been inserted in a cuckoo filter.
+ *
+ * @param[in] filter target filter
+ * @param[in] hash searched hash
+ * @return true if the hash might have been inserted
+ * @return false if it was certainly not
+ */
+bool cuckoo_filter_may_contain(const cuckoo_filter *filter, u64 hash);
+
+/**
+ * @brief Removes a hash from a cuckoo filter. Only remove hashes that were inserted, or another hash
+ * sharing the same fingerprint might be forgotten.
+ *
+ * @param[inout] filter target filter
+ * @param[in] hash removed hash
+ * @return true if a fingerprint of the hash was removed
+ * @return false otherwise
+ */
+bool cuckoo_filter_remove(cuckoo_filter *filter, u64 hash);
+
+/**
+ * @brief Returns the number of hashes held by a cuckoo filter.
+ *
+ * @param[in] filter target filter
+ * @return size_t
+ */
+size_t cuckoo_filter_count(const cuckoo_filter *filter);
+
+/**
+ * @brief Serializes a cuckoo filter into a buffer.
+ *
+ * @param[in] filter serialized filter
+ * @param[out] out_buffer receiving buffer ; can be NULL to only get the needed size
+ * @param[in] buffer_size size, in bytes, of the buffer
+ * @return size_t number of bytes needed by the filter ; nothing is written if it is more than buffer_size
+ */
+size_t cuckoo_filter_serialize(const cuckoo_filter *filter, byte *out_buffer, size_t buffer_size);
+
+/**
+ * @brief Creates a cuckoo filter from a buffer filled by cuckoo_filter_serialize().
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] buffer serialized filter
+ * @param[in] buffer_size size, in bytes, of the buffer
+ * @return cuckoo_filter* the filter created, or NULL if the buffer does not hold a cuckoo filter
+ */
+cuckoo_filter *cuckoo_filter_deserialize(allocator alloc, const byte *buffer, size_t buffer_size);
+
+#ifdef UNITTESTING
+void bloom_filter_execute_unittests(void);
+void cuckoo_filter_execute_unittests(void);
+#endif
+
+#endif
@@ -7,20 +7,71 @@
 #define HASHMAP(type_) type_ *
 #define HASHMAP_ANY void *
 
-#define hashmap_get(hashmap_, index_, out_value_) \
-        array_get(hashmap_, index_, out_value_)
-
 #define hashmap_length(hashmap_) \
         array_length(hashmap_)
 
+/// Maximum number of elements moved to the new table by each call to hashmap_ensure_capacity_incremental().
+#define HASHMAP_MIGRATION_STEP (64u)
+
 #define hashmap_capacity(hashmap_) \
         array_capacity(hashmap_)
 
+/**
+ * @brief Position of a walk over the elements of a hashmap, including those still in a previous table.
+ * Invalidated by any insertion, removal or growth of the hashmap.
+ */
+typedef struct hashmap_iterator {
+    HASHMAP_ANY map;
+    /// next position in the walked table
+    size_t index;
+    /// the previous table of a migration is being walked
+    bool in_previous;
+
+    /// hash of the current element
+    u32 hash;
+    /// value of the current element
+    void *value;
+} hashmap_iterator;
+
+/**
+ * @brief Measures of how the elements of a hashmap are spread, to tune its capacity and hash function.
+ */
+struct hashmap_stats {
+    /// elements, including those still in a previous table
+    size_t count;
+    size_t capacity;
+    f32 load_factor;
+    /// average and worst number of hashes compared to find an element
+    f32 average_probe_length;
+    size_t max_probe_length;
+    /// smallest and largest difference between hashes next to each other once sorted, 0 under two elements.
+    /// Well spread hashes are about 2^32 / count apart : a small smallest gap warns that two keys may soon
+    /// share a hash, and then overwrite each other
+    u32 min_hash_gap;
+    u32 max_hash_gap;
+    /// bytes held by the hashmap, previous table included
+    size_t memory_footprint;
+};
+
 HASHMAP_ANY hashmap_create(
         struct allocator alloc,
         size_t element_size,
         size_t starting_capacity);
 
+HASHMAP_ANY hashmap_create_from(
+        struct allocator alloc,
+        const char *const *keys,
+        const void *values,
+        size_t element_size,
+        size_t count);
+
+HASHMAP_ANY hashmap_create_from_hashed(
+        struct allocator alloc,
+        const u32 *hashes,
+        const void *values,
+        size_t element_size,
+        size_t count);
+
 void hashmap_destroy(
         struct allocator alloc,
         HASHMAP_ANY *map);
@@ -30,9 +81,35 @@ void hashmap_ensure_capacity(
         HASHMAP_ANY *map,
         size_t additional_capacity);
 
+void hashmap_ensure_capacity_incremental(
+        struct allocator alloc,
+        HASHMAP_ANY *map,
+        size_t additional_capacity);
+
+void hashmap_finish_migration(
+        struct allocator alloc,
+        HASHMAP_ANY *map);
+
+bool hashmap_is_migrating(
+        HASHMAP_ANY map);
+
+size_t hashmap_count(
+        HASHMAP_ANY map);
+
 u32 hashmap_hash_of(
         const char *key, u32 seed);
 
+u32 hashmap_hash_of_bytes(
+        const void *key, size_t length, u32 seed);
+
+u32 hashmap_hash_of_u64(
+        u64 key, u32 seed);
+
+bool hashmap_get(
+        HASHMAP_ANY map,
+        size_t index,
+        void *out_value);
+
 size_t hashmap_index_of(
         HASHMAP_ANY map,
         const char *key);
@@ -41,6 +118,15 @@ size_t hashmap_index_of_hashed(
         HASHMAP_ANY map,
         u32 hash);
 
+size_t hashmap_index_of_bytes(
+        HASHMAP_ANY map,
+        const void *key,
+        size_t length);
+
+size_t hashmap_index_of_u64(
+        HASHMAP_ANY map,
+        u64 key);
+
 size_t hashmap_set(
         HASHMAP_ANY map,
         const char *key,
@@ -51,6 +137,17 @@ size_t hashmap_set_hashed(
         u32 hash,
         void *value);
 
+size_t hashmap_set_bytes(
+        HASHMAP_ANY map,
+        const void *key,
+        size_t length,
+        void *value);
+
+size_t hashmap_set_u64(
+        HASHMAP_ANY map,
+        u64 key,
+        void *value);
+
 void hashmap_remove(
         HASHMAP_ANY map,
         const char *key);
@@ -59,7 +156,30 @@ void hashmap_remove_hashed(
         HASHMAP_ANY map,
         u32 hash);
 
+void hashmap_remove_bytes(
+        HASHMAP_ANY map,
+        const void *key,
+        size_t length);
+
+void hashmap_remove_u64(
+        HASHMAP_ANY map,
+        u64 key);
+
 const ARRAY(u32) hashmap_keys(
         HASHMAP_ANY map);
 
+hashmap_iterator hashmap_iterate(
+        HASHMAP_ANY map);
+
+bool hashmap_iterator_next(
+        hashmap_iterator *iterator);
+
+bool hashmap_stats(
+        HASHMAP_ANY map,
+        struct hashmap_stats *out_stats);
+
+#ifdef UNITTESTING
+void hashmap_execute_unittests(void);
+#endif
+
 #endif
@@ -0,0 +1,147 @@
+/**
+ * @file hashset.h
+ * @author gabriel
+ * @brief Sets of hashed keys, stored as sorted arrays of 32-bit hashes.
+ * A hashset only keeps the hashes of its keys : a membership test is a binary search over 4 bytes per
+ * element, where a hashmap used as a set also keeps (and shifts) a value per element. Like hashmaps,
+ * two keys of the same hash are seen as the same key.
+ * A hashset is a regular array of `u32` (see array.h), so `array_length()` and friends work on it, and its
+ * elements can be iterated in the order of their hashes.
+ *
+ * @code
+ * HASHSET visited = hashset_create(alloc, 256);
+ *
+ * hashset_ensure_capacity(alloc, &visited, 1);
+ * hashset_insert_hashed(visited, hashmap_hash_of_u64(node_id, 0));
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-05
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_HASHSET_H__
+#define UNSTANDARD_HASHSET_H__
+
+#include "hashmap.h"
+
+#define HASHSET u32 *
+
+/**
+ * @brief Creates an empty hashset.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] starting_capacity number of hashes the set can hold before growing
+ * @return HASHSET the set created
+ */
+HASHSET hashset_create(allocator alloc, size_t starting_capacity);
+
+/**
+ * @brief Frees a hashset from the allocator it was created with.
+ * The pointer to the set given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the set
+ * @param[inout] set pointer to the freed set
+ */
+void hashset_destroy(allocator alloc, HASHSET *set);
+
+/**
+ * @brief Makes sure a hashset can take some more hashes without growing.
+ *
+ * @param[in] alloc allocator that was used to create the set
+ * @param[inout] set target set
+ * @param[in] additional_capacity number of hashes that will be inserted
+ */
+void hashset_ensure_capacity(allocator alloc, HASHSET *set, size_t additional_capacity);
+
+/**
+ * @brief Adds a hash to a set.
+ *
+ * @param[inout] set target set
+ * @param[in] hash inserted hash (see the hashmap_hash_of*() functions)
+ * @return true if the hash was added
+ * @return false if it was already there, or if the set is full
+ */
+bool hashset_insert_hashed(HASHSET set, u32 hash);
+
+/**
+ * @brief Tells if a hash is in a set.
+ *
+ * @param[in] set target set
+ * @param[in] hash searched hash
+ * @return true if the hash is in the set
+ * @return false otherwise
+ */
+bool hashset_contains_hashed(const HASHSET set, u32 hash);
+
+/**
+ * @brief Removes a hash from a set.
+ *
+ * @param[inout] set target set
+ * @param[in] hash removed hash
+ * @return true if the hash was removed
+ * @return false if it was not in the set
+ */
+bool hashset_remove_hashed(HASHSET set, u32 hash);
+
+/**
+ * @brief Adds a NUL-terminated key to a set (see hashmap_hash_of()).
+ *
+ * @param[inout] set target set
+ * @param[in] key inserted key
+ * @return true if the key was added
+ * @return false if it was already there, or if the set is full
+ */
+bool hashset_insert(HASHSET set, const char *key);
+
+/**
+ * @brief Tells if a NUL-terminated key is in a set (see hashmap_hash_of()).
+ *
+ * @param[in] set target set
+ * @param[in] key searched key
+ * @return true if the key is in the set
+ * @return false otherwise
+ */
+bool hashset_contains(const HASHSET set, const char *key);
+
+/**
+ * @brief Removes a NUL-terminated key from a set (see hashmap_hash_of()).
+ *
+ * @param[inout] set target set
+ * @param[in] key removed key
+ * @return true if the key was removed
+ * @return false if it was not in the set
+ */
+bool hashset_remove(HASHSET set, const char *key);
+
+/**
+ * @brief Adds all hashes of a set to another, in a single merge pass.
+ *
+ * @param[in] alloc allocator that was used to create the destination set
+ * @param[inout] dest destination set, grown if needed
+ * @param[in] source added set
+ */
+void hashset_union(allocator alloc, HASHSET *dest, const HASHSET source);
+
+/**
+ * @brief Only keeps in a set the hashes that are also in another.
+ *
+ * @param[inout] dest destination set
+ * @param[in] source other set
+ */
+void hashset_intersect(HASHSET dest, const HASHSET source);
+
+/**
+ * @brief Removes from a set the hashes that are in another.
+ *
+ * @param[inout] dest destination set
+ * @param[in] source removed set
+ */
+void hashset_difference(HASHSET dest, const HASHSET source);
+
+#ifdef UNITTESTING
+void hashset_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file intern_pool.h
+ * @author gabriel
+ * @brief Pools storing each unique string once, and naming it by a small integer id.
+ * Interned strings are copied into chunks of memory that never move, so the pointer handed out for a
+ * string stays valid until the pool is destroyed, and two interned strings are equal if and only if their
+ * ids are. The hash of each string is computed once, when it is first interned, and is the same as the one
+ * given by hashmap_hash_of() : hashmaps can be filled with hashmap_set_hashed() without hashing again.
+ *
+ * Looking up a string that was already interned never takes a lock, and can be done from any number of
+ * threads. Interning a new string takes the lock of the pool.
+ *
+ * @code
+ * intern_pool *symbols = intern_pool_create(alloc, 1024);
+ *
+ * u32 id = intern_pool_intern(alloc, symbols, token, token_length, nullptr);
+ * if (id == keyword_return) { ... }
+ * hashmap_set_hashed(definitions, intern_pool_hash(symbols, id), &definition);
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-10
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_INTERN_POOL_H__
+#define UNSTANDARD_INTERN_POOL_H__
+
+#include "allocation.h"
+
+/// Id returned for strings that are not in a pool, or that could not be interned.
+#define INTERN_POOL_NOT_FOUND (UINT32_MAX)
+/// Size, in bytes, of the chunks the strings are copied into. Longer strings get a chunk of their own.
+#define INTERN_POOL_CHUNK_SIZE (65536u)
+
+/**
+ * @brief Opaque intern pool.
+ */
+typedef struct intern_pool intern_pool;
+
+/**
+ * @brief Creates an empty intern pool.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] starting_capacity number of strings the pool can hold before its lookup table grows
+ * @return intern_pool* the pool created, or NULL on failure
+ */
+intern_pool *intern_pool_create(allocator alloc, size_t starting_capacity);
+
+/**
+ * @brief Releases an intern pool and all of its strings. No other thread may be using it.
+ *
+ * @param[in] alloc allocator used to create the pool
+ * @param[inout] pool destroyed pool, set to NULL
+ */
+void intern_pool_destroy(allocator alloc, intern_pool **pool);
+
+/**
+ * @brief Returns the id of a string, copying it into the pool if it was never interned.
+ * Ids are given in the order the strings are interned, starting at 0.
+ *
+ * @param[in] alloc allocator used to create the pool
+ * @param[inout] pool target pool
+ * @param[in] string interned characters, not necessarily NUL-terminated
+ * @param[in] length number of characters
+ * @param[out] out_string receives the NUL-terminated copy held by the pool ; can be NULL
+ * @return u32 the id of the string, or INTERN_POOL_NOT_FOUND on allocation failure
+ */
+u32 intern_pool_intern(allocator alloc, intern_pool *pool, const char *string, size_t length, const char **out_string);
+
+/**
+ * @brief Returns the id of a string if it was interned, without taking a lock.
+ *
+ * @param[in] pool target pool
+ * @param[in] string searched characters, not necessarily NUL-terminated
+ * @param[in] length number of characters
+ * @return u32 the id of the string, or INTERN_POOL_NOT_FOUND
+ */
+u32 intern_pool_find(const intern_pool *pool, const char *string, size_t length);
+
+/**
+ * @brief Returns the NUL-terminated copy of an interned string.
+ *
+ * @param[in] pool target pool
+ * @param[in] id id of the string
+ * @return const char* the string, or NULL if no string has this id
+ */
+const char *intern_pool_string(const intern_pool *pool, u32 id);
+
+/**
+ * @brief Returns the length of an interned string.
+ *
+ * @param[in] pool target pool
+ * @param[in] id id of the string
+ * @return size_t the number of characters, terminator excluded, or 0 if no string has this id
+ */
+size_t intern_pool_length(const intern_pool *pool, u32 id);
+
+/**
+ * @brief Returns the hash of an interned string, equal to the one given by hashmap_hash_of().
+ *
+ * @param[in] pool target pool
+ * @param[in] id id of the string
+ * @return u32 the hash, or 0 if no string has this id
+ */
+u32 intern_pool_hash(const intern_pool *pool, u32 id);
+
+/**
+ * @brief Returns the number of strings in a pool.
+ *
+ * @param[in] pool target pool
+ * @return size_t
+ */
+size_t intern_pool_count(const intern_pool *pool);
+
+#ifdef UNITTESTING
+void intern_pool_execute_unittests(void);
+#endif
+
+#endif
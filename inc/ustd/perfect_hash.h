@@ -0,0 +1,98 @@
+/**
+ * @file perfect_hash.h
+ * @author gabriel
+ * @brief Minimal perfect hash tables, built once from a fixed set of keys (CHD algorithm).
+ * Each of the n keys of the set gets its own slot in [0, n) : a lookup hashes the key, reads the
+ * displacement of its bucket and lands on its slot in a single probe, with no collision to resolve and no
+ * empty slot. Values are kept by the caller, in any array of n elements indexed by the slots.
+ * Each slot also keeps a 32-bit fingerprint of its key, so keys outside of the set are rejected (but for
+ * a 1 in 2^32 chance of a false hit).
+ * A table can be used as built, or written as C source to be compiled into the program.
+ *
+ * @code
+ * static const char *keywords[] = { "if", "else", "while", "for", "return" };
+ * perfect_hash table = { 0 };
+ *
+ * perfect_hash_build(alloc, keywords, COUNT_OF(keywords), &table);
+ * size_t slot = perfect_hash_index_of(&table, "while"); // in [0, 5)
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-08-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_PERFECT_HASH_H__
+#define UNSTANDARD_PERFECT_HASH_H__
+
+#include "filereading.h"
+#include "allocation.h"
+
+/// Average number of keys per bucket of a table. Larger buckets make smaller tables that are slower to build.
+#define PERFECT_HASH_BUCKET_SIZE (4u)
+/// Number of seeds tried before giving up on a key set (which happens with duplicate keys).
+#define PERFECT_HASH_MAX_ATTEMPTS (8u)
+
+/**
+ * @brief A minimal perfect hash table. Built by perfect_hash_build(), or emitted as C source by
+ * perfect_hash_write_source().
+ */
+typedef struct perfect_hash {
+    /// seed of the hashes of the keys
+    u32 seed;
+    /// number of keys, and of slots
+    u32 nb_keys;
+    /// number of buckets the keys are first hashed into
+    u32 nb_buckets;
+    /// displacement of each bucket
+    const u32 *displacements;
+    /// fingerprint of the key of each slot
+    const u32 *fingerprints;
+} perfect_hash;
+
+/**
+ * @brief Builds a minimal perfect hash table from a set of distinct keys.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] keys NUL-terminated keys, all different
+ * @param[in] count number of keys
+ * @param[out] out_table built table, to release with perfect_hash_destroy()
+ * @return true if the table was built
+ * @return false if the keys could not be separated (duplicate keys), or on allocation failure
+ */
+bool perfect_hash_build(allocator alloc, const char *const *keys, size_t count, perfect_hash *out_table);
+
+/**
+ * @brief Releases a table built by perfect_hash_build(), and resets it to an empty one.
+ *
+ * @param[in] alloc allocator used to build the table
+ * @param[inout] table released table
+ */
+void perfect_hash_destroy(allocator alloc, perfect_hash *table);
+
+/**
+ * @brief Finds the slot of a key.
+ *
+ * @param[in] table searched table
+ * @param[in] key NUL-terminated key
+ * @return size_t slot of the key in [0, nb_keys), or nb_keys if the key is not in the set
+ */
+size_t perfect_hash_index_of(const perfect_hash *table, const char *key);
+
+/**
+ * @brief Writes a table as C source defining a `const perfect_hash` variable, replacing the file if it exists.
+ * The generated file includes this header and can be compiled as is.
+ *
+ * @param[in] path OS-compliant path to the file
+ * @param[in] table written table
+ * @param[in] name name of the variable, also used as a prefix for the arrays of the table
+ * @return i32 (see FILE_OP_* defines)
+ */
+i32 perfect_hash_write_source(const char *path, const perfect_hash *table, const char *name);
+
+#ifdef UNITTESTING
+void perfect_hash_execute_unittests(void);
+#endif
+
+#endif
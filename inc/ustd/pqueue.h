@@ -0,0 +1,121 @@
+/**
+ * @file pqueue.h
+ * @author gabriel
+ * @brief Priority queues stored as implicit d-ary heaps over an array.
+ * The element with the highest priority is the greatest one as ordered by the queue's comparator : pass
+ * an inverted comparator to get a min-queue. A priority queue shares its header layout with the arrays
+ * of array.h, so the read-only array functions (`array_length()`, `array_get()`, `array_find()`...) can be
+ * used on it, for example to find the index of an element before updating its key.
+ *
+ * @version 0.1
+ * @date 2025-07-23
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_PQUEUE_H__
+#define UNSTANDARD_PQUEUE_H__
+
+#include "array.h"
+
+#define PQUEUE(type_) type_ *
+#define PQUEUE_ANY void *
+
+/// Arity of a classic binary heap.
+#define PQUEUE_BINARY (2u)
+/// Arity of a 4-ary heap : shallower, and all children of a node are likely to share a cache line.
+#define PQUEUE_QUATERNARY (4u)
+
+#define pqueue_length(pqueue_) \
+        array_length(pqueue_)
+
+#define pqueue_capacity(pqueue_) \
+        array_capacity(pqueue_)
+
+/**
+ * @brief Creates an empty priority queue by allocating its memory.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] size_element size, in bytes, of a single element
+ * @param[in] nb_elements_max number of elements the queue can hold before growing
+ * @param[in] comparator comparison function ordering the elements by priority
+ * @param[in] arity number of children of each heap node, PQUEUE_BINARY or PQUEUE_QUATERNARY for example
+ * @return PQUEUE_ANY the queue created
+ */
+PQUEUE_ANY pqueue_create(allocator alloc, u32 size_element, size_t nb_elements_max, comparator_f comparator, u32 arity);
+
+/**
+ * @brief Creates a priority queue holding a copy of all elements of an array, heapified in linear time.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] array array whose elements are copied
+ * @param[in] comparator comparison function ordering the elements by priority
+ * @param[in] arity number of children of each heap node
+ * @return PQUEUE_ANY the queue created
+ */
+PQUEUE_ANY pqueue_create_from_array(allocator alloc, const ARRAY_ANY array, comparator_f comparator, u32 arity);
+
+/**
+ * @brief Frees a priority queue from the allocator it was created with.
+ * The pointer to the queue given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the queue
+ * @param[inout] pqueue pointer to the freed queue
+ */
+void pqueue_destroy(allocator alloc, PQUEUE_ANY *pqueue);
+
+/**
+ * @brief Re-allocates a priority queue if it needs extra space to store additional elements.
+ *
+ * @param[in] alloc allocator used to create the queue
+ * @param[inout] pqueue target queue
+ * @param[in] additional_capacity number of supplemental elements the queue should be able to hold
+ */
+void pqueue_ensure_capacity(allocator alloc, PQUEUE_ANY *pqueue, size_t additional_capacity);
+
+/**
+ * @brief Adds a value (by shallow copy) to a priority queue.
+ *
+ * @param[inout] pqueue target queue
+ * @param[in] value pointer to the pushed value
+ * @return true if the element was pushed
+ * @return false if the queue was full
+ */
+bool pqueue_push(PQUEUE_ANY pqueue, const void *value);
+
+/**
+ * @brief Removes the element of highest priority from a priority queue.
+ *
+ * @param[inout] pqueue target queue
+ * @param[out] out_value pointer to some memory where the removed value is copied ; can be NULL
+ * @return true if an element was removed
+ * @return false if the queue was empty
+ */
+bool pqueue_pop(PQUEUE_ANY pqueue, void *out_value);
+
+/**
+ * @brief Copies the element of highest priority of a priority queue without removing it.
+ *
+ * @param[in] pqueue target queue
+ * @param[out] out_value pointer to some memory where the value is copied ; can be NULL
+ * @return true if the queue held an element
+ * @return false if the queue was empty
+ */
+bool pqueue_peek(PQUEUE_ANY pqueue, void *out_value);
+
+/**
+ * @brief Replaces the element at some index of the queue, and moves it up or down the heap to match
+ * its new priority. This covers both the increase-key and decrease-key operations.
+ *
+ * @param[inout] pqueue target queue
+ * @param[in] index current index of the element in the queue
+ * @param[in] value pointer to the new value
+ * @return size_t the new index of the element, or the length of the queue if the index was out of bounds
+ */
+size_t pqueue_update_key(PQUEUE_ANY pqueue, size_t index, const void *value);
+
+#ifdef UNITTESTING
+void pqueue_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file segmented_array.h
+ * @author gabriel
+ * @brief Arrays stored as a directory of fixed-size chunks, whose elements never move once pushed.
+ * Growing a segmented array only allocates new chunks (and sometimes re-allocates the directory), so
+ * pointers to its elements stay valid until the elements are popped or the array is destroyed.
+ * Chunks hold a power of two of elements : indexing is a shift and a mask.
+ *
+ * @version 0.1
+ * @date 2025-07-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_SEGMENTED_ARRAY_H__
+#define UNSTANDARD_SEGMENTED_ARRAY_H__
+
+#include "allocation.h"
+
+/**
+ * @brief Opaque segmented array.
+ */
+typedef struct segmented_array segmented_array;
+
+/**
+ * @brief Creates an empty segmented array. No chunk is allocated yet.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] size_element size, in bytes, of a single element
+ * @param[in] chunk_shift each chunk holds (1 << chunk_shift) elements
+ * @return segmented_array* the array created
+ */
+segmented_array *segmented_array_create(allocator alloc, u32 size_element, u32 chunk_shift);
+
+/**
+ * @brief Frees a segmented array and all its chunks from the allocator it was created with.
+ * The pointer given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the array
+ * @param[inout] array pointer to the freed array
+ */
+void segmented_array_destroy(allocator alloc, segmented_array **array);
+
+/**
+ * @brief Allocates enough chunks for a segmented array to hold additional elements. Already stored
+ * elements are not moved.
+ *
+ * @param[in] alloc allocator used to create the array
+ * @param[inout] array target array
+ * @param[in] additional_capacity number of supplemental elements the array should be able to hold
+ */
+void segmented_array_ensure_capacity(allocator alloc, segmented_array *array, size_t additional_capacity);
+
+/**
+ * @brief Pushes a value (by shallow copy) at the end of a segmented array if some space can be found for it.
+ *
+ * @param[inout] array target array
+ * @param[in] value pointer to the pushed value
+ * @return void* stable address of the pushed element, or NULL if the array did not have space
+ */
+void *segmented_array_push(segmented_array *array, const void *value);
+
+/**
+ * @brief Removes the last element in a segmented array. The chunks are kept for later pushes.
+ *
+ * @param[inout] array target array
+ * @return true if the tail element was removed
+ * @return false if the array was empty
+ */
+bool segmented_array_pop(segmented_array *array);
+
+/**
+ * @brief Returns the address of the element at some index.
+ *
+ * @param[in] array target array
+ * @param[in] index index fetched
+ * @return void* address of the element, or NULL if the index is out of bounds
+ */
+void *segmented_array_at(const segmented_array *array, size_t index);
+
+/**
+ * @brief Returns the address of the first element of a chunk, to scan the array chunk by chunk.
+ *
+ * @param[in] array target array
+ * @param[in] chunk_index index of the chunk, from 0 to `segmented_array_nb_chunks()` excluded
+ * @param[out] out_length number of elements in use in the chunk ; can be NULL
+ * @return void* first element of the chunk, or NULL if the chunk holds no element
+ */
+void *segmented_array_chunk(const segmented_array *array, size_t chunk_index, size_t *out_length);
+
+/**
+ * @brief Returns the number of chunks holding at least one element.
+ *
+ * @param[in] array target array
+ * @return size_t number of chunks in use
+ */
+size_t segmented_array_nb_chunks(const segmented_array *array);
+
+/**
+ * @brief Returns the current length of a segmented array.
+ *
+ * @param[in] array target array
+ * @return size_t number of elements in the array
+ */
+size_t segmented_array_length(const segmented_array *array);
+
+/**
+ * @brief Returns the current capacity of a segmented array.
+ *
+ * @param[in] array target array
+ * @return size_t number of elements the allocated chunks can hold
+ */
+size_t segmented_array_capacity(const segmented_array *array);
+
+/**
+ * @brief Clears a segmented array of all its content. The chunks are kept for later pushes.
+ *
+ * @param[inout] array cleared array
+ */
+void segmented_array_clear(segmented_array *array);
+
+#ifdef UNITTESTING
+void segmented_array_execute_unittests(void);
+#endif
+
+#endif
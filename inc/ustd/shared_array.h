@@ -0,0 +1,131 @@
+/**
+ * @file shared_array.h
+ * @author gabriel
+ * @brief Reference-counted arrays with copy-on-write semantics.
+ * Cloning a shared array only bumps its reference count : every clone is the same pointer to the same
+ * memory. Functions that modify a shared array take a pointer to the handle ; if other handles still
+ * refer to the same memory, the content is first copied into a new array that only this handle owns.
+ * A shared array shares its header layout with the arrays of array.h, so the read-only array functions
+ * (`array_length()`, `array_get()`, `array_find()`...) can be used on it. Do not use the modifying
+ * functions of array.h on it, as they would be seen by every clone.
+ *
+ * Reference counts are atomic, so clones can be handed to, and released by, other threads.
+ *
+ * @version 0.1
+ * @date 2025-07-31
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_SHARED_ARRAY_H__
+#define UNSTANDARD_SHARED_ARRAY_H__
+
+#include "array.h"
+
+#define SHARED_ARRAY(type_) type_ *
+#define SHARED_ARRAY_ANY void *
+
+/**
+ * @brief Creates an empty shared array, referenced once.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] size_element size, in bytes, of a single element
+ * @param[in] nb_elements_max number of elements the array can hold before growing
+ * @return SHARED_ARRAY_ANY the shared array created
+ */
+SHARED_ARRAY_ANY shared_array_create(allocator alloc, u32 size_element, size_t nb_elements_max);
+
+/**
+ * @brief Creates a shared array holding a copy of all elements of a regular array, referenced once.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] array array whose elements are copied
+ * @return SHARED_ARRAY_ANY the shared array created
+ */
+SHARED_ARRAY_ANY shared_array_create_from_array(allocator alloc, const ARRAY_ANY array);
+
+/**
+ * @brief Returns a new handle to the same shared array, in constant time.
+ *
+ * @param[in] shared_array cloned array
+ * @return SHARED_ARRAY_ANY the same array, referenced once more
+ */
+SHARED_ARRAY_ANY shared_array_clone(SHARED_ARRAY_ANY shared_array);
+
+/**
+ * @brief Drops a handle to a shared array. The memory is freed from the allocator it was created with
+ * once the last handle is dropped.
+ * The pointer to the handle given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the array
+ * @param[inout] shared_array pointer to the dropped handle
+ */
+void shared_array_destroy(allocator alloc, SHARED_ARRAY_ANY *shared_array);
+
+/**
+ * @brief Returns the number of handles referring to a shared array.
+ *
+ * @param[in] shared_array target array
+ * @return size_t
+ */
+size_t shared_array_refcount(const SHARED_ARRAY_ANY shared_array);
+
+/**
+ * @brief Makes sure a handle is the only one referring to its array, copying the array if it is not.
+ * The other handles keep referring to the original content.
+ *
+ * @param[in] alloc allocator used to create the array
+ * @param[inout] shared_array target handle
+ * @return true if the handle is now the only owner of its array
+ * @return false if the copy could not be allocated
+ */
+bool shared_array_make_unique(allocator alloc, SHARED_ARRAY_ANY *shared_array);
+
+/**
+ * @brief Makes a handle unique, then re-allocates its array if it needs extra space to store additional elements.
+ *
+ * @param[in] alloc allocator used to create the array
+ * @param[inout] shared_array target handle
+ * @param[in] additional_capacity number of supplemental elements the array should be able to hold
+ */
+void shared_array_ensure_capacity(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t additional_capacity);
+
+/**
+ * @brief Makes a handle unique, then pushes a value (by shallow copy) at the end of its array, growing it if needed.
+ *
+ * @param[in] alloc allocator used to create the array
+ * @param[inout] shared_array target handle
+ * @param[in] value pointer to the pushed value
+ * @return true if the element was pushed
+ * @return false if some allocation failed
+ */
+bool shared_array_push(allocator alloc, SHARED_ARRAY_ANY *shared_array, const void *value);
+
+/**
+ * @brief Makes a handle unique, then overwrites the element at some index of its array.
+ *
+ * @param[in] alloc allocator used to create the array
+ * @param[inout] shared_array target handle
+ * @param[in] index index of the overwritten element
+ * @param[in] value pointer to the new value
+ * @return true if the element was overwritten
+ * @return false if the index was out of bounds or some allocation failed
+ */
+bool shared_array_set(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t index, const void *value);
+
+/**
+ * @brief Makes a handle unique, then removes the element at some index of its array.
+ *
+ * @param[in] alloc allocator used to create the array
+ * @param[inout] shared_array target handle
+ * @param[in] index deletion index
+ * @return true if an element was removed at the index
+ * @return false if the index was out of bounds or some allocation failed
+ */
+bool shared_array_remove(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t index);
+
+#ifdef UNITTESTING
+void shared_array_execute_unittests(void);
+#endif
+
+#endif
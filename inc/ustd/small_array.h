@@ -0,0 +1,95 @@
+/**
+ * @file small_array.h
+ * @author gabriel
+ * @brief Arrays that keep their first elements in inline storage, and only spill to an allocator when
+ * they outgrow it.
+ * A small array is a plain struct that can live on the stack or inside another struct. Its `array`
+ * member is always a valid array of array.h, so every function of that header can be used on it.
+ *
+ * @warning The `array` member points inside the small array itself while the elements are stored inline :
+ * do not copy a small array by value, or re-initialize the copy.
+ *
+ * @version 0.1
+ * @date 2025-07-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_SMALL_ARRAY_H__
+#define UNSTANDARD_SMALL_ARRAY_H__
+
+#include "array.h"
+
+/**
+ * @brief Type definition of a small array of `type_` with some inline capacity.
+ * The fields after `array` mirror the header of an allocated array.
+ */
+#define SMALL_ARRAY(type_, inline_capacity_) \
+        struct { ARRAY(type_) array; size_t length; size_t capacity; u32 stride; byte inline_data[(inline_capacity_) * sizeof(type_)]; }
+
+/**
+ * @brief Pointer to any kind of small array.
+ */
+#define SMALL_ARRAY_ANY void *
+
+/**
+ * @brief Initializes a small array (passed by pointer) deducing its stride and inline capacity from its type.
+ */
+#define SMALL_ARRAY_INIT(small_array_) \
+        small_array_init((small_array_), sizeof(*(small_array_)->array), \
+                sizeof((small_array_)->inline_data) / sizeof(*(small_array_)->array))
+
+/**
+ * @brief Initializes a small array to an empty array using its inline storage.
+ *
+ * @param[out] small_array target small array
+ * @param[in] size_element size, in bytes, of a single element
+ * @param[in] inline_capacity number of elements the inline storage can hold
+ * @return ARRAY_ANY the array now usable through the `array` member
+ */
+ARRAY_ANY small_array_init(SMALL_ARRAY_ANY small_array, u32 size_element, size_t inline_capacity);
+
+/**
+ * @brief Frees the allocated storage of a small array if it had to spill, and resets it to an empty
+ * array using its inline storage.
+ *
+ * @param[in] alloc allocator used to grow the small array
+ * @param[inout] small_array target small array
+ */
+void small_array_release(allocator alloc, SMALL_ARRAY_ANY small_array);
+
+/**
+ * @brief Returns wether the elements of a small array are still stored inline.
+ *
+ * @param[in] small_array target small array
+ * @return true if no allocation was made for the small array
+ * @return false if the small array spilled to the allocator
+ */
+bool small_array_is_inline(const SMALL_ARRAY_ANY small_array);
+
+/**
+ * @brief Makes sure a small array can hold additional elements, moving its content from the inline
+ * storage to the allocator on the first overflow.
+ *
+ * @param[in] alloc allocator used to grow the small array
+ * @param[inout] small_array target small array
+ * @param[in] additional_capacity number of supplemental elements the array should be able to hold
+ */
+void small_array_ensure_capacity(allocator alloc, SMALL_ARRAY_ANY small_array, size_t additional_capacity);
+
+/**
+ * @brief Pushes a value (by shallow copy) at the end of a small array, growing it if needed.
+ *
+ * @param[in] alloc allocator used to grow the small array
+ * @param[inout] small_array target small array
+ * @param[in] value pointer to the pushed value
+ * @return true if the element was pushed
+ * @return false if the small array was invalid
+ */
+bool small_array_push(allocator alloc, SMALL_ARRAY_ANY small_array, const void *value);
+
+#ifdef UNITTESTING
+void small_array_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file snapshot.h
+ * @author gabriel
+ * @brief Binary snapshots of arrays and hashmaps, written to a file and mapped back into memory.
+ * A snapshot file holds the image of the container exactly as it lives in memory : header, stride, keys
+ * and elements. Loading maps the file and hands out a pointer inside the mapping, so nothing is copied nor
+ * parsed, and pages are only read from the disk when they are first touched.
+ * Loaded containers are read-only : use the read-only functions of array.h and hashmap.h on them, and
+ * copy them (with `array_append()`, for example) into an allocated container to modify them.
+ *
+ * Snapshots are only meant to be read on the same kind of machine that wrote them : loading fails if the
+ * byte order or the size of the headers differ.
+ *
+ * @version 0.1
+ * @date 2025-08-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_SNAPSHOT_H__
+#define UNSTANDARD_SNAPSHOT_H__
+
+#include "filereading.h"
+#include "array.h"
+#include "hashmap.h"
+
+/** The file is not a snapshot, or not one of the expected kind or version. */
+#define FILE_OP_BAD_FORMAT  (-3)
+
+/// Version of the snapshot format written by this library.
+#define SNAPSHOT_VERSION (2u)
+
+/**
+ * @brief A file mapped into memory by snapshot_load_array() or snapshot_load_hashmap().
+ */
+typedef struct snapshot {
+    /// start of the mapping
+    void *mapping;
+    /// size, in bytes, of the mapping
+    size_t size;
+} snapshot;
+
+/**
+ * @brief Writes the image of an array to a file, replacing it if it exists.
+ *
+ * @param[in] path OS-compliant path to the file
+ * @param[in] array saved array
+ * @return i32 (see FILE_OP_* defines)
+ */
+i32 snapshot_write_array(const char *path, const ARRAY_ANY array);
+
+/**
+ * @brief Writes the image of a hashmap, keys included, to a file, replacing it if it exists.
+ * Hashmaps in the middle of an incremental resize are refused : finish their migration first.
+ *
+ * @param[in] path OS-compliant path to the file
+ * @param[in] map saved hashmap
+ * @return i32 (see FILE_OP_* defines)
+ */
+i32 snapshot_write_hashmap(const char *path, const HASHMAP_ANY map);
+
+/**
+ * @brief Maps a snapshot file holding an array. The array stays valid until the snapshot is unloaded.
+ *
+ * @param[in] path OS-compliant path to the file
+ * @param[out] out_snapshot mapping to pass to snapshot_unload()
+ * @param[out] out_error error code (see FILE_OP_* defines) ; can be NULL
+ * @return ARRAY_ANY the read-only array, or NULL if the file could not be loaded
+ */
+ARRAY_ANY snapshot_load_array(const char *path, snapshot *out_snapshot, i32 *out_error);
+
+/**
+ * @brief Maps a snapshot file holding a hashmap. The hashmap stays valid until the snapshot is unloaded.
+ *
+ * @param[in] path OS-compliant path to the file
+ * @param[out] out_snapshot mapping to pass to snapshot_unload()
+ * @param[out] out_error error code (see FILE_OP_* defines) ; can be NULL
+ * @return HASHMAP_ANY the read-only hashmap, or NULL if the file could not be loaded
+ */
+HASHMAP_ANY snapshot_load_hashmap(const char *path, snapshot *out_snapshot, i32 *out_error);
+
+/**
+ * @brief Unmaps a snapshot. The containers loaded from it become invalid.
+ *
+ * @param[inout] target unloaded snapshot, reset to an empty one
+ */
+void snapshot_unload(snapshot *target);
+
+#ifdef UNITTESTING
+void snapshot_execute_unittests(void);
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file soa.h
+ * @author gabriel
+ * @brief Structure-of-arrays container : each field of a record is stored in its own contiguous column.
+ * Passes that only touch one field then only pull that field's bytes into the cache.
+ *
+ * Fields are declared once, at creation, by their sizes. Pairing them with an enum keeps the code readable :
+ *
+ * @code
+ * enum { ENTITY_POSITION, ENTITY_ORIENTATION, ENTITY_FLAGS, ENTITY_NB_FIELDS };
+ *
+ * soa *entities = soa_create(alloc, 64, (u32[ENTITY_NB_FIELDS]) {
+ *         [ENTITY_POSITION] = sizeof(vector3),
+ *         [ENTITY_ORIENTATION] = sizeof(quaternion),
+ *         [ENTITY_FLAGS] = sizeof(u32),
+ * }, ENTITY_NB_FIELDS);
+ *
+ * vector3 *positions = SOA_COLUMN(entities, ENTITY_POSITION, vector3);
+ * @endcode
+ *
+ * @version 0.1
+ * @date 2025-07-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNSTANDARD_SOA_H__
+#define UNSTANDARD_SOA_H__
+
+#include "allocation.h"
+
+/// Alignment, in bytes, of the first element of every column.
+#define SOA_COLUMN_ALIGNMENT (64u)
+
+/**
+ * @brief Fetches a typed pointer to the first element of a column. The pointer is valid until the
+ * container is re-allocated.
+ */
+#define SOA_COLUMN(soa_, field_, type_) ((type_ *) soa_column(soa_, field_))
+
+/**
+ * @brief Opaque structure-of-arrays container.
+ */
+typedef struct soa soa;
+
+/**
+ * @brief Creates an empty container, allocating all of its columns in one go.
+ *
+ * @param[in] alloc allocator to use for the operation
+ * @param[in] nb_elements_max number of records the container can hold
+ * @param[in] field_sizes size, in bytes, of each field
+ * @param[in] nb_fields number of fields
+ * @return soa* the container created
+ */
+soa *soa_create(allocator alloc, size_t nb_elements_max, const u32 *field_sizes, size_t nb_fields);
+
+/**
+ * @brief Frees a container from the allocator it was created with.
+ * The pointer given in argument will be set to NULL.
+ *
+ * @param[in] alloc allocator that was used to create the container
+ * @param[inout] container pointer to the freed container
+ */
+void soa_destroy(allocator alloc, soa **container);
+
+/**
+ * @brief Re-allocates a container if it needs extra space to store additional records.
+ *
+ * @param[in] alloc allocator used to create the container
+ * @param[inout] container target container
+ * @param[in] additional_capacity number of supplemental records the container should be able to hold
+ */
+void soa_ensure_capacity(allocator alloc, soa **container, size_t additional_capacity);
+
+/**
+ * @brief Pushes a record at the end of the container, copying one value in each column.
+ *
+ * @param[inout] container target container
+ * @param[in] values one pointer per field to the pushed value ; a NULL pointer zeroes the field
+ * @return true if the record was pushed
+ * @return false if the container did not have space
+ */
+bool soa_push(soa *container, const void *const *values);
+
+/**
+ * @brief Removes a record using the swapback strategy, in every column.
+ *
+ * @param[inout] container target container
+ * @param[in] index deletion index
+ * @return true if a record was removed at the index
+ * @return false if the index was out of bounds
+ */
+bool soa_remove_swapback(soa *container, size_t index);
+
+/**
+ * @brief Copies one field of a record, and checks bounds.
+ *
+ * @param[in] container target container
+ * @param[in] index index of the record
+ * @param[in] field index of the field
+ * @param[out] out_value pointer to some memory where the value is copied ; can be NULL
+ * @return true if the index and field are valid
+ * @return false otherwise
+ */
+bool soa_get(const soa *container, size_t index, size_t field, void *out_value);
+
+/**
+ * @brief Returns a pointer to the first element of a column.
+ *
+ * @param[in] container target container
+ * @param[in] field index of the field
+ * @return void* start of the column, or NULL if the field does not exist
+ */
+void *soa_column(const soa *container, size_t field);
+
+/**
+ * @brief Returns the number of records in the container.
+ *
+ * @param[in] container target container
+ * @return size_t
+ */
+size_t soa_length(const soa *container);
+
+/**
+ * @brief Returns the number of records the container can hold.
+ *
+ * @param[in] container target container
+ * @return size_t
+ */
+size_t soa_capacity(const soa *container);
+
+/**
+ * @brief Clears a container of all its records.
+ *
+ * @param[inout] container cleared container
+ */
+void soa_clear(soa *container);
+
+#ifdef UNITTESTING
+void soa_execute_unittests(void);
+#endif
+
+#endif
@@ -33,4 +33,38 @@ struct array_impl {
  */
 struct array_impl *array_impl_of(ARRAY_ANY some_array);
 
+/**
+ * @brief Moves an element down a d-ary max-heap (as ordered by the comparator) until both its children
+ * are lesser than it. This is the heapify step of the heap sort.
+ *
+ * @param[inout] array array holding the heap in its first elements
+ * @param[in] length_heap number of elements in the heap
+ * @param[in] index position of the moved element
+ * @param[in] arity number of children of each node (2 for a binary heap)
+ * @param[in] comparator a comparison function for the type of the element
+ * @return size_t the final position of the moved element
+ */
+size_t array_heap_sift_down(ARRAY_ANY array, size_t length_heap, size_t index, u32 arity, comparator_f comparator);
+
+/**
+ * @brief Moves an element up a d-ary max-heap (as ordered by the comparator) until its parent is greater
+ * than it.
+ *
+ * @param[inout] array array holding the heap
+ * @param[in] index position of the moved element
+ * @param[in] arity number of children of each node (2 for a binary heap)
+ * @param[in] comparator a comparison function for the type of the element
+ * @return size_t the final position of the moved element
+ */
+size_t array_heap_sift_up(ARRAY_ANY array, size_t index, u32 arity, comparator_f comparator);
+
+/**
+ * @brief Re-orders all elements of an array into a d-ary max-heap, in linear time.
+ *
+ * @param[inout] array target array
+ * @param[in] arity number of children of each node (2 for a binary heap)
+ * @param[in] comparator a comparison function for the type of the element
+ */
+void array_heap_build(ARRAY_ANY array, u32 arity, comparator_f comparator);
+
 #endif
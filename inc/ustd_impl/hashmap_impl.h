@@ -0,0 +1,56 @@
+/**
+ * @file hashmap_impl.h
+ * @author gabriel
+ * @brief Implementation details of the hashmap module, for modules that need to build or inspect hashmaps
+ * directly.
+ * @version 0.1
+ * @date 2025-08-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef UNSTANDARD_HASHMAP_IMPL_H__
+#define UNSTANDARD_HASHMAP_IMPL_H__
+
+#include "../ustd/hashmap.h"
+#include "../ustd/bitset.h"
+
+/**
+ * @brief State of an incremental resize : the previous, smaller, table of a hashmap, whose elements are
+ * moved into the new table a few at a time.
+ */
+struct hashmap_migration {
+    /// previous table, emptied from its start
+    HASHMAP_ANY previous;
+    /// index of the first element of the previous table that was not merged into the new table
+    size_t next;
+    /// number of elements still living in the previous table
+    size_t remaining;
+    /// elements of the previous table removed before the migration reached them
+    BITSET removed;
+};
+
+/**
+ * @brief Hashmap header. The fields after `keys` mirror the header of an array, holding the values in the
+ * order of their sorted hashes.
+ */
+struct hashmap_impl {
+    struct hashmap_migration *migration;
+    ARRAY(u32) keys;
+
+    size_t length;
+    size_t capacity;
+    u32 stride;
+    byte data[];
+};
+
+/**
+ * @brief
+ *
+ * @param map
+ * @return struct hashmap_impl*
+ */
+struct hashmap_impl *hashmap_impl_of(HASHMAP_ANY map);
+
+#endif
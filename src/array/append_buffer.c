@@ -0,0 +1,370 @@
+
+#include <stdatomic.h>
+#include <threads.h>
+
+#include <ustd/append_buffer.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+/// Number of spins on the commit cursor before a waiting producer gives its time slice away.
+#define APPEND_BUFFER_SPINS_BEFORE_YIELD (64u)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Append buffer header. Cursors only ever grow : the slot of an element is its cursor value modulo
+ * the capacity.
+ */
+struct append_buffer_impl {
+    /// next cursor handed to a producer
+    _Atomic size_t reserved;
+    /// every element before this cursor is written
+    _Atomic size_t committed;
+    /// every element before this cursor was released by the consumer
+    _Atomic size_t released;
+
+    size_t capacity;
+    u32 stride;
+    byte data[];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief
+ *
+ * @param buffer
+ * @return struct append_buffer_impl*
+ */
+static struct append_buffer_impl *append_buffer_impl_of(APPEND_BUFFER_ANY buffer);
+
+/**
+ * @brief Tells the CPU the calling thread is spinning, so a sibling hardware thread can run meanwhile.
+ */
+static inline void append_buffer_relax(void);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+APPEND_BUFFER_ANY append_buffer_create(allocator alloc, u32 size_element, size_t nb_elements_max)
+{
+    struct append_buffer_impl *new_buffer = nullptr;
+
+    if ((size_element == 0) || (nb_elements_max == 0)) {
+        return nullptr;
+    }
+
+    new_buffer = alloc.malloc(alloc, sizeof(*new_buffer) + (size_element * nb_elements_max));
+
+    if (!new_buffer) {
+        return nullptr;
+    }
+
+    atomic_init(&new_buffer->reserved, 0);
+    atomic_init(&new_buffer->committed, 0);
+    atomic_init(&new_buffer->released, 0);
+    new_buffer->capacity = nb_elements_max;
+    new_buffer->stride = size_element;
+
+    return &(new_buffer->data);
+}
+
+// -----------------------------------------------------------------------------
+
+void append_buffer_destroy(allocator alloc, APPEND_BUFFER_ANY *buffer)
+{
+    if (!buffer || !*buffer) {
+        return;
+    }
+
+    alloc.free(alloc, append_buffer_impl_of(*buffer));
+    *buffer = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool append_buffer_push(APPEND_BUFFER_ANY buffer, const void *value)
+{
+    struct append_buffer_impl *target = nullptr;
+    size_t cursor = 0;
+    size_t expected = 0;
+    u32 nb_spins = 0;
+
+    if (!buffer || !value) {
+        return false;
+    }
+
+    target = append_buffer_impl_of(buffer);
+
+    // reserve a slot, unless it would overwrite elements the consumer still holds
+    cursor = atomic_load_explicit(&target->reserved, memory_order_relaxed);
+    do {
+        if ((cursor - atomic_load_explicit(&target->released, memory_order_acquire)) >= target->capacity) {
+            return false;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&target->reserved, &cursor, cursor + 1,
+            memory_order_relaxed, memory_order_relaxed));
+
+    bytewise_copy(target->data + ((cursor % target->capacity) * target->stride), value, target->stride);
+
+    // publish in reservation order : this waits on the producers that reserved earlier slots
+    expected = cursor;
+    while (!atomic_compare_exchange_weak_explicit(&target->committed, &expected, cursor + 1,
+            memory_order_release, memory_order_relaxed)) {
+        expected = cursor;
+        nb_spins += 1;
+        if (nb_spins < APPEND_BUFFER_SPINS_BEFORE_YIELD) {
+            append_buffer_relax();
+        } else {
+            // an earlier producer may have been preempted
+            thrd_yield();
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool append_buffer_drain(APPEND_BUFFER_ANY buffer, ARRAY_VIEW *out_span)
+{
+    struct append_buffer_impl *target = nullptr;
+    size_t committed = 0;
+    size_t released = 0;
+    size_t slot = 0;
+
+    if (!buffer || !out_span) {
+        return false;
+    }
+
+    target = append_buffer_impl_of(buffer);
+    committed = atomic_load_explicit(&target->committed, memory_order_acquire);
+    released = atomic_load_explicit(&target->released, memory_order_relaxed);
+
+    if (committed == released) {
+        return false;
+    }
+
+    slot = released % target->capacity;
+    *out_span = array_view_from_mem(target->data + (slot * target->stride),
+            MIN(committed - released, target->capacity - slot), target->stride);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void append_buffer_release(APPEND_BUFFER_ANY buffer, size_t nb_elements)
+{
+    struct append_buffer_impl *target = nullptr;
+    size_t committed = 0;
+    size_t released = 0;
+
+    if (!buffer) {
+        return;
+    }
+
+    target = append_buffer_impl_of(buffer);
+    committed = atomic_load_explicit(&target->committed, memory_order_acquire);
+    released = atomic_load_explicit(&target->released, memory_order_relaxed);
+
+    atomic_store_explicit(&target->released, released + MIN(nb_elements, committed - released), memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t append_buffer_length(APPEND_BUFFER_ANY buffer)
+{
+    struct append_buffer_impl *target = nullptr;
+
+    if (!buffer) {
+        return 0;
+    }
+
+    target = append_buffer_impl_of(buffer);
+
+    return atomic_load_explicit(&target->committed, memory_order_acquire)
+            - atomic_load_explicit(&target->released, memory_order_acquire);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static struct append_buffer_impl *append_buffer_impl_of(APPEND_BUFFER_ANY buffer)
+{
+    return CONTAINER_OF(buffer, struct append_buffer_impl, data);
+}
+
+// -----------------------------------------------------------------------------
+
+static inline void append_buffer_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile ("yield");
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+#define TEST_APPEND_BUFFER_MAX_PRODUCERS (8u)
+
+/**
+ * @brief Arguments of a test producer : pushes `nb_pushes` values tagged with its id.
+ */
+struct test_producer {
+    APPEND_BUFFER(u64) buffer;
+    u32 id;
+    u32 nb_pushes;
+};
+
+static int test_producer_run(void *arg)
+{
+    struct test_producer *producer = (struct test_producer *) arg;
+    u64 value = 0;
+
+    for (u32 i = 0 ; i < producer->nb_pushes ; i++) {
+        value = ((u64) producer->id << 32u) | i;
+        while (!append_buffer_push(producer->buffer, &value)) {
+            thrd_yield();
+        }
+    }
+
+    return 0;
+}
+
+tst_CREATE_TEST_SCENARIO(append_buffer_producers,
+        {
+            size_t capacity;
+            u32 nb_producers;
+            u32 nb_pushes;
+        },
+        {
+            APPEND_BUFFER(u64) buffer = append_buffer_create(make_system_allocator(), sizeof(u64), data->capacity);
+            struct test_producer producers[TEST_APPEND_BUFFER_MAX_PRODUCERS] = { 0 };
+            thrd_t threads[TEST_APPEND_BUFFER_MAX_PRODUCERS] = { 0 };
+            u32 next_expected[TEST_APPEND_BUFFER_MAX_PRODUCERS] = { 0 };
+            size_t nb_received = 0;
+            size_t nb_total = (size_t) data->nb_producers * data->nb_pushes;
+            bool in_order = true;
+            ARRAY_VIEW span = { 0 };
+            u64 value = 0;
+
+            for (u32 i = 0 ; i < data->nb_producers ; i++) {
+                producers[i].buffer = buffer;
+                producers[i].id = i;
+                producers[i].nb_pushes = data->nb_pushes;
+                thrd_create(threads + i, &test_producer_run, producers + i);
+            }
+
+            while (nb_received < nb_total) {
+                if (!append_buffer_drain(buffer, &span)) {
+                    thrd_yield();
+                    continue;
+                }
+
+                for (size_t i = 0 ; i < span.length ; i++) {
+                    array_view_get(span, i, &value);
+                    in_order = in_order && ((u32) value == next_expected[value >> 32u]);
+                    next_expected[value >> 32u] += 1;
+                }
+                nb_received += span.length;
+                append_buffer_release(buffer, span.length);
+            }
+
+            for (u32 i = 0 ; i < data->nb_producers ; i++) {
+                thrd_join(threads[i], nullptr);
+            }
+
+            tst_assert(in_order, "values of a producer were received out of order");
+            tst_assert_equal(nb_total, nb_received, "received %ld values");
+            tst_assert_equal(0, append_buffer_length(buffer), "%ld values left");
+            tst_assert(!append_buffer_drain(buffer, &span), "drained an empty buffer");
+
+            append_buffer_destroy(make_system_allocator(), (APPEND_BUFFER_ANY *) &buffer);
+        }
+)
+
+tst_CREATE_TEST_CASE(append_buffer_producers_single, append_buffer_producers,
+        .capacity = 16,
+        .nb_producers = 1,
+        .nb_pushes = 1000,
+)
+tst_CREATE_TEST_CASE(append_buffer_producers_many, append_buffer_producers,
+        .capacity = 64,
+        .nb_producers = 8,
+        .nb_pushes = 10000,
+)
+tst_CREATE_TEST_CASE(append_buffer_producers_tiny, append_buffer_producers,
+        .capacity = 1,
+        .nb_producers = 4,
+        .nb_pushes = 500,
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(append_buffer_wrap,
+        {
+            size_t capacity;
+            size_t nb_before;
+            size_t expected_first_span;
+        },
+        {
+            APPEND_BUFFER(u32) buffer = append_buffer_create(make_system_allocator(), sizeof(u32), data->capacity);
+            ARRAY_VIEW span = { 0 };
+            u32 value = 0;
+
+            for (u32 i = 0 ; i < data->nb_before ; i++) {
+                append_buffer_push(buffer, &i);
+            }
+            append_buffer_drain(buffer, &span);
+            append_buffer_release(buffer, span.length);
+
+            for (u32 i = 0 ; i < data->capacity ; i++) {
+                tst_assert(append_buffer_push(buffer, &i), "push %d failed", i);
+            }
+            tst_assert(!append_buffer_push(buffer, &value), "push in a full buffer succeeded");
+
+            tst_assert(append_buffer_drain(buffer, &span), "drain failed");
+            tst_assert_equal(data->expected_first_span, span.length, "first span of %ld");
+            append_buffer_release(buffer, span.length);
+
+            tst_assert_equal(data->capacity - data->expected_first_span, append_buffer_length(buffer), "%ld values left");
+
+            append_buffer_destroy(make_system_allocator(), (APPEND_BUFFER_ANY *) &buffer);
+        }
+)
+
+tst_CREATE_TEST_CASE(append_buffer_wrap_aligned, append_buffer_wrap,
+        .capacity = 8,
+        .nb_before = 8,
+        .expected_first_span = 8,
+)
+tst_CREATE_TEST_CASE(append_buffer_wrap_split, append_buffer_wrap,
+        .capacity = 8,
+        .nb_before = 5,
+        .expected_first_span = 3,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void append_buffer_execute_unittests(void)
+{
+    tst_run_test_case(append_buffer_producers_single);
+    tst_run_test_case(append_buffer_producers_many);
+    tst_run_test_case(append_buffer_producers_tiny);
+
+    tst_run_test_case(append_buffer_wrap_aligned);
+    tst_run_test_case(append_buffer_wrap_split);
+}
+
+#endif
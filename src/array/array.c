@@ -1,5 +1,6 @@
 
 #include <ustd_impl/array_impl.h>
+#include <ustd/array_view.h>
 
 // -------------------------------------------------------------------------------------------------
 // -------------------------------------------------------------------------------------------------
@@ -24,6 +25,9 @@ ARRAY_ANY array_create(allocator alloc, u32 size_element, size_t nb_elements_max
     }
 
     new_array = alloc.malloc(alloc, sizeof(*new_array) + (size_element * nb_elements_max));
+    if (!new_array) {
+        return nullptr;
+    }
 
     new_array->capacity = nb_elements_max;
     new_array->length = 0;
@@ -215,71 +219,25 @@ void array_clear(ARRAY_ANY array)
 
 bool array_get(ARRAY_ANY array, size_t index, void *out_value)
 {
-    struct array_impl *target = nullptr;
-
     if (!array) {
         return false;
     }
 
-    target = array_impl_of(array);
-
-    if (index >= target->length) {
-        return false;
-    }
-
-    if (out_value) {
-        bytewise_copy(out_value,
-                target->data + (index*target->stride),
-                target->stride);
-    }
-
-    return true;
+    return array_view_get(array_view_of(array), index, out_value);
 }
 
 // -------------------------------------------------------------------------------------------------
 
 bool array_find(ARRAY_ANY haystack, comparator_f comparator, void *needle, size_t *out_position)
 {
-    size_t idx = 0;
-    bool found = false;
-
-    struct array_impl *target = nullptr;
-
-    target = array_impl_of(haystack);
-
-    while ((idx < target->length) && !found) {
-        found = (comparator(target->data + (idx * target->stride), needle) == 0);
-        idx += !found;
-    }
-
-    if (found && out_position) {
-        *out_position = idx;
-    }
-
-    return found;
+    return array_view_find(array_view_of(haystack), comparator, needle, out_position);
 }
 
 // -------------------------------------------------------------------------------------------------
 
 bool array_find_back(ARRAY_ANY haystack, comparator_f comparator, void *needle, size_t *out_position)
 {
-    size_t idx = array_length(haystack);
-    bool found = false;
-
-    struct array_impl *target = nullptr;
-
-    target = array_impl_of(haystack);
-
-    while ((idx > 0) && !found) {
-        found = (comparator(target->data + ((idx - 1) * target->stride), needle) == 0);
-        idx -= !found;
-    }
-
-    if (found && out_position) {
-        *out_position = idx - 1;
-    }
-
-    return found;
+    return array_view_find_back(array_view_of(haystack), comparator, needle, out_position);
 }
 
 // -------------------------------------------------------------------------------------------------
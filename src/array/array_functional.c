@@ -0,0 +1,384 @@
+
+#include <stdatomic.h>
+#include <threads.h>
+
+#include <ustd/array_functional.h>
+#include <ustd_impl/array_impl.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Maximum number of ranges a pass is cut into.
+#define ARRAY_PASS_MAX_RANGES (ARRAY_PARALLEL_MAX_THREADS * 4u)
+
+/**
+ * @brief Kind of work done on each range of a pass.
+ */
+enum array_pass_kind {
+    ARRAY_PASS_FILTER,
+    ARRAY_PASS_MAP,
+    ARRAY_PASS_REDUCE,
+};
+
+/**
+ * @brief Contiguous blocks of the source array handled by a single thread.
+ */
+struct array_pass_range {
+    size_t start;
+    size_t end;
+    /// number of elements kept by a filter, compacted at the start of the range
+    size_t nb_kept;
+    /// partial result of a reduction
+    byte *accumulator;
+};
+
+/**
+ * @brief Shared state of a pass : threads take ranges in turn until none is left.
+ */
+struct array_pass {
+    enum array_pass_kind kind;
+    struct array_impl *source;
+    struct array_impl *destination;
+    union {
+        array_predicate_f predicate;
+        array_transform_f transform;
+        array_combine_f combine;
+    };
+    void *context;
+
+    _Atomic size_t next_range;
+    size_t nb_ranges;
+    struct array_pass_range ranges[ARRAY_PASS_MAX_RANGES];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Cuts the source array of a pass into ranges, and runs it on as many threads as requested.
+ * Maps are cut in blocks, so the threads balance their load ; filters and reductions are cut in one
+ * range of blocks per thread, since their ranges are merged in order afterwards.
+ *
+ * @param pass
+ * @param parallel
+ * @param accumulators
+ */
+static void array_pass_run(struct array_pass *pass, const array_parallel *parallel, byte *accumulators);
+
+/**
+ * @brief Thread entry point : takes and processes ranges until none is left.
+ *
+ * @param pass
+ * @return int
+ */
+static int array_pass_work(void *pass);
+
+/**
+ * @brief Processes a single range of a pass.
+ *
+ * @param pass
+ * @param range
+ */
+static void array_pass_process(struct array_pass *pass, struct array_pass_range *range);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+size_t array_filter(ARRAY_ANY array, array_predicate_f predicate, void *context, const array_parallel *parallel)
+{
+    struct array_pass pass = { 0 };
+    size_t nb_kept = 0;
+
+    if (!array || !predicate) {
+        return 0;
+    }
+
+    pass.kind = ARRAY_PASS_FILTER;
+    pass.source = array_impl_of(array);
+    pass.predicate = predicate;
+    pass.context = context;
+
+    array_pass_run(&pass, parallel, nullptr);
+
+    // ranges are compacted in place, bring them together
+    nb_kept = pass.ranges[0].nb_kept;
+    for (size_t i = 1 ; i < pass.nb_ranges ; i++) {
+        if (nb_kept != pass.ranges[i].start) {
+            bytewise_copy(pass.source->data + (nb_kept * pass.source->stride),
+                    pass.source->data + (pass.ranges[i].start * pass.source->stride),
+                    pass.ranges[i].nb_kept * pass.source->stride);
+        }
+        nb_kept += pass.ranges[i].nb_kept;
+    }
+
+    pass.source->length = nb_kept;
+
+    return nb_kept;
+}
+
+// -----------------------------------------------------------------------------
+
+bool array_map(ARRAY_ANY array, array_transform_f transform, void *context, ARRAY_ANY out_array, const array_parallel *parallel)
+{
+    struct array_pass pass = { 0 };
+
+    if (!array || !transform || !out_array) {
+        return false;
+    }
+
+    pass.kind = ARRAY_PASS_MAP;
+    pass.source = array_impl_of(array);
+    pass.destination = array_impl_of(out_array);
+    pass.transform = transform;
+    pass.context = context;
+
+    if (pass.destination->capacity < pass.source->length) {
+        return false;
+    }
+
+    array_pass_run(&pass, parallel, nullptr);
+    pass.destination->length = pass.source->length;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool array_reduce(ARRAY_ANY array, array_combine_f combine, void *context, void *inout_accumulator, const array_parallel *parallel)
+{
+    struct array_pass pass = { 0 };
+
+    if (!array || !combine || !inout_accumulator) {
+        return false;
+    }
+
+    pass.kind = ARRAY_PASS_REDUCE;
+    pass.source = array_impl_of(array);
+    pass.combine = combine;
+    pass.context = context;
+
+    byte accumulators[ARRAY_PARALLEL_MAX_THREADS * pass.source->stride];
+    for (size_t i = 0 ; i < ARRAY_PARALLEL_MAX_THREADS ; i++) {
+        bytewise_copy(accumulators + (i * pass.source->stride), inout_accumulator, pass.source->stride);
+    }
+
+    array_pass_run(&pass, parallel, accumulators);
+
+    // every range started from the initial value : the partials replace it instead of being folded into it
+    bytewise_copy(inout_accumulator, pass.ranges[0].accumulator, pass.source->stride);
+    for (size_t i = 1 ; i < pass.nb_ranges ; i++) {
+        combine(inout_accumulator, pass.ranges[i].accumulator, context);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static void array_pass_run(struct array_pass *pass, const array_parallel *parallel, byte *accumulators)
+{
+    thrd_t threads[ARRAY_PARALLEL_MAX_THREADS] = { 0 };
+    bool started[ARRAY_PARALLEL_MAX_THREADS] = { 0 };
+    size_t nb_threads = 1;
+    size_t block_length = 0;
+    size_t nb_blocks = 0;
+    size_t blocks_per_range = 0;
+    size_t length = pass->source->length;
+
+    if (parallel && (parallel->nb_threads > 1)) {
+        nb_threads = MIN(parallel->nb_threads, ARRAY_PARALLEL_MAX_THREADS);
+        block_length = parallel->block_length;
+    }
+    if (block_length == 0) {
+        block_length = MAX(ARRAY_PARALLEL_BLOCK_SIZE / pass->source->stride, 1u);
+    }
+
+    nb_blocks = MAX(CEIL_DIV(length, block_length), 1u);
+    nb_threads = MIN(nb_threads, nb_blocks);
+
+    if (pass->kind == ARRAY_PASS_MAP) {
+        // many small ranges of blocks, taken by whichever thread is free
+        blocks_per_range = CEIL_DIV(nb_blocks, ARRAY_PASS_MAX_RANGES);
+    } else {
+        blocks_per_range = CEIL_DIV(nb_blocks, nb_threads);
+    }
+
+    pass->nb_ranges = 0;
+    for (size_t start = 0 ; (start < length) || (pass->nb_ranges == 0) ; start += blocks_per_range * block_length) {
+        pass->ranges[pass->nb_ranges] = (struct array_pass_range) {
+                .start = start,
+                .end = MIN(start + (blocks_per_range * block_length), length),
+                .accumulator = accumulators ? (accumulators + (pass->nb_ranges * pass->source->stride)) : nullptr,
+        };
+        pass->nb_ranges += 1;
+    }
+    atomic_init(&pass->next_range, 0);
+
+    for (size_t i = 1 ; i < nb_threads ; i++) {
+        started[i] = (thrd_create(threads + i, &array_pass_work, pass) == thrd_success);
+    }
+
+    array_pass_work(pass);
+
+    for (size_t i = 1 ; i < nb_threads ; i++) {
+        if (started[i]) {
+            thrd_join(threads[i], nullptr);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+static int array_pass_work(void *pass)
+{
+    struct array_pass *target = (struct array_pass *) pass;
+    size_t range = 0;
+
+    range = atomic_fetch_add_explicit(&target->next_range, 1, memory_order_relaxed);
+    while (range < target->nb_ranges) {
+        array_pass_process(target, target->ranges + range);
+        range = atomic_fetch_add_explicit(&target->next_range, 1, memory_order_relaxed);
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+static void array_pass_process(struct array_pass *pass, struct array_pass_range *range)
+{
+    const u32 stride = pass->source->stride;
+    byte *element = nullptr;
+    size_t nb_kept = 0;
+
+    for (size_t i = range->start ; i < range->end ; i++) {
+        element = pass->source->data + (i * stride);
+
+        switch (pass->kind) {
+            case ARRAY_PASS_FILTER:
+                if (pass->predicate(element, pass->context)) {
+                    if (range->start + nb_kept != i) {
+                        bytewise_copy(pass->source->data + ((range->start + nb_kept) * stride), element, stride);
+                    }
+                    nb_kept += 1;
+                }
+                break;
+            case ARRAY_PASS_MAP:
+                pass->transform(element, pass->destination->data + (i * pass->destination->stride), pass->context);
+                break;
+            case ARRAY_PASS_REDUCE:
+                pass->combine(range->accumulator, element, pass->context);
+                break;
+        }
+    }
+
+    range->nb_kept = nb_kept;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+static bool test_is_multiple(const void *element, void *context)
+{
+    return (*(const u32 *) element % *(u32 *) context) == 0;
+}
+
+static void test_square(const void *element, void *out_element, void *context)
+{
+    (void) context;
+    *(u64 *) out_element = (u64) *(const u32 *) element * *(const u32 *) element;
+}
+
+static void test_sum(void *accumulator, const void *element, void *context)
+{
+    (void) context;
+    *(u64 *) accumulator += *(const u64 *) element;
+}
+
+tst_CREATE_TEST_SCENARIO(array_functional_passes,
+        {
+            size_t length;
+            u32 divisor;
+            array_parallel parallel;
+            u64 initial_sum;
+        },
+        {
+            ARRAY(u32) numbers = array_create(make_system_allocator(), sizeof(u32), data->length + 1);
+            ARRAY(u64) squares = array_create(make_system_allocator(), sizeof(u64), data->length + 1);
+            u64 sum = data->initial_sum;
+            u64 expected_sum = data->initial_sum;
+            size_t expected_length = 0;
+            bool in_order = true;
+
+            for (u32 i = 0 ; i < data->length ; i++) {
+                array_push(numbers, &i);
+                if ((i % data->divisor) == 0) {
+                    expected_sum += (u64) i * i;
+                    expected_length += 1;
+                }
+            }
+
+            tst_assert_equal(expected_length, array_filter(numbers, &test_is_multiple, &data->divisor, &data->parallel), "filtered length of %ld");
+            for (size_t i = 0 ; i < array_length(numbers) ; i++) {
+                in_order = in_order && (numbers[i] == i * data->divisor);
+            }
+            tst_assert(in_order, "filtered elements are out of order");
+
+            tst_assert(array_map(numbers, &test_square, nullptr, squares, &data->parallel), "map failed");
+            tst_assert_equal(expected_length, array_length(squares), "mapped length of %ld");
+
+            tst_assert(array_reduce(squares, &test_sum, nullptr, &sum, &data->parallel), "reduce failed");
+            tst_assert_equal(expected_sum, sum, "sum of %ld");
+
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &numbers);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &squares);
+        }
+)
+
+tst_CREATE_TEST_CASE(array_functional_passes_sequential, array_functional_passes,
+        .length = 10000,
+        .divisor = 3,
+        .parallel = { 0 },
+)
+tst_CREATE_TEST_CASE(array_functional_passes_parallel, array_functional_passes,
+        .length = 100000,
+        .divisor = 7,
+        .parallel = { .nb_threads = 4 },
+)
+tst_CREATE_TEST_CASE(array_functional_passes_small_blocks, array_functional_passes,
+        .length = 1000,
+        .divisor = 2,
+        .parallel = { .nb_threads = 8, .block_length = 10 },
+)
+tst_CREATE_TEST_CASE(array_functional_passes_empty, array_functional_passes,
+        .length = 0,
+        .divisor = 2,
+        .parallel = { .nb_threads = 8 },
+)
+tst_CREATE_TEST_CASE(array_functional_passes_initial_value, array_functional_passes,
+        .length = 1000,
+        .divisor = 5,
+        .parallel = { 0 },
+        .initial_sum = 100,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void array_functional_execute_unittests(void)
+{
+    tst_run_test_case(array_functional_passes_sequential);
+    tst_run_test_case(array_functional_passes_parallel);
+    tst_run_test_case(array_functional_passes_small_blocks);
+    tst_run_test_case(array_functional_passes_empty);
+    tst_run_test_case(array_functional_passes_initial_value);
+}
+
+#endif
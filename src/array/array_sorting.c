@@ -1,24 +1,27 @@
 
 #include <ustd_impl/array_impl.h>
-
-#include <math.h>
+#include <ustd/array_view.h>
 
 // -------------------------------------------------------------------------------------------------
 // -------------------------------------------------------------------------------------------------
 // -------------------------------------------------------------------------------------------------
 
-#define PARENT(index) (((index) >> (1u))-(1u))
-#define LEFT(index)   (((index) << (1u))+(1u))
-#define RIGHT(index)  ((((index) << (1u)) | 0x1)+(1u))
+#define PARENT(index, arity) (((index) - (1u)) / (arity))
+#define FIRST_CHILD(index, arity) (((index) * (arity)) + (1u))
 
 // -------------------------------------------------------------------------------------------------
 // -------------------------------------------------------------------------------------------------
 
 static void swap_pointed(u8 pos1[static 1], u8 pos2[static 1], size_t datasize);
 
-static void heapify(void *array, size_t length_heap, size_t index, comparator_f comparator);
+static void heap_sort_prefix(void *array, size_t length, comparator_f comparator);
+
+static void partition_three_way(struct array_impl *target, size_t start, size_t end, comparator_f comparator,
+        size_t *out_equal_start, size_t *out_equal_end);
 
-static void build_heap(void *array, comparator_f comparator);
+static void heap_select_range(struct array_impl *target, size_t start, size_t end, size_t nth, comparator_f comparator);
+
+static void heap_sift_down_range(byte *base, u32 stride, size_t length_heap, size_t index, comparator_f comparator);
 
 // -------------------------------------------------------------------------------------------------
 
@@ -26,82 +29,123 @@ void array_sort(void *array, comparator_f comparator)
 {
     struct array_impl *target = array_impl_of(array);
 
-    if (target->length == 0u) {
+    heap_sort_prefix(array, target->length, comparator);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void array_nth_element(void *array, size_t nth, comparator_f comparator)
+{
+    struct array_impl *target = nullptr;
+    size_t start = 0u;
+    size_t end = 0u;
+    size_t equal_start = 0u;
+    size_t equal_end = 0u;
+    size_t depth_limit = 0u;
+
+    if (!array || !comparator) {
         return;
     }
 
-    build_heap(array, comparator);
+    target = array_impl_of(array);
+    end = target->length;
 
-    size_t length_heap = target->length;
+    if (nth >= end) {
+        return;
+    }
 
-    for (size_t i = (target->length - 1u); i >= 1u; i--) {
-        swap_pointed(target->data, (void *) ((uintptr_t) target->data + (uintptr_t) (i * target->stride)), target->stride);
-        length_heap = length_heap - 1u;
-        heapify(array, length_heap, 0u, comparator);
+    // introselect : past 2 log2(n) partitions, bad pivots are assumed and the range is heap-selected
+    for (size_t length = end ; length > 1u ; length >>= 1u) {
+        depth_limit += 2u;
+    }
+
+    while ((end - start) > 1u) {
+        if (depth_limit == 0u) {
+            heap_select_range(target, start, end, nth, comparator);
+            return;
+        }
+        depth_limit -= 1u;
+
+        partition_three_way(target, start, end, comparator, &equal_start, &equal_end);
+
+        if (nth < equal_start) {
+            end = equal_start;
+        } else if (nth >= equal_end) {
+            start = equal_end;
+        } else {
+            return;
+        }
     }
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool array_is_sorted(void *array, comparator_f comparator)
+void array_partial_sort(void *array, size_t nb_sorted, comparator_f comparator)
 {
-    size_t pos = { 0u };
-    struct array_impl *target = array_impl_of(array);
+    struct array_impl *target = nullptr;
 
-    if (target->length == 0u) {
-        return true;
+    if (!array || !comparator) {
+        return;
     }
 
-    pos = 1u;
-    while ((pos < target->length) && (comparator((void *) (target->data + (pos * target->stride)), (void *) (target->data + ((pos - 1) * target->stride))) != -1)) {
-        pos += 1u;
+    target = array_impl_of(array);
+    nb_sorted = MIN(nb_sorted, target->length);
+
+    if (nb_sorted < target->length) {
+        array_nth_element(array, nb_sorted, comparator);
     }
 
-    return (pos == target->length);
+    heap_sort_prefix(array, nb_sorted, comparator);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-bool array_sorted_find(void *haystack, comparator_f comparator, void *needle, size_t *out_position)
+bool array_top_k(void *array, size_t k, comparator_f comparator, void *out_array)
 {
-    i32 beginning = 0u;
-    i32 end = 0u;
-    i32 index = 0u;
-    i32 comp_result = 2;
+    struct array_impl *source = nullptr;
+    struct array_impl *out = nullptr;
 
-    struct array_impl *target = array_impl_of(haystack);
+    if (!array || !comparator || !out_array) {
+        return false;
+    }
 
-    beginning = 0u;
-    end = (i32) target->length - 1;
+    source = array_impl_of(array);
+    out = array_impl_of(out_array);
+    k = MIN(k, source->length);
 
-    while ((beginning <= end) && (comp_result != 0)) {
-        index = (i32) CEIL_DIV(beginning + end, 2);
+    if ((out->stride != source->stride) || (out->capacity < k)) {
+        return false;
+    }
 
-        comp_result = comparator(needle, (void *) (target->data + ((size_t) index * target->stride)));
+    out->length = k;
+    bytewise_copy(out->data, source->data, k * source->stride);
+    array_heap_build(out_array, 2u, comparator);
 
-        if (comp_result == 1) {
-            beginning = index + 1;
-        }
-        else if (comp_result == -1) {
-            end = index - 1;
+    // the root of the heap is the greatest element kept so far : lesser elements evict it
+    for (size_t i = k ; (k > 0u) && (i < source->length) ; i++) {
+        if (comparator((void *) (source->data + (i * source->stride)), (void *) out->data) == -1) {
+            bytewise_copy(out->data, source->data + (i * source->stride), source->stride);
+            array_heap_sift_down(out_array, k, 0u, 2u, comparator);
         }
     }
 
-    while ((index > 0) && (comparator(needle, (void *) (target->data + ((size_t) (index - 1) * target->stride))) == 0)) {
-        index -= 1;
-        comp_result = comparator(needle, (void *) (target->data + ((size_t) index * target->stride)));
-    }
+    heap_sort_prefix(out_array, k, comparator);
 
-    if (out_position != NULL) {
-        if ((comp_result == 0) || (comp_result == -1) || (target->length == 0u)) {
-            *out_position = (size_t) index;
-        }
-        else {
-            *out_position = (size_t) (index + comp_result);
-        }
-    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
 
-    return (comp_result == 0);
+bool array_is_sorted(void *array, comparator_f comparator)
+{
+    return array_view_is_sorted(array_view_of(array), comparator);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_sorted_find(void *haystack, comparator_f comparator, void *needle, size_t *out_position)
+{
+    return array_view_sorted_find(array_view_of(haystack), comparator, needle, out_position);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -147,6 +191,71 @@ size_t array_sorted_insert(void *haystack, comparator_f comparator, void *insert
     return theorical_position;
 }
 
+// -------------------------------------------------------------------------------------------------
+
+size_t array_unique(void *array, comparator_f comparator)
+{
+    struct array_impl *target = nullptr;
+    size_t nb_kept = 1u;
+
+    if (!array || !comparator) {
+        return 0u;
+    }
+
+    target = array_impl_of(array);
+
+    if (target->length == 0u) {
+        return 0u;
+    }
+
+    for (size_t i = 1u ; i < target->length ; i++) {
+        if (comparator((void *) (target->data + (i * target->stride)), (void *) (target->data + ((nb_kept - 1u) * target->stride))) != 0) {
+            if (i != nb_kept) {
+                bytewise_copy(target->data + (nb_kept * target->stride), target->data + (i * target->stride), target->stride);
+            }
+            nb_kept += 1u;
+        }
+    }
+
+    target->length = nb_kept;
+
+    return nb_kept;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_group_runs(void *array, comparator_f comparator, size_t *cursor, size_t *out_begin, size_t *out_end)
+{
+    struct array_impl *target = nullptr;
+    size_t end = 0u;
+
+    if (!array || !comparator || !cursor) {
+        return false;
+    }
+
+    target = array_impl_of(array);
+
+    if (*cursor >= target->length) {
+        return false;
+    }
+
+    end = *cursor + 1u;
+    while ((end < target->length)
+            && (comparator((void *) (target->data + (end * target->stride)), (void *) (target->data + (*cursor * target->stride))) == 0)) {
+        end += 1u;
+    }
+
+    if (out_begin) {
+        *out_begin = *cursor;
+    }
+    if (out_end) {
+        *out_end = end;
+    }
+    *cursor = end;
+
+    return true;
+}
+
 
 // -------------------------------------------------------------------------------------------------
 // -------------------------------------------------------------------------------------------------
@@ -167,28 +276,142 @@ static void swap_pointed(u8 pos1[static 1], u8 pos2[static 1], size_t datasize)
 
 // -------------------------------------------------------------------------------------------------
 
-static void heapify(void *array, size_t length_heap, size_t index, comparator_f comparator)
+static void heap_sort_prefix(void *array, size_t length, comparator_f comparator)
+{
+    struct array_impl *target = array_impl_of(array);
+
+    if (length < 2u) {
+        return;
+    }
+
+    for (size_t i = PARENT(length - 1u, 2u) + 1u ; i > 0u ; i--) {
+        array_heap_sift_down(array, length, i - 1u, 2u, comparator);
+    }
+
+    for (size_t i = (length - 1u); i >= 1u; i--) {
+        swap_pointed(target->data, (void *) ((uintptr_t) target->data + (uintptr_t) (i * target->stride)), target->stride);
+        array_heap_sift_down(array, i, 0u, 2u, comparator);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void partition_three_way(struct array_impl *target, size_t start, size_t end, comparator_f comparator,
+        size_t *out_equal_start, size_t *out_equal_end)
+{
+    size_t candidates[3] = { start, start + ((end - start) / 2u), end - 1u };
+    size_t tmp = 0u;
+    size_t lesser_end = start;
+    size_t greater_start = end;
+    size_t i = start + 1u;
+    i32 comp_result = 0;
+
+    // median of three, moved to the start of the range as the pivot
+    for (size_t pass = 0u ; pass < 2u ; pass++) {
+        for (size_t c = 0u ; c < (2u - pass) ; c++) {
+            if (comparator((void *) (target->data + (candidates[c] * target->stride)), (void *) (target->data + (candidates[c + 1u] * target->stride))) == 1) {
+                tmp = candidates[c];
+                candidates[c] = candidates[c + 1u];
+                candidates[c + 1u] = tmp;
+            }
+        }
+    }
+    if (candidates[1] != start) {
+        swap_pointed(target->data + (start * target->stride), target->data + (candidates[1] * target->stride), target->stride);
+    }
+
+    // the element at `lesser_end` is always equal to the pivot
+    while (i < greater_start) {
+        comp_result = comparator((void *) (target->data + (i * target->stride)), (void *) (target->data + (lesser_end * target->stride)));
+
+        if (comp_result == -1) {
+            swap_pointed(target->data + (i * target->stride), target->data + (lesser_end * target->stride), target->stride);
+            lesser_end += 1u;
+            i += 1u;
+        } else if (comp_result == 1) {
+            greater_start -= 1u;
+            swap_pointed(target->data + (i * target->stride), target->data + (greater_start * target->stride), target->stride);
+        } else {
+            i += 1u;
+        }
+    }
+
+    *out_equal_start = lesser_end;
+    *out_equal_end = greater_start;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void heap_select_range(struct array_impl *target, size_t start, size_t end, size_t nth, comparator_f comparator)
+{
+    byte *base = target->data + (start * target->stride);
+    size_t length_heap = (nth - start) + 1u;
+
+    // max-heap of the smallest elements seen, its root being the greatest of them
+    for (size_t i = (length_heap / 2u) ; i > 0u ; i--) {
+        heap_sift_down_range(base, target->stride, length_heap, i - 1u, comparator);
+    }
+
+    for (size_t i = length_heap ; i < (end - start) ; i++) {
+        if (comparator((void *) (base + (i * target->stride)), (void *) base) == -1) {
+            swap_pointed(base, base + (i * target->stride), target->stride);
+            heap_sift_down_range(base, target->stride, length_heap, 0u, comparator);
+        }
+    }
+
+    if (length_heap > 1u) {
+        swap_pointed(base, base + ((length_heap - 1u) * target->stride), target->stride);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void heap_sift_down_range(byte *base, u32 stride, size_t length_heap, size_t index, comparator_f comparator)
+{
+    size_t child = 0u;
+    size_t imax = 0u;
+
+    for (;;) {
+        child = FIRST_CHILD(index, 2u);
+        imax = index;
+
+        if ((child < length_heap) && (comparator((void *) (base + (child * stride)), (void *) (base + (imax * stride))) == 1)) {
+            imax = child;
+        }
+        if (((child + 1u) < length_heap) && (comparator((void *) (base + ((child + 1u) * stride)), (void *) (base + (imax * stride))) == 1)) {
+            imax = child + 1u;
+        }
+        if (imax == index) {
+            return;
+        }
+
+        swap_pointed(base + (index * stride), base + (imax * stride), stride);
+        index = imax;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+size_t array_heap_sift_down(void *array, size_t length_heap, size_t index, u32 arity, comparator_f comparator)
 {
     size_t imax;
-    size_t left;
-    size_t right;
+    size_t child;
+    size_t last_child;
 
     i32 heaped = 0u;
 
     struct array_impl *target = array_impl_of(array);
 
     while (!heaped) {
-        left = LEFT(index);
-        right = RIGHT(index);
+        child = FIRST_CHILD(index, arity);
+        last_child = MIN(child + arity, length_heap);
 
         imax = index;
 
-        if ((right < length_heap) && (comparator((void *) (target->data + (right * target->stride)), (void *) (target->data + (imax * target->stride))) == 1)) {
-            imax = right;
-        }
-
-        if ((left < length_heap)  && (comparator((void *) (target->data + (left * target->stride)), (void *) (target->data + (imax * target->stride))) == 1)) {
-            imax = left;
+        for ( ; child < last_child ; child++) {
+            if (comparator((void *) (target->data + (child * target->stride)), (void *) (target->data + (imax * target->stride))) == 1) {
+                imax = child;
+            }
         }
 
         heaped = (imax == index);
@@ -198,20 +421,45 @@ static void heapify(void *array, size_t length_heap, size_t index, comparator_f
             index = imax;
         }
     }
+
+    return index;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-static void build_heap(void *array, comparator_f comparator)
+size_t array_heap_sift_up(void *array, size_t index, u32 arity, comparator_f comparator)
 {
-    const size_t start_at = (size_t) ceil((f64) array_length(array) / 2.0F);
+    size_t parent;
+
+    struct array_impl *target = array_impl_of(array);
 
-    for (size_t i = start_at ; i > 0u ; i--) {
-        heapify(array, array_length(array), i, comparator);
+    while (index > 0u) {
+        parent = PARENT(index, arity);
+
+        if (comparator((void *) (target->data + (index * target->stride)), (void *) (target->data + (parent * target->stride))) != 1) {
+            return index;
+        }
+
+        swap_pointed((void *) ((uintptr_t) target->data + (uintptr_t) (parent * target->stride)), (void *) ((uintptr_t) target->data + (uintptr_t) (index * target->stride)), target->stride);
+        index = parent;
     }
-    // last iteration, working with unsigned has its toll
-    if (array_length(array) > 0u) {
-        heapify(array, array_length(array), 0u, comparator);
+
+    return index;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void array_heap_build(void *array, u32 arity, comparator_f comparator)
+{
+    const size_t length = array_length(array);
+
+    if (length < 2u) {
+        return;
+    }
+
+    // working with unsigned has its toll : index 0 is handled by the last iteration
+    for (size_t i = PARENT(length - 1u, arity) + 1u ; i > 0u ; i--) {
+        array_heap_sift_down(array, length, i - 1u, arity, comparator);
     }
 }
 
@@ -515,6 +763,224 @@ tst_CREATE_TEST_CASE(array_sorted_u32_insert_in_empty, array_sorted_insert,
 // -------------------------------------------------------------------------------------------------
 // -------------------------------------------------------------------------------------------------
 
+tst_CREATE_TEST_SCENARIO(array_selection,
+        {
+            size_t length;
+            u32 modulo;
+            size_t k;
+        },
+        {
+            ARRAY(u32) input = array_create(make_system_allocator(), sizeof(u32), data->length + 1);
+            ARRAY(u32) sorted = array_create(make_system_allocator(), sizeof(u32), data->length + 1);
+            ARRAY(u32) selected = array_create(make_system_allocator(), sizeof(u32), data->length + 1);
+            ARRAY(u32) top = array_create(make_system_allocator(), sizeof(u32), data->length + 1);
+            u32 value = 12345u;
+
+            for (size_t i = 0 ; i < data->length ; i++) {
+                value = (value * 1103515245u) + 12345u;
+                array_push(input, &(u32) { (value >> 8u) % data->modulo });
+            }
+            array_append(sorted, input);
+            array_append(selected, input);
+            array_sort(sorted, &test_u32_comparator);
+
+            array_nth_element(selected, data->k, &test_u32_comparator);
+            if (data->k < data->length) {
+                tst_assert_equal(sorted[data->k], selected[data->k], "nth element of %d");
+                for (size_t i = 0 ; i < data->length ; i++) {
+                    tst_assert(((i <= data->k) && (selected[i] <= selected[data->k])) || ((i >= data->k) && (selected[i] >= selected[data->k])),
+                            "element %ld is on the wrong side", i);
+                }
+            }
+
+            array_partial_sort(selected, data->k, &test_u32_comparator);
+            for (size_t i = 0 ; i < MIN(data->k, data->length) ; i++) {
+                tst_assert_equal_ext(sorted[i], selected[i], "%d", "partially sorted at index %ld", i);
+            }
+
+            tst_assert(array_top_k(input, data->k, &test_u32_comparator, top), "top k failed");
+            tst_assert_equal(MIN(data->k, data->length), array_length(top), "top k length of %ld");
+            for (size_t i = 0 ; i < array_length(top) ; i++) {
+                tst_assert_equal_ext(sorted[i], top[i], "%d", "top k at index %ld", i);
+            }
+
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &input);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &sorted);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &selected);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &top);
+        }
+)
+
+tst_CREATE_TEST_CASE(array_selection_median, array_selection,
+        .length = 101,
+        .modulo = 1000,
+        .k = 50,
+)
+tst_CREATE_TEST_CASE(array_selection_duplicates, array_selection,
+        .length = 200,
+        .modulo = 4,
+        .k = 120,
+)
+tst_CREATE_TEST_CASE(array_selection_first, array_selection,
+        .length = 50,
+        .modulo = 100,
+        .k = 0,
+)
+tst_CREATE_TEST_CASE(array_selection_beyond, array_selection,
+        .length = 20,
+        .modulo = 100,
+        .k = 40,
+)
+
+// -------------------------------------------------------------------------------------------------
+
+/* State of the adversary building a median-of-three killer, after M. D. McIlroy's "A Killer Adversary
+for Quicksort". Elements are indices into `values` ; undecided ones hold `gas`, greater than any decided value. */
+static struct {
+    u32 *values;
+    u32 gas;
+    u32 nb_solid;
+    u32 candidate;
+    size_t nb_comparisons;
+} test_adversary;
+
+static i32 test_adversary_comparator(const void *v1, const void *v2) {
+    u32 index1 = *((u32 *) v1);
+    u32 index2 = *((u32 *) v2);
+
+    // the value of a gas element is decided at the last moment, so that it ends up on the bad side of the pivot
+    if ((test_adversary.values[index1] == test_adversary.gas) && (test_adversary.values[index2] == test_adversary.gas)) {
+        if (index1 == test_adversary.candidate) {
+            test_adversary.values[index1] = test_adversary.nb_solid++;
+        } else {
+            test_adversary.values[index2] = test_adversary.nb_solid++;
+        }
+    }
+
+    if (test_adversary.values[index1] == test_adversary.gas) {
+        test_adversary.candidate = index1;
+    } else if (test_adversary.values[index2] == test_adversary.gas) {
+        test_adversary.candidate = index2;
+    }
+
+    return test_u32_comparator(test_adversary.values + index1, test_adversary.values + index2);
+}
+
+static i32 test_counting_comparator(const void *v1, const void *v2) {
+    test_adversary.nb_comparisons += 1u;
+
+    return test_u32_comparator(v1, v2);
+}
+
+tst_CREATE_TEST_SCENARIO(array_selection_killer,
+        {
+            size_t length;
+            size_t k;
+        },
+        {
+            ARRAY(u32) indices = array_create(make_system_allocator(), sizeof(u32), data->length);
+            ARRAY(u32) values = array_create(make_system_allocator(), sizeof(u32), data->length);
+            ARRAY(u32) sorted = array_create(make_system_allocator(), sizeof(u32), data->length);
+            size_t log2_length = 0u;
+
+            for (u32 i = 0 ; i < data->length ; i++) {
+                array_push(indices, &i);
+                array_push(values, &(u32) { (u32) data->length });
+            }
+            test_adversary.values = values;
+            test_adversary.gas = (u32) data->length;
+            test_adversary.nb_solid = 0u;
+            test_adversary.candidate = 0u;
+
+            // the values decided by the adversary make the same selection take the same bad pivots
+            array_nth_element(indices, data->k, &test_adversary_comparator);
+            array_append(sorted, values);
+            array_sort(sorted, &test_u32_comparator);
+
+            test_adversary.nb_comparisons = 0u;
+            array_nth_element(values, data->k, &test_counting_comparator);
+            tst_assert_equal(sorted[data->k], values[data->k], "nth element of %d");
+
+            // without the heap selection fallback, the partitions would cost about length² / 4 comparisons
+            for (size_t length = data->length ; length > 1u ; length >>= 1u) {
+                log2_length += 1u;
+            }
+            tst_assert(test_adversary.nb_comparisons <= (8u * data->length * log2_length),
+                    "%ld comparisons for %ld elements", test_adversary.nb_comparisons, data->length);
+
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &indices);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &values);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &sorted);
+        }
+)
+
+tst_CREATE_TEST_CASE(array_selection_killer_middle, array_selection_killer,
+        .length = 4000,
+        .k = 1500,
+)
+tst_CREATE_TEST_CASE(array_selection_killer_last, array_selection_killer,
+        .length = 4000,
+        .k = 3999,
+)
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_dedup,
+        {
+            struct { size_t length; size_t capacity; u32 stride; u32 data[16]; } array;
+
+            size_t expected_nb_runs;
+            struct { size_t length; size_t capacity; u32 stride; u32 data[16]; } expected;
+        },
+        {
+            size_t cursor = 0u;
+            size_t begin = 0u;
+            size_t end = 0u;
+            size_t nb_runs = 0u;
+            size_t nb_seen = 0u;
+
+            while (array_group_runs(data->array.data, &test_u32_comparator, &cursor, &begin, &end)) {
+                tst_assert_equal_ext(nb_seen, begin, "%ld", "start of run %ld", nb_runs);
+                tst_assert_equal_ext(data->expected.data[nb_runs], data->array.data[begin], "%d", "value of run %ld", nb_runs);
+                nb_seen = end;
+                nb_runs += 1u;
+            }
+            tst_assert_equal(data->expected_nb_runs, nb_runs, "%ld runs");
+            tst_assert_equal(data->array.length, nb_seen, "%ld elements in runs");
+
+            tst_assert_equal(data->expected.length, array_unique(data->array.data, &test_u32_comparator), "unique length of %ld");
+            tst_assert_equal(data->expected.length, data->array.length, "array length of %ld");
+            for (size_t i = 0u ; i < data->expected.length ; i++) {
+                tst_assert_equal_ext(data->expected.data[i], data->array.data[i], "%d", "at index %ld", i);
+            }
+        }
+)
+
+tst_CREATE_TEST_CASE(array_dedup_nominal, array_dedup,
+        .array            = { 12, 16, 4, { 1u, 1u, 2u, 3u, 3u, 3u, 7u, 8u, 8u, 9u, 9u, 9u } },
+        .expected_nb_runs = 6,
+        .expected         = { 6, 16, 4, { 1u, 2u, 3u, 7u, 8u, 9u } },
+)
+tst_CREATE_TEST_CASE(array_dedup_distinct, array_dedup,
+        .array            = { 4, 16, 4, { 1u, 2u, 3u, 4u } },
+        .expected_nb_runs = 4,
+        .expected         = { 4, 16, 4, { 1u, 2u, 3u, 4u } },
+)
+tst_CREATE_TEST_CASE(array_dedup_all_equal, array_dedup,
+        .array            = { 5, 16, 4, { 6u, 6u, 6u, 6u, 6u } },
+        .expected_nb_runs = 1,
+        .expected         = { 1, 16, 4, { 6u } },
+)
+tst_CREATE_TEST_CASE(array_dedup_empty, array_dedup,
+        .array            = { 0, 16, 4, { 0 } },
+        .expected_nb_runs = 0,
+        .expected         = { 0, 16, 4, { 0 } },
+)
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
 
 void array_sort_execute_unittests(void)
 {
@@ -551,6 +1017,19 @@ void array_sort_execute_unittests(void)
     tst_run_test_case(array_sorted_insert_at_end);
     tst_run_test_case(array_sorted_u32_insert_other);
     tst_run_test_case(array_sorted_u32_insert_in_empty);
+
+    tst_run_test_case(array_selection_median);
+    tst_run_test_case(array_selection_duplicates);
+    tst_run_test_case(array_selection_first);
+    tst_run_test_case(array_selection_beyond);
+
+    tst_run_test_case(array_selection_killer_middle);
+    tst_run_test_case(array_selection_killer_last);
+
+    tst_run_test_case(array_dedup_nominal);
+    tst_run_test_case(array_dedup_distinct);
+    tst_run_test_case(array_dedup_all_equal);
+    tst_run_test_case(array_dedup_empty);
 }
 
 #endif
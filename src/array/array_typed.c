@@ -0,0 +1,310 @@
+
+#include <ustd/array_typed.h>
+
+#ifdef UNITTESTING
+
+#include <ustd/testutilities.h>
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+static i32 test_u32_comparator(const void *v1, const void *v2) {
+    u32 val1 = *((u32 *) v1);
+    u32 val2 = *((u32 *) v2);
+
+    return (val1 > val2) - (val1 < val2);
+}
+
+ARRAY_DEFINE_NAMED(test_u32, u32, test_u32_comparator)
+
+/* Compares a decade (the needle) with an element : the arguments are not interchangeable. */
+static i32 test_decade_comparator(const void *needle, const void *element) {
+    u32 decade = *((u32 *) needle);
+    u32 val = *((u32 *) element) / 10u;
+
+    return (decade > val) - (decade < val);
+}
+
+ARRAY_DEFINE_NAMED(test_decade, u32, test_decade_comparator)
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_typed_sort,
+        {
+            struct { size_t length; size_t capacity; u32 stride; u32 data[10]; } input;
+            u32 expected[10];
+        },
+        {
+            array_test_u32_sort(data->input.data);
+
+            for (size_t i = 0 ; i < data->input.length ; i++) {
+                tst_assert_equal_ext(data->expected[i], data->input.data[i], "%d", "at index %ld", i);
+            }
+            tst_assert(array_is_sorted(data->input.data, &test_u32_comparator), "array was not sorted");
+        }
+)
+
+tst_CREATE_TEST_CASE(array_typed_sort_nominal, array_typed_sort,
+        .input = { 10, 10, 4, { 5, 2, 8, 1, 9, 3, 7, 6, 4, 0 } },
+        .expected = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 },
+)
+tst_CREATE_TEST_CASE(array_typed_sort_duplicates, array_typed_sort,
+        .input = { 7, 10, 4, { 3, 1, 3, 1, 2, 2, 3 } },
+        .expected = { 1, 1, 2, 2, 3, 3, 3 },
+)
+tst_CREATE_TEST_CASE(array_typed_sort_one, array_typed_sort,
+        .input = { 1, 10, 4, { 42 } },
+        .expected = { 42 },
+)
+
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_typed_sorted_find,
+        {
+            struct { size_t length; size_t capacity; u32 stride; u32 data[10]; } haystack;
+            u32 needle;
+
+            bool expect_found;
+            size_t expected_position;
+        },
+        {
+            size_t typed_pos = 0;
+            size_t generic_pos = 0;
+            bool typed_found = array_test_u32_sorted_find(data->haystack.data, data->needle, &typed_pos);
+            bool generic_found = array_sorted_find(data->haystack.data, &test_u32_comparator, &data->needle, &generic_pos);
+
+            tst_assert_equal(data->expect_found, typed_found, "found status of %d");
+            tst_assert_equal(data->expected_position, typed_pos, "position %ld");
+            tst_assert_equal(generic_found, typed_found, "generic found status of %d");
+            tst_assert_equal(generic_pos, typed_pos, "generic position %ld");
+        }
+)
+
+tst_CREATE_TEST_CASE(array_typed_sorted_find_nominal, array_typed_sorted_find,
+        .haystack = { 6, 10, 4, { 1, 3, 5, 7, 9, 11 } },
+        .needle = 7,
+        .expect_found = true,
+        .expected_position = 3,
+)
+tst_CREATE_TEST_CASE(array_typed_sorted_find_first_occ, array_typed_sorted_find,
+        .haystack = { 6, 10, 4, { 1, 3, 3, 3, 9, 11 } },
+        .needle = 3,
+        .expect_found = true,
+        .expected_position = 1,
+)
+tst_CREATE_TEST_CASE(array_typed_sorted_find_missing, array_typed_sorted_find,
+        .haystack = { 6, 10, 4, { 1, 3, 5, 7, 9, 11 } },
+        .needle = 8,
+        .expect_found = false,
+        .expected_position = 4,
+)
+tst_CREATE_TEST_CASE(array_typed_sorted_find_after, array_typed_sorted_find,
+        .haystack = { 6, 10, 4, { 1, 3, 5, 7, 9, 11 } },
+        .needle = 12,
+        .expect_found = false,
+        .expected_position = 6,
+)
+tst_CREATE_TEST_CASE(array_typed_sorted_find_empty, array_typed_sorted_find,
+        .haystack = { 0, 10, 4, { 0 } },
+        .needle = 12,
+        .expect_found = false,
+        .expected_position = 0,
+)
+
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_typed_sorted_find_asymmetric,
+        {
+            struct { size_t length; size_t capacity; u32 stride; u32 data[10]; } haystack;
+            u32 decade;
+
+            bool expect_found;
+            size_t expected_position;
+        },
+        {
+            size_t typed_pos = 0;
+            size_t generic_pos = 0;
+            bool typed_found = array_test_decade_sorted_find(data->haystack.data, data->decade, &typed_pos);
+            bool generic_found = array_sorted_find(data->haystack.data, &test_decade_comparator, &data->decade, &generic_pos);
+
+            tst_assert_equal(data->expect_found, typed_found, "found status of %d");
+            tst_assert_equal(data->expected_position, typed_pos, "position %ld");
+            tst_assert_equal(generic_found, typed_found, "generic found status of %d");
+            tst_assert_equal(generic_pos, typed_pos, "generic position %ld");
+        }
+)
+
+tst_CREATE_TEST_CASE(array_typed_sorted_find_asymmetric_nominal, array_typed_sorted_find_asymmetric,
+        .haystack = { 6, 10, 4, { 4, 12, 25, 31, 38, 57 } },
+        .decade = 3,
+        .expect_found = true,
+        .expected_position = 3,
+)
+tst_CREATE_TEST_CASE(array_typed_sorted_find_asymmetric_missing, array_typed_sorted_find_asymmetric,
+        .haystack = { 6, 10, 4, { 4, 12, 25, 31, 38, 57 } },
+        .decade = 4,
+        .expect_found = false,
+        .expected_position = 5,
+)
+
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_typed_interop,
+        {
+            size_t capacity;
+            u32 *pushed;
+            size_t nb_pushed;
+
+            u32 inserted;
+            size_t insert_at;
+        },
+        {
+            ARRAY(u32) array = array_create(make_system_allocator(), sizeof(*array), data->capacity);
+            size_t pos = 0;
+
+            for (size_t i = 0 ; i < data->nb_pushed ; i++) {
+                if (i % 2) {
+                    array_test_u32_push(array, data->pushed[i]);
+                } else {
+                    array_push(array, data->pushed + i);
+                }
+            }
+            tst_assert_equal(data->nb_pushed, array_length(array), "length of %ld");
+
+            tst_assert(array_test_u32_insert(array, data->insert_at, data->inserted), "insertion failed");
+            tst_assert_equal(data->inserted, array[data->insert_at], "inserted value %d");
+            tst_assert(array_find(array, &test_u32_comparator, &data->inserted, &pos), "generic find failed");
+            tst_assert_equal(data->insert_at, pos, "generic position %ld");
+            tst_assert(array_test_u32_find(array, data->inserted, &pos), "typed find failed");
+            tst_assert_equal(data->insert_at, pos, "typed position %ld");
+
+            while (array_test_u32_push(array, 0)) { }
+            tst_assert_equal(data->capacity, array_length(array), "length of %ld");
+            tst_assert(!array_test_u32_insert(array, 0, 0), "insertion in full array succeeded");
+
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &array);
+        }
+)
+
+tst_CREATE_TEST_CASE(array_typed_interop_nominal, array_typed_interop,
+        .capacity = 10,
+        .pushed = (u32[]) { 10, 20, 30, 40, 50 },
+        .nb_pushed = 5,
+        .inserted = 42,
+        .insert_at = 2,
+)
+tst_CREATE_TEST_CASE(array_typed_interop_at_end, array_typed_interop,
+        .capacity = 6,
+        .pushed = (u32[]) { 10, 20, 30, 40, 50 },
+        .nb_pushed = 5,
+        .inserted = 42,
+        .insert_at = 5,
+)
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+void array_typed_execute_unittests(void)
+{
+    tst_run_test_case(array_typed_sort_nominal);
+    tst_run_test_case(array_typed_sort_duplicates);
+    tst_run_test_case(array_typed_sort_one);
+
+    tst_run_test_case(array_typed_sorted_find_nominal);
+    tst_run_test_case(array_typed_sorted_find_first_occ);
+    tst_run_test_case(array_typed_sorted_find_missing);
+    tst_run_test_case(array_typed_sorted_find_after);
+    tst_run_test_case(array_typed_sorted_find_empty);
+
+    tst_run_test_case(array_typed_sorted_find_asymmetric_nominal);
+    tst_run_test_case(array_typed_sorted_find_asymmetric_missing);
+
+    tst_run_test_case(array_typed_interop_nominal);
+    tst_run_test_case(array_typed_interop_at_end);
+}
+
+#endif
+
+#ifdef BENCHMARK
+
+#include <stdio.h>
+#include <time.h>
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+#define BENCHMARK_NB_ELEMENTS (200000u)
+
+static i32 benchmark_u32_comparator(const void *v1, const void *v2) {
+    u32 val1 = *((u32 *) v1);
+    u32 val2 = *((u32 *) v2);
+
+    return (val1 > val2) - (val1 < val2);
+}
+
+ARRAY_DEFINE_NAMED(benchmark_u32, u32, benchmark_u32_comparator)
+
+static f64 benchmark_seconds_since(clock_t start)
+{
+    return (f64) (clock() - start) / (f64) CLOCKS_PER_SEC;
+}
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+void array_typed_execute_benchmarks(void)
+{
+    ARRAY(u32) generic = array_create(make_system_allocator(), sizeof(*generic), BENCHMARK_NB_ELEMENTS);
+    ARRAY(u32) typed = array_create(make_system_allocator(), sizeof(*typed), BENCHMARK_NB_ELEMENTS);
+    u32 state = 0x12345678u;
+    size_t hits = 0;
+    clock_t start = 0;
+
+    if (!generic || !typed) {
+        array_destroy(make_system_allocator(), (ARRAY_ANY *) &generic);
+        array_destroy(make_system_allocator(), (ARRAY_ANY *) &typed);
+        return;
+    }
+
+    start = clock();
+    for (u32 i = 0 ; i < BENCHMARK_NB_ELEMENTS ; i++) {
+        state = (state * 1664525u) + 1013904223u;
+        array_push(generic, &state);
+    }
+    printf("[BENCHMARK] generic push        : %f s\n", benchmark_seconds_since(start));
+
+    state = 0x12345678u;
+    start = clock();
+    for (u32 i = 0 ; i < BENCHMARK_NB_ELEMENTS ; i++) {
+        state = (state * 1664525u) + 1013904223u;
+        array_benchmark_u32_push(typed, state);
+    }
+    printf("[BENCHMARK] typed push          : %f s\n", benchmark_seconds_since(start));
+
+    start = clock();
+    array_sort(generic, &benchmark_u32_comparator);
+    printf("[BENCHMARK] generic sort        : %f s\n", benchmark_seconds_since(start));
+
+    start = clock();
+    array_benchmark_u32_sort(typed);
+    printf("[BENCHMARK] typed sort          : %f s\n", benchmark_seconds_since(start));
+
+    start = clock();
+    for (u32 i = 0 ; i < BENCHMARK_NB_ELEMENTS ; i++) {
+        hits += array_sorted_find(generic, &benchmark_u32_comparator, typed + i, nullptr);
+    }
+    printf("[BENCHMARK] generic sorted find : %f s (%ld hits)\n", benchmark_seconds_since(start), hits);
+
+    hits = 0;
+    start = clock();
+    for (u32 i = 0 ; i < BENCHMARK_NB_ELEMENTS ; i++) {
+        hits += array_benchmark_u32_sorted_find(typed, generic[i], nullptr);
+    }
+    printf("[BENCHMARK] typed sorted find   : %f s (%ld hits)\n", benchmark_seconds_since(start), hits);
+
+    array_destroy(make_system_allocator(), (ARRAY_ANY *) &generic);
+    array_destroy(make_system_allocator(), (ARRAY_ANY *) &typed);
+}
+
+#endif
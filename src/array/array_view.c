@@ -0,0 +1,372 @@
+#include <ustd/array_view.h>
+#include <ustd_impl/array_impl.h>
+
+// -------------------------------------------------------------------------------------------------
+
+ARRAY_VIEW array_view_of(const ARRAY_ANY array)
+{
+    struct array_impl *target = nullptr;
+
+    if (!array) {
+        return (ARRAY_VIEW) { 0 };
+    }
+
+    target = array_impl_of((ARRAY_ANY) array);
+
+    return (ARRAY_VIEW) { .data = target->data, .length = target->length, .stride = target->stride };
+}
+
+// -------------------------------------------------------------------------------------------------
+
+ARRAY_VIEW array_view_from_mem(const void *memory, size_t nb_elements, u32 size_element)
+{
+    if (!memory) {
+        return (ARRAY_VIEW) { .stride = size_element };
+    }
+
+    return (ARRAY_VIEW) { .data = memory, .length = nb_elements, .stride = size_element };
+}
+
+// -------------------------------------------------------------------------------------------------
+
+ARRAY_VIEW array_view_slice(ARRAY_VIEW view, size_t start_index, size_t end_index)
+{
+    end_index = MIN(end_index, view.length);
+    start_index = MIN(start_index, end_index);
+
+    return (ARRAY_VIEW) {
+            .data = view.data + (start_index * view.stride),
+            .length = end_index - start_index,
+            .stride = view.stride
+    };
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void array_view_split(ARRAY_VIEW view, size_t index, ARRAY_VIEW *out_left, ARRAY_VIEW *out_right)
+{
+    if (out_left) {
+        *out_left = array_view_slice(view, 0, index);
+    }
+
+    if (out_right) {
+        *out_right = array_view_slice(view, index, view.length);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_view_next_chunk(ARRAY_VIEW *remaining, size_t chunk_length, ARRAY_VIEW *out_chunk)
+{
+    ARRAY_VIEW chunk = { 0 };
+
+    if (!remaining || !out_chunk || (remaining->length == 0) || (chunk_length == 0)) {
+        return false;
+    }
+
+    array_view_split(*remaining, chunk_length, &chunk, remaining);
+    *out_chunk = chunk;
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+const void *array_view_at(ARRAY_VIEW view, size_t index)
+{
+    if (index >= view.length) {
+        return nullptr;
+    }
+
+    return view.data + (index * view.stride);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_view_get(ARRAY_VIEW view, size_t index, void *out_value)
+{
+    if (index >= view.length) {
+        return false;
+    }
+
+    if (out_value) {
+        bytewise_copy(out_value, view.data + (index * view.stride), view.stride);
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_view_find(ARRAY_VIEW haystack, comparator_f comparator, const void *needle, size_t *out_position)
+{
+    size_t idx = 0;
+    bool found = false;
+
+    while ((idx < haystack.length) && !found) {
+        found = (comparator(haystack.data + (idx * haystack.stride), needle) == 0);
+        idx += !found;
+    }
+
+    if (found && out_position) {
+        *out_position = idx;
+    }
+
+    return found;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_view_find_back(ARRAY_VIEW haystack, comparator_f comparator, const void *needle, size_t *out_position)
+{
+    size_t idx = haystack.length;
+    bool found = false;
+
+    while ((idx > 0) && !found) {
+        found = (comparator(haystack.data + ((idx - 1) * haystack.stride), needle) == 0);
+        idx -= !found;
+    }
+
+    if (found && out_position) {
+        *out_position = idx - 1;
+    }
+
+    return found;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_view_is_sorted(ARRAY_VIEW view, comparator_f comparator)
+{
+    size_t pos = { 0u };
+
+    if (view.length == 0u) {
+        return true;
+    }
+
+    pos = 1u;
+    while ((pos < view.length) && (comparator((void *) (view.data + (pos * view.stride)), (void *) (view.data + ((pos - 1) * view.stride))) != -1)) {
+        pos += 1u;
+    }
+
+    return (pos == view.length);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool array_view_sorted_find(ARRAY_VIEW haystack, comparator_f comparator, const void *needle, size_t *out_position)
+{
+    i32 beginning = 0u;
+    i32 end = 0u;
+    i32 index = 0u;
+    i32 comp_result = 2;
+
+    beginning = 0u;
+    end = (i32) haystack.length - 1;
+
+    while ((beginning <= end) && (comp_result != 0)) {
+        index = (i32) CEIL_DIV(beginning + end, 2);
+
+        comp_result = comparator(needle, (void *) (haystack.data + ((size_t) index * haystack.stride)));
+
+        if (comp_result == 1) {
+            beginning = index + 1;
+        }
+        else if (comp_result == -1) {
+            end = index - 1;
+        }
+    }
+
+    while ((index > 0) && (comparator(needle, (void *) (haystack.data + ((size_t) (index - 1) * haystack.stride))) == 0)) {
+        index -= 1;
+        comp_result = comparator(needle, (void *) (haystack.data + ((size_t) index * haystack.stride)));
+    }
+
+    if (out_position != NULL) {
+        if ((comp_result == 0) || (comp_result == -1) || (haystack.length == 0u)) {
+            *out_position = (size_t) index;
+        }
+        else {
+            *out_position = (size_t) (index + comp_result);
+        }
+    }
+
+    return (comp_result == 0);
+}
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+#include <ustd/testutilities.h>
+
+static i32 test_u32_comparator(const void *v1, const void *v2) {
+    u32 val1 = *((u32 *) v1);
+    u32 val2 = *((u32 *) v2);
+
+    return (val1 > val2) - (val1 < val2);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_view_slicing,
+        {
+            struct { size_t length; size_t capacity; u32 stride; u32 data[10]; } array;
+            size_t start;
+            size_t end;
+
+            size_t expected_length;
+            u32 expected_first;
+        },
+        {
+            ARRAY_VIEW whole = array_view_of(data->array.data);
+            ARRAY_VIEW slice = array_view_slice(whole, data->start, data->end);
+            ARRAY_VIEW left = { 0 };
+            ARRAY_VIEW right = { 0 };
+            u32 value = 0;
+
+            tst_assert_equal(data->array.length, whole.length, "whole length of %ld");
+            tst_assert_equal(data->expected_length, slice.length, "slice length of %ld");
+            if (data->expected_length > 0) {
+                tst_assert(array_view_get(slice, 0, &value), "get failed");
+                tst_assert_equal(data->expected_first, value, "first value of %d");
+            }
+            tst_assert(!array_view_get(slice, data->expected_length, &value), "out of bounds get succeeded");
+
+            array_view_split(whole, data->start, &left, &right);
+            tst_assert_equal(whole.length, left.length + right.length, "split length of %ld");
+            tst_assert(right.data == left.data + (left.length * left.stride), "split parts are not adjacent");
+        }
+)
+
+tst_CREATE_TEST_CASE(array_view_slicing_nominal, array_view_slicing,
+        .array = { 8, 10, 4, { 1, 2, 3, 4, 5, 6, 7, 8 } },
+        .start = 2,
+        .end = 5,
+        .expected_length = 3,
+        .expected_first = 3,
+)
+tst_CREATE_TEST_CASE(array_view_slicing_beyond, array_view_slicing,
+        .array = { 8, 10, 4, { 1, 2, 3, 4, 5, 6, 7, 8 } },
+        .start = 6,
+        .end = 50,
+        .expected_length = 2,
+        .expected_first = 7,
+)
+tst_CREATE_TEST_CASE(array_view_slicing_inverted, array_view_slicing,
+        .array = { 8, 10, 4, { 1, 2, 3, 4, 5, 6, 7, 8 } },
+        .start = 5,
+        .end = 2,
+        .expected_length = 0,
+)
+
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_view_chunks,
+        {
+            size_t nb_elements;
+            size_t chunk_length;
+            size_t expected_nb_chunks;
+        },
+        {
+            u32 mem[64] = { 0 };
+            ARRAY_VIEW remaining = array_view_from_mem(mem, data->nb_elements, sizeof(*mem));
+            ARRAY_VIEW chunk = { 0 };
+            size_t nb_chunks = 0;
+            size_t nb_seen = 0;
+
+            for (u32 i = 0 ; i < 64 ; i++) {
+                mem[i] = i;
+            }
+
+            while (array_view_next_chunk(&remaining, data->chunk_length, &chunk)) {
+                tst_assert(chunk.length <= data->chunk_length, "chunk of %ld elements", chunk.length);
+                tst_assert_equal((u32) nb_seen, *(const u32 *) array_view_at(chunk, 0), "chunk start of %d");
+                nb_seen += chunk.length;
+                nb_chunks += 1;
+            }
+
+            tst_assert_equal(data->expected_nb_chunks, nb_chunks, "%ld chunks");
+            tst_assert_equal(data->nb_elements, nb_seen, "%ld elements seen");
+        }
+)
+
+tst_CREATE_TEST_CASE(array_view_chunks_exact, array_view_chunks,
+        .nb_elements = 64,
+        .chunk_length = 16,
+        .expected_nb_chunks = 4,
+)
+tst_CREATE_TEST_CASE(array_view_chunks_remainder, array_view_chunks,
+        .nb_elements = 50,
+        .chunk_length = 16,
+        .expected_nb_chunks = 4,
+)
+tst_CREATE_TEST_CASE(array_view_chunks_empty, array_view_chunks,
+        .nb_elements = 0,
+        .chunk_length = 16,
+        .expected_nb_chunks = 0,
+)
+
+// -------------------------------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(array_view_sorted_find_in_slice,
+        {
+            struct { size_t length; size_t capacity; u32 stride; u32 data[10]; } array;
+            size_t start;
+            size_t end;
+            u32 needle;
+
+            bool expect_found;
+            size_t expected_position;
+        },
+        {
+            ARRAY_VIEW slice = array_view_slice(array_view_of(data->array.data), data->start, data->end);
+            size_t pos = 0;
+
+            tst_assert(array_view_is_sorted(slice, &test_u32_comparator), "slice is not sorted");
+            tst_assert_equal(data->expect_found, array_view_sorted_find(slice, &test_u32_comparator, &data->needle, &pos), "found status of %d");
+            tst_assert_equal(data->expected_position, pos, "position of %ld");
+            if (data->expect_found) {
+                tst_assert(array_view_find(slice, &test_u32_comparator, &data->needle, &pos), "linear find failed");
+                tst_assert_equal(data->expected_position, pos, "linear position of %ld");
+            }
+        }
+)
+
+tst_CREATE_TEST_CASE(array_view_sorted_find_in_slice_nominal, array_view_sorted_find_in_slice,
+        .array = { 10, 10, 4, { 9, 8, 1, 3, 5, 7, 9, 2, 1, 0 } },
+        .start = 2,
+        .end = 7,
+        .needle = 7,
+        .expect_found = true,
+        .expected_position = 3,
+)
+tst_CREATE_TEST_CASE(array_view_sorted_find_in_slice_outside, array_view_sorted_find_in_slice,
+        .array = { 10, 10, 4, { 9, 8, 1, 3, 5, 7, 9, 2, 1, 0 } },
+        .start = 2,
+        .end = 6,
+        .needle = 9,
+        .expect_found = false,
+        .expected_position = 4,
+)
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+
+void array_view_execute_unittests(void)
+{
+    tst_run_test_case(array_view_slicing_nominal);
+    tst_run_test_case(array_view_slicing_beyond);
+    tst_run_test_case(array_view_slicing_inverted);
+
+    tst_run_test_case(array_view_chunks_exact);
+    tst_run_test_case(array_view_chunks_remainder);
+    tst_run_test_case(array_view_chunks_empty);
+
+    tst_run_test_case(array_view_sorted_find_in_slice_nominal);
+    tst_run_test_case(array_view_sorted_find_in_slice_outside);
+}
+
+#endif
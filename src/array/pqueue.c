@@ -0,0 +1,376 @@
+
+#include <ustd/pqueue.h>
+#include <ustd_impl/array_impl.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Priority queue header. The fields after `arity` mirror the header of an array.
+ */
+struct pqueue_impl {
+    comparator_f comparator;
+    u32 arity;
+
+    size_t length;
+    size_t capacity;
+    u32 stride;
+    byte data[];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief
+ *
+ * @param pqueue
+ * @return struct pqueue_impl*
+ */
+static struct pqueue_impl *pqueue_impl_of(PQUEUE_ANY pqueue);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+PQUEUE_ANY pqueue_create(allocator alloc, u32 size_element, size_t nb_elements_max, comparator_f comparator, u32 arity)
+{
+    struct pqueue_impl *new_pqueue = nullptr;
+
+    if ((size_element == 0) || (nb_elements_max == 0) || !comparator || (arity < 2u)) {
+        return nullptr;
+    }
+
+    new_pqueue = alloc.malloc(alloc, sizeof(*new_pqueue) + (size_element * nb_elements_max));
+
+    if (!new_pqueue) {
+        return nullptr;
+    }
+
+    *new_pqueue = (struct pqueue_impl) {
+            .comparator = comparator,
+            .arity = arity,
+
+            .length = 0,
+            .capacity = nb_elements_max,
+            .stride = size_element,
+    };
+
+    return &(new_pqueue->data);
+}
+
+// -----------------------------------------------------------------------------
+
+PQUEUE_ANY pqueue_create_from_array(allocator alloc, const ARRAY_ANY array, comparator_f comparator, u32 arity)
+{
+    struct array_impl *source = nullptr;
+    PQUEUE_ANY new_pqueue = nullptr;
+
+    if (!array) {
+        return nullptr;
+    }
+
+    source = array_impl_of((ARRAY_ANY) array);
+    new_pqueue = pqueue_create(alloc, source->stride, MAX(source->length, 1u), comparator, arity);
+
+    if (!new_pqueue) {
+        return nullptr;
+    }
+
+    bytewise_copy(new_pqueue, source->data, source->length * source->stride);
+    pqueue_impl_of(new_pqueue)->length = source->length;
+
+    array_heap_build(new_pqueue, arity, comparator);
+
+    return new_pqueue;
+}
+
+// -----------------------------------------------------------------------------
+
+void pqueue_destroy(allocator alloc, PQUEUE_ANY *pqueue)
+{
+    if (!pqueue || !*pqueue) {
+        return;
+    }
+
+    alloc.free(alloc, pqueue_impl_of(*pqueue));
+    *pqueue = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void pqueue_ensure_capacity(allocator alloc, PQUEUE_ANY *pqueue, size_t additional_capacity)
+{
+    struct pqueue_impl *target = nullptr;
+    size_t needed_size = 0;
+
+    PQUEUE_ANY new_pqueue = nullptr;
+
+    if (!pqueue || !*pqueue || (additional_capacity == 0)) {
+        return;
+    }
+
+    target = pqueue_impl_of(*pqueue);
+    needed_size = target->length + additional_capacity;
+
+    if (needed_size <= target->capacity) {
+        return;
+    }
+
+    new_pqueue = pqueue_create(alloc, target->stride, needed_size * 2u, target->comparator, target->arity);
+    if (!new_pqueue) {
+        return;
+    }
+
+    bytewise_copy(new_pqueue, target->data, target->length * target->stride);
+    pqueue_impl_of(new_pqueue)->length = target->length;
+
+    pqueue_destroy(alloc, pqueue);
+    *pqueue = new_pqueue;
+}
+
+// -----------------------------------------------------------------------------
+
+bool pqueue_push(PQUEUE_ANY pqueue, const void *value)
+{
+    struct pqueue_impl *target = nullptr;
+
+    if (!pqueue || !value) {
+        return false;
+    }
+
+    target = pqueue_impl_of(pqueue);
+
+    if (!array_push(pqueue, value)) {
+        return false;
+    }
+
+    array_heap_sift_up(pqueue, target->length - 1, target->arity, target->comparator);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool pqueue_pop(PQUEUE_ANY pqueue, void *out_value)
+{
+    struct pqueue_impl *target = nullptr;
+
+    if (!pqueue_peek(pqueue, out_value)) {
+        return false;
+    }
+
+    target = pqueue_impl_of(pqueue);
+
+    array_remove_swapback(pqueue, 0);
+    array_heap_sift_down(pqueue, target->length, 0, target->arity, target->comparator);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool pqueue_peek(PQUEUE_ANY pqueue, void *out_value)
+{
+    if (!pqueue) {
+        return false;
+    }
+
+    return array_get(pqueue, 0, out_value);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t pqueue_update_key(PQUEUE_ANY pqueue, size_t index, const void *value)
+{
+    struct pqueue_impl *target = nullptr;
+    i32 direction = 0;
+
+    if (!pqueue) {
+        return 0;
+    }
+
+    target = pqueue_impl_of(pqueue);
+
+    if ((index >= target->length) || !value) {
+        return target->length;
+    }
+
+    direction = target->comparator(value, target->data + (index * target->stride));
+    bytewise_copy(target->data + (index * target->stride), value, target->stride);
+
+    if (direction == 1) {
+        index = array_heap_sift_up(pqueue, index, target->arity, target->comparator);
+    } else if (direction == -1) {
+        index = array_heap_sift_down(pqueue, target->length, index, target->arity, target->comparator);
+    }
+
+    return index;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static struct pqueue_impl *pqueue_impl_of(PQUEUE_ANY pqueue)
+{
+    return CONTAINER_OF(pqueue, struct pqueue_impl, data);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+static i32 test_i32_comparator(const void *v1, const void *v2) {
+    i32 val1 = *((i32 *) v1);
+    i32 val2 = *((i32 *) v2);
+
+    return (val1 > val2) - (val1 < val2);
+}
+
+static i32 test_i32_comparator_reversed(const void *v1, const void *v2) {
+    return test_i32_comparator(v2, v1);
+}
+
+tst_CREATE_TEST_SCENARIO(pqueue_drain,
+        {
+            i32 *pushed;
+            size_t nb_pushed;
+            comparator_f comparator;
+            u32 arity;
+            bool from_array;
+
+            i32 *expected;
+        },
+        {
+            PQUEUE(i32) pqueue = nullptr;
+            ARRAY(i32) array = nullptr;
+            i32 value = 0;
+
+            if (data->from_array) {
+                array = array_create(make_system_allocator(), sizeof(*array), data->nb_pushed);
+                array_append_mem(array, data->pushed, data->nb_pushed);
+                pqueue = pqueue_create_from_array(make_system_allocator(), array, data->comparator, data->arity);
+                array_destroy(make_system_allocator(), (ARRAY_ANY *) &array);
+            } else {
+                pqueue = pqueue_create(make_system_allocator(), sizeof(*pqueue), 1, data->comparator, data->arity);
+                for (size_t i = 0 ; i < data->nb_pushed ; i++) {
+                    pqueue_ensure_capacity(make_system_allocator(), (PQUEUE_ANY *) &pqueue, 1);
+                    tst_assert(pqueue_push(pqueue, data->pushed + i), "push %ld failed", i);
+                }
+            }
+
+            tst_assert_equal(data->nb_pushed, pqueue_length(pqueue), "length of %ld");
+
+            for (size_t i = 0 ; i < data->nb_pushed ; i++) {
+                tst_assert(pqueue_peek(pqueue, &value), "peek %ld failed", i);
+                tst_assert_equal_ext(data->expected[i], value, "%d", "peeked at step %ld", i);
+                tst_assert(pqueue_pop(pqueue, &value), "pop %ld failed", i);
+                tst_assert_equal_ext(data->expected[i], value, "%d", "popped at step %ld", i);
+            }
+
+            tst_assert(!pqueue_pop(pqueue, &value), "pop on empty queue succeeded");
+
+            pqueue_destroy(make_system_allocator(), (PQUEUE_ANY *) &pqueue);
+        }
+)
+
+tst_CREATE_TEST_CASE(pqueue_drain_binary, pqueue_drain,
+        .pushed = (i32[]) { 5, 1, 9, 3, 7, 2, 8, 6, 4, 0 },
+        .nb_pushed = 10,
+        .comparator = &test_i32_comparator,
+        .arity = PQUEUE_BINARY,
+        .expected = (i32[]) { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+)
+tst_CREATE_TEST_CASE(pqueue_drain_quaternary, pqueue_drain,
+        .pushed = (i32[]) { 5, 1, 9, 3, 7, 2, 8, 6, 4, 0, 5, 5 },
+        .nb_pushed = 12,
+        .comparator = &test_i32_comparator,
+        .arity = PQUEUE_QUATERNARY,
+        .expected = (i32[]) { 9, 8, 7, 6, 5, 5, 5, 4, 3, 2, 1, 0 },
+)
+tst_CREATE_TEST_CASE(pqueue_drain_min_queue, pqueue_drain,
+        .pushed = (i32[]) { 5, 1, 9, 3, 7 },
+        .nb_pushed = 5,
+        .comparator = &test_i32_comparator_reversed,
+        .arity = PQUEUE_BINARY,
+        .expected = (i32[]) { 1, 3, 5, 7, 9 },
+)
+tst_CREATE_TEST_CASE(pqueue_drain_heapified, pqueue_drain,
+        .pushed = (i32[]) { 5, 1, 9, 3, 7, 2, 8, 6, 4, 0 },
+        .nb_pushed = 10,
+        .comparator = &test_i32_comparator,
+        .arity = PQUEUE_QUATERNARY,
+        .from_array = true,
+        .expected = (i32[]) { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(pqueue_update,
+        {
+            i32 *pushed;
+            size_t nb_pushed;
+            u32 arity;
+
+            i32 old_key;
+            i32 new_key;
+
+            i32 *expected;
+        },
+        {
+            PQUEUE(i32) pqueue = pqueue_create(make_system_allocator(), sizeof(*pqueue), data->nb_pushed, &test_i32_comparator, data->arity);
+            size_t index = 0;
+            i32 value = 0;
+
+            for (size_t i = 0 ; i < data->nb_pushed ; i++) {
+                pqueue_push(pqueue, data->pushed + i);
+            }
+
+            tst_assert(array_find(pqueue, &test_i32_comparator, &data->old_key, &index), "key %d not found", data->old_key);
+            index = pqueue_update_key(pqueue, index, &data->new_key);
+            tst_assert_equal(data->new_key, pqueue[index], "key of %d");
+
+            for (size_t i = 0 ; i < data->nb_pushed ; i++) {
+                pqueue_pop(pqueue, &value);
+                tst_assert_equal_ext(data->expected[i], value, "%d", "popped at step %ld", i);
+            }
+
+            pqueue_destroy(make_system_allocator(), (PQUEUE_ANY *) &pqueue);
+        }
+)
+
+tst_CREATE_TEST_CASE(pqueue_update_decrease, pqueue_update,
+        .pushed = (i32[]) { 5, 1, 9, 3, 7, 2 },
+        .nb_pushed = 6,
+        .arity = PQUEUE_BINARY,
+        .old_key = 9,
+        .new_key = 0,
+        .expected = (i32[]) { 7, 5, 3, 2, 1, 0 },
+)
+tst_CREATE_TEST_CASE(pqueue_update_increase, pqueue_update,
+        .pushed = (i32[]) { 5, 1, 9, 3, 7, 2 },
+        .nb_pushed = 6,
+        .arity = PQUEUE_QUATERNARY,
+        .old_key = 1,
+        .new_key = 10,
+        .expected = (i32[]) { 10, 9, 7, 5, 3, 2 },
+)
+
+// -----------------------------------------------------------------------------
+
+void pqueue_execute_unittests(void)
+{
+    tst_run_test_case(pqueue_drain_binary);
+    tst_run_test_case(pqueue_drain_quaternary);
+    tst_run_test_case(pqueue_drain_min_queue);
+    tst_run_test_case(pqueue_drain_heapified);
+
+    tst_run_test_case(pqueue_update_decrease);
+    tst_run_test_case(pqueue_update_increase);
+}
+
+#endif
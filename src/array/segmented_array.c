@@ -0,0 +1,324 @@
+
+#include <ustd/segmented_array.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Number of chunks the directory of a new array has room for.
+#define SEGMENTED_ARRAY_STARTING_DIRECTORY (4u)
+
+/**
+ * @brief Directory of chunks, each chunk being a raw allocation of (1 << chunk_shift) elements.
+ */
+struct segmented_array {
+    byte **chunks;
+    size_t nb_chunks;
+    size_t directory_capacity;
+
+    size_t length;
+    u32 chunk_shift;
+    u32 stride;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Number of elements held by a single chunk of the array.
+ *
+ * @param array
+ * @return size_t
+ */
+static size_t segmented_array_chunk_size(const segmented_array *array);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+segmented_array *segmented_array_create(allocator alloc, u32 size_element, u32 chunk_shift)
+{
+    segmented_array *new_array = nullptr;
+
+    if ((size_element == 0) || (chunk_shift >= 32u)) {
+        return nullptr;
+    }
+
+    new_array = alloc.malloc(alloc, sizeof(*new_array));
+
+    if (!new_array) {
+        return nullptr;
+    }
+
+    *new_array = (segmented_array) {
+            .chunks = alloc.malloc(alloc, SEGMENTED_ARRAY_STARTING_DIRECTORY * sizeof(*new_array->chunks)),
+            .nb_chunks = 0,
+            .directory_capacity = SEGMENTED_ARRAY_STARTING_DIRECTORY,
+            .length = 0,
+            .chunk_shift = chunk_shift,
+            .stride = size_element,
+    };
+
+    if (!new_array->chunks) {
+        alloc.free(alloc, new_array);
+        return nullptr;
+    }
+
+    return new_array;
+}
+
+// -----------------------------------------------------------------------------
+
+void segmented_array_destroy(allocator alloc, segmented_array **array)
+{
+    if (!array || !*array) {
+        return;
+    }
+
+    for (size_t i = 0 ; i < (*array)->nb_chunks ; i++) {
+        alloc.free(alloc, (*array)->chunks[i]);
+    }
+
+    alloc.free(alloc, (*array)->chunks);
+    alloc.free(alloc, *array);
+    *array = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void segmented_array_ensure_capacity(allocator alloc, segmented_array *array, size_t additional_capacity)
+{
+    size_t needed_chunks = 0;
+    byte *new_chunk = nullptr;
+    byte **new_directory = nullptr;
+
+    if (!array || (additional_capacity == 0)) {
+        return;
+    }
+
+    needed_chunks = CEIL_DIV(array->length + additional_capacity, segmented_array_chunk_size(array));
+
+    if (needed_chunks > array->directory_capacity) {
+        new_directory = alloc.malloc(alloc, needed_chunks * 2u * sizeof(*new_directory));
+        if (!new_directory) {
+            return;
+        }
+
+        bytewise_copy(new_directory, array->chunks, array->nb_chunks * sizeof(*new_directory));
+        alloc.free(alloc, array->chunks);
+        array->chunks = new_directory;
+        array->directory_capacity = needed_chunks * 2u;
+    }
+
+    while (array->nb_chunks < needed_chunks) {
+        new_chunk = alloc.malloc(alloc, segmented_array_chunk_size(array) * array->stride);
+        if (!new_chunk) {
+            return;
+        }
+
+        array->chunks[array->nb_chunks] = new_chunk;
+        array->nb_chunks += 1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void *segmented_array_push(segmented_array *array, const void *value)
+{
+    void *slot = nullptr;
+
+    if (!array || !value) {
+        return nullptr;
+    }
+
+    if (array->length >= segmented_array_capacity(array)) {
+        return nullptr;
+    }
+
+    array->length += 1;
+    slot = segmented_array_at(array, array->length - 1);
+    bytewise_copy(slot, value, array->stride);
+
+    return slot;
+}
+
+// -----------------------------------------------------------------------------
+
+bool segmented_array_pop(segmented_array *array)
+{
+    if (!array || (array->length == 0)) {
+        return false;
+    }
+
+    array->length -= 1;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void *segmented_array_at(const segmented_array *array, size_t index)
+{
+    size_t mask = 0;
+
+    if (!array || (index >= array->length)) {
+        return nullptr;
+    }
+
+    mask = segmented_array_chunk_size(array) - 1u;
+
+    return array->chunks[index >> array->chunk_shift] + ((index & mask) * array->stride);
+}
+
+// -----------------------------------------------------------------------------
+
+void *segmented_array_chunk(const segmented_array *array, size_t chunk_index, size_t *out_length)
+{
+    size_t first_index = 0;
+
+    if (!array || (chunk_index >= segmented_array_nb_chunks(array))) {
+        if (out_length) {
+            *out_length = 0;
+        }
+        return nullptr;
+    }
+
+    first_index = chunk_index << array->chunk_shift;
+
+    if (out_length) {
+        *out_length = MIN(array->length - first_index, segmented_array_chunk_size(array));
+    }
+
+    return array->chunks[chunk_index];
+}
+
+// -----------------------------------------------------------------------------
+
+size_t segmented_array_nb_chunks(const segmented_array *array)
+{
+    if (!array) {
+        return 0;
+    }
+
+    return CEIL_DIV(array->length, segmented_array_chunk_size(array));
+}
+
+// -----------------------------------------------------------------------------
+
+size_t segmented_array_length(const segmented_array *array)
+{
+    if (!array) {
+        return 0;
+    }
+
+    return array->length;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t segmented_array_capacity(const segmented_array *array)
+{
+    if (!array) {
+        return 0;
+    }
+
+    return array->nb_chunks << array->chunk_shift;
+}
+
+// -----------------------------------------------------------------------------
+
+void segmented_array_clear(segmented_array *array)
+{
+    if (!array) {
+        return;
+    }
+
+    array->length = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static size_t segmented_array_chunk_size(const segmented_array *array)
+{
+    return ((size_t) 1u) << array->chunk_shift;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(segmented_array_stable,
+        {
+            u32 chunk_shift;
+            size_t nb_pushed;
+            size_t expected_nb_chunks;
+        },
+        {
+            segmented_array *array = segmented_array_create(make_system_allocator(), sizeof(u64), data->chunk_shift);
+            u64 *first = nullptr;
+            u64 *pushed = nullptr;
+            u64 value = 0;
+            size_t chunk_length = 0;
+            size_t seen = 0;
+
+            tst_assert(segmented_array_push(array, &value) == nullptr, "push succeeded without any chunk");
+
+            for (size_t i = 0 ; i < data->nb_pushed ; i++) {
+                value = i * 7u;
+                segmented_array_ensure_capacity(make_system_allocator(), array, 1);
+                pushed = segmented_array_push(array, &value);
+                tst_assert(pushed != nullptr, "push %ld failed", i);
+                if (i == 0) {
+                    first = pushed;
+                }
+            }
+
+            tst_assert_equal(data->nb_pushed, segmented_array_length(array), "length of %ld");
+            tst_assert(first == segmented_array_at(array, 0), "first element moved");
+            tst_assert_equal(0lu, *first, "first value of %ld");
+            tst_assert_equal(data->expected_nb_chunks, segmented_array_nb_chunks(array), "%ld chunks");
+
+            for (size_t c = 0 ; c < segmented_array_nb_chunks(array) ; c++) {
+                u64 *chunk = segmented_array_chunk(array, c, &chunk_length);
+                for (size_t i = 0 ; i < chunk_length ; i++) {
+                    tst_assert_equal_ext(seen * 7u, chunk[i], "%ld", "at index %ld", seen);
+                    tst_assert(segmented_array_at(array, seen) == chunk + i, "index %ld misplaced", seen);
+                    seen += 1;
+                }
+            }
+            tst_assert_equal(data->nb_pushed, seen, "scanned %ld elements");
+            tst_assert(segmented_array_at(array, data->nb_pushed) == nullptr, "out of bounds access succeeded");
+
+            segmented_array_destroy(make_system_allocator(), &array);
+            tst_assert(array == nullptr, "array was not nulled");
+        }
+)
+
+tst_CREATE_TEST_CASE(segmented_array_stable_one_chunk, segmented_array_stable,
+        .chunk_shift = 4,
+        .nb_pushed = 16,
+        .expected_nb_chunks = 1,
+)
+tst_CREATE_TEST_CASE(segmented_array_stable_partial_chunk, segmented_array_stable,
+        .chunk_shift = 4,
+        .nb_pushed = 17,
+        .expected_nb_chunks = 2,
+)
+tst_CREATE_TEST_CASE(segmented_array_stable_many_chunks, segmented_array_stable,
+        .chunk_shift = 3,
+        .nb_pushed = 1000,
+        .expected_nb_chunks = 125,
+)
+
+void segmented_array_execute_unittests(void)
+{
+    tst_run_test_case(segmented_array_stable_one_chunk);
+    tst_run_test_case(segmented_array_stable_partial_chunk);
+    tst_run_test_case(segmented_array_stable_many_chunks);
+}
+
+#endif
@@ -0,0 +1,333 @@
+
+#include <stdatomic.h>
+
+#include <ustd/shared_array.h>
+#include <ustd_impl/array_impl.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Shared array header. The fields after `refcount` mirror the header of an array.
+ */
+struct shared_array_impl {
+    _Atomic size_t refcount;
+
+    size_t length;
+    size_t capacity;
+    u32 stride;
+    byte data[];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief
+ *
+ * @param shared_array
+ * @return struct shared_array_impl*
+ */
+static struct shared_array_impl *shared_array_impl_of(const SHARED_ARRAY_ANY shared_array);
+
+/**
+ * @brief Replaces a handle by a new, unique, array holding a copy of its content.
+ *
+ * @param alloc
+ * @param shared_array
+ * @param nb_elements_max
+ * @return true
+ * @return false
+ */
+static bool shared_array_detach(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t nb_elements_max);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+SHARED_ARRAY_ANY shared_array_create(allocator alloc, u32 size_element, size_t nb_elements_max)
+{
+    struct shared_array_impl *new_array = nullptr;
+
+    if ((size_element == 0) || (nb_elements_max == 0)) {
+        return nullptr;
+    }
+
+    new_array = alloc.malloc(alloc, sizeof(*new_array) + (size_element * nb_elements_max));
+
+    if (!new_array) {
+        return nullptr;
+    }
+
+    atomic_init(&new_array->refcount, 1);
+    new_array->length = 0;
+    new_array->capacity = nb_elements_max;
+    new_array->stride = size_element;
+
+    return &(new_array->data);
+}
+
+// -----------------------------------------------------------------------------
+
+SHARED_ARRAY_ANY shared_array_create_from_array(allocator alloc, const ARRAY_ANY array)
+{
+    struct array_impl *source = nullptr;
+    SHARED_ARRAY_ANY new_array = nullptr;
+
+    if (!array) {
+        return nullptr;
+    }
+
+    source = array_impl_of((ARRAY_ANY) array);
+    new_array = shared_array_create(alloc, source->stride, MAX(source->length, 1u));
+
+    if (!new_array) {
+        return nullptr;
+    }
+
+    bytewise_copy(new_array, source->data, source->length * source->stride);
+    shared_array_impl_of(new_array)->length = source->length;
+
+    return new_array;
+}
+
+// -----------------------------------------------------------------------------
+
+SHARED_ARRAY_ANY shared_array_clone(SHARED_ARRAY_ANY shared_array)
+{
+    if (!shared_array) {
+        return nullptr;
+    }
+
+    atomic_fetch_add_explicit(&shared_array_impl_of(shared_array)->refcount, 1, memory_order_relaxed);
+
+    return shared_array;
+}
+
+// -----------------------------------------------------------------------------
+
+void shared_array_destroy(allocator alloc, SHARED_ARRAY_ANY *shared_array)
+{
+    struct shared_array_impl *target = nullptr;
+
+    if (!shared_array || !*shared_array) {
+        return;
+    }
+
+    target = shared_array_impl_of(*shared_array);
+    if (atomic_fetch_sub_explicit(&target->refcount, 1, memory_order_acq_rel) == 1) {
+        alloc.free(alloc, target);
+    }
+
+    *shared_array = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t shared_array_refcount(const SHARED_ARRAY_ANY shared_array)
+{
+    if (!shared_array) {
+        return 0;
+    }
+
+    return atomic_load_explicit(&shared_array_impl_of(shared_array)->refcount, memory_order_acquire);
+}
+
+// -----------------------------------------------------------------------------
+
+bool shared_array_make_unique(allocator alloc, SHARED_ARRAY_ANY *shared_array)
+{
+    if (!shared_array || !*shared_array) {
+        return false;
+    }
+
+    if (shared_array_refcount(*shared_array) == 1) {
+        return true;
+    }
+
+    return shared_array_detach(alloc, shared_array, shared_array_impl_of(*shared_array)->capacity);
+}
+
+// -----------------------------------------------------------------------------
+
+void shared_array_ensure_capacity(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t additional_capacity)
+{
+    struct shared_array_impl *target = nullptr;
+    size_t needed_size = 0;
+
+    if (!shared_array || !*shared_array) {
+        return;
+    }
+
+    target = shared_array_impl_of(*shared_array);
+    needed_size = target->length + additional_capacity;
+
+    if (needed_size <= target->capacity) {
+        shared_array_make_unique(alloc, shared_array);
+        return;
+    }
+
+    shared_array_detach(alloc, shared_array, needed_size * 2u);
+}
+
+// -----------------------------------------------------------------------------
+
+bool shared_array_push(allocator alloc, SHARED_ARRAY_ANY *shared_array, const void *value)
+{
+    if (!shared_array || !*shared_array || !value) {
+        return false;
+    }
+
+    shared_array_ensure_capacity(alloc, shared_array, 1);
+    if (shared_array_refcount(*shared_array) != 1) {
+        return false;
+    }
+
+    return array_push(*shared_array, value);
+}
+
+// -----------------------------------------------------------------------------
+
+bool shared_array_set(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t index, const void *value)
+{
+    struct shared_array_impl *target = nullptr;
+
+    if (!shared_array || !*shared_array || !value || (index >= shared_array_impl_of(*shared_array)->length)) {
+        return false;
+    }
+
+    if (!shared_array_make_unique(alloc, shared_array)) {
+        return false;
+    }
+
+    target = shared_array_impl_of(*shared_array);
+    bytewise_copy(target->data + (index * target->stride), value, target->stride);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool shared_array_remove(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t index)
+{
+    if (!shared_array || !*shared_array || (index >= shared_array_impl_of(*shared_array)->length)) {
+        return false;
+    }
+
+    if (!shared_array_make_unique(alloc, shared_array)) {
+        return false;
+    }
+
+    return array_remove(*shared_array, index);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static struct shared_array_impl *shared_array_impl_of(const SHARED_ARRAY_ANY shared_array)
+{
+    return CONTAINER_OF(shared_array, struct shared_array_impl, data);
+}
+
+// -----------------------------------------------------------------------------
+
+static bool shared_array_detach(allocator alloc, SHARED_ARRAY_ANY *shared_array, size_t nb_elements_max)
+{
+    struct shared_array_impl *target = shared_array_impl_of(*shared_array);
+    SHARED_ARRAY_ANY new_array = nullptr;
+
+    new_array = shared_array_create(alloc, target->stride, nb_elements_max);
+    if (!new_array) {
+        return false;
+    }
+
+    bytewise_copy(new_array, target->data, target->length * target->stride);
+    shared_array_impl_of(new_array)->length = target->length;
+
+    shared_array_destroy(alloc, shared_array);
+    *shared_array = new_array;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(shared_array_copy_on_write,
+        {
+            size_t nb_elements;
+            size_t nb_clones;
+            size_t modified_clone;
+        },
+        {
+            SHARED_ARRAY(u32) original = shared_array_create(make_system_allocator(), sizeof(u32), 1);
+            SHARED_ARRAY(u32) clones[8] = { 0 };
+            SHARED_ARRAY(u32) modified = nullptr;
+            u32 value = 0;
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                tst_assert(shared_array_push(make_system_allocator(), (SHARED_ARRAY_ANY *) &original, &i), "push %d failed", i);
+            }
+            tst_assert_equal(1, shared_array_refcount(original), "refcount of %ld");
+
+            for (size_t i = 0 ; i < data->nb_clones ; i++) {
+                clones[i] = shared_array_clone(original);
+                tst_assert(clones[i] == original, "clone %ld is a copy", i);
+            }
+            tst_assert_equal(data->nb_clones + 1, shared_array_refcount(original), "refcount of %ld");
+
+            value = 1000;
+            modified = clones[data->modified_clone];
+            tst_assert(shared_array_set(make_system_allocator(), (SHARED_ARRAY_ANY *) &modified, 0, &value), "set failed");
+            tst_assert(modified != original, "modified clone was not copied");
+            tst_assert_equal(1, shared_array_refcount(modified), "modified refcount of %ld");
+            tst_assert_equal(data->nb_clones, shared_array_refcount(original), "original refcount of %ld");
+            tst_assert_equal(1000, modified[0], "modified first element of %d");
+            tst_assert_equal(0, original[0], "original first element of %d");
+            tst_assert_equal(array_length(original), array_length(modified), "modified length of %ld");
+
+            tst_assert(shared_array_remove(make_system_allocator(), (SHARED_ARRAY_ANY *) &modified, 0), "remove failed");
+            tst_assert_equal(data->nb_elements - 1, array_length(modified), "length after remove of %ld");
+            tst_assert_equal(data->nb_elements, array_length(original), "original length after remove of %ld");
+
+            shared_array_destroy(make_system_allocator(), (SHARED_ARRAY_ANY *) &modified);
+            for (size_t i = 0 ; i < data->nb_clones ; i++) {
+                if (i != data->modified_clone) {
+                    shared_array_destroy(make_system_allocator(), (SHARED_ARRAY_ANY *) &clones[i]);
+                }
+            }
+
+            tst_assert_equal(1, shared_array_refcount(original), "final refcount of %ld");
+            tst_assert(shared_array_make_unique(make_system_allocator(), (SHARED_ARRAY_ANY *) &original), "make unique failed");
+            tst_assert(array_get(original, data->nb_elements - 1, &value), "original lost elements");
+
+            shared_array_destroy(make_system_allocator(), (SHARED_ARRAY_ANY *) &original);
+        }
+)
+
+tst_CREATE_TEST_CASE(shared_array_copy_on_write_one_clone, shared_array_copy_on_write,
+        .nb_elements = 10,
+        .nb_clones = 1,
+        .modified_clone = 0,
+)
+tst_CREATE_TEST_CASE(shared_array_copy_on_write_many_clones, shared_array_copy_on_write,
+        .nb_elements = 100,
+        .nb_clones = 8,
+        .modified_clone = 5,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void shared_array_execute_unittests(void)
+{
+    tst_run_test_case(shared_array_copy_on_write_one_clone);
+    tst_run_test_case(shared_array_copy_on_write_many_clones);
+}
+
+#endif
@@ -0,0 +1,196 @@
+
+#include <ustd/small_array.h>
+#include <ustd_impl/array_impl.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Layout shared by all small arrays, whatever their element type.
+ */
+struct small_array_impl {
+    ARRAY_ANY array;
+
+    size_t length;
+    size_t capacity;
+    u32 stride;
+    byte data[];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+ARRAY_ANY small_array_init(SMALL_ARRAY_ANY small_array, u32 size_element, size_t inline_capacity)
+{
+    struct small_array_impl *target = small_array;
+
+    if (!target || (size_element == 0)) {
+        return nullptr;
+    }
+
+    target->length = 0;
+    target->capacity = inline_capacity;
+    target->stride = size_element;
+    target->array = &(target->data);
+
+    return target->array;
+}
+
+// -----------------------------------------------------------------------------
+
+void small_array_release(allocator alloc, SMALL_ARRAY_ANY small_array)
+{
+    struct small_array_impl *target = small_array;
+
+    if (!target) {
+        return;
+    }
+
+    if (!small_array_is_inline(small_array)) {
+        array_destroy(alloc, &target->array);
+    }
+
+    target->length = 0;
+    target->array = &(target->data);
+}
+
+// -----------------------------------------------------------------------------
+
+bool small_array_is_inline(const SMALL_ARRAY_ANY small_array)
+{
+    const struct small_array_impl *target = small_array;
+
+    if (!target) {
+        return false;
+    }
+
+    return target->array == (ARRAY_ANY) &(target->data);
+}
+
+// -----------------------------------------------------------------------------
+
+void small_array_ensure_capacity(allocator alloc, SMALL_ARRAY_ANY small_array, size_t additional_capacity)
+{
+    struct small_array_impl *target = small_array;
+    size_t needed_size = 0;
+
+    ARRAY_ANY spilled = nullptr;
+
+    if (!target || (additional_capacity == 0)) {
+        return;
+    }
+
+    if (!small_array_is_inline(small_array)) {
+        array_ensure_capacity(alloc, &target->array, additional_capacity);
+        return;
+    }
+
+    needed_size = target->length + additional_capacity;
+    if (needed_size <= target->capacity) {
+        return;
+    }
+
+    spilled = array_create(alloc, target->stride, needed_size * 2u);
+    if (!spilled) {
+        return;
+    }
+
+    bytewise_copy(spilled, target->data, target->length * target->stride);
+    array_impl_of(spilled)->length = target->length;
+
+    target->array = spilled;
+}
+
+// -----------------------------------------------------------------------------
+
+bool small_array_push(allocator alloc, SMALL_ARRAY_ANY small_array, const void *value)
+{
+    struct small_array_impl *target = small_array;
+
+    if (!target || !value) {
+        return false;
+    }
+
+    small_array_ensure_capacity(alloc, small_array, 1);
+
+    return array_push(target->array, value);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+static i32 test_u32_comparator(const void *v1, const void *v2) {
+    u32 val1 = *((u32 *) v1);
+    u32 val2 = *((u32 *) v2);
+
+    return (val1 > val2) - (val1 < val2);
+}
+
+tst_CREATE_TEST_SCENARIO(small_array_push,
+        {
+            size_t nb_pushed;
+            bool expect_inline;
+        },
+        {
+            SMALL_ARRAY(u32, 8) small = { 0 };
+            size_t pos = 0;
+            u32 value = 0;
+
+            tst_assert(SMALL_ARRAY_INIT(&small) == small.array, "init did not return the array");
+            tst_assert_equal(8lu, array_capacity(small.array), "capacity of %ld");
+
+            for (u32 i = 0 ; i < data->nb_pushed ; i++) {
+                value = i * 3u;
+                tst_assert(small_array_push(make_system_allocator(), &small, &value), "push %d failed", i);
+            }
+
+            tst_assert_equal(data->expect_inline, small_array_is_inline(&small), "inline status of %d");
+            tst_assert_equal(data->nb_pushed, array_length(small.array), "length of %ld");
+
+            for (u32 i = 0 ; i < data->nb_pushed ; i++) {
+                tst_assert(array_get(small.array, i, &value), "get %d failed", i);
+                tst_assert_equal_ext(i * 3u, value, "%d", "at index %d", i);
+            }
+
+            value = ((u32) data->nb_pushed - 1u) * 3u;
+            tst_assert(array_find(small.array, &test_u32_comparator, &value, &pos), "find failed");
+            tst_assert_equal(data->nb_pushed - 1u, pos, "position of %ld");
+
+            small_array_release(make_system_allocator(), &small);
+            tst_assert(small_array_is_inline(&small), "release did not go back to inline storage");
+            tst_assert_equal(0lu, array_length(small.array), "length of %ld");
+        }
+)
+
+tst_CREATE_TEST_CASE(small_array_push_inline, small_array_push,
+        .nb_pushed = 5,
+        .expect_inline = true,
+)
+tst_CREATE_TEST_CASE(small_array_push_full, small_array_push,
+        .nb_pushed = 8,
+        .expect_inline = true,
+)
+tst_CREATE_TEST_CASE(small_array_push_spill, small_array_push,
+        .nb_pushed = 9,
+        .expect_inline = false,
+)
+tst_CREATE_TEST_CASE(small_array_push_spill_far, small_array_push,
+        .nb_pushed = 100,
+        .expect_inline = false,
+)
+
+void small_array_execute_unittests(void)
+{
+    tst_run_test_case(small_array_push_inline);
+    tst_run_test_case(small_array_push_full);
+    tst_run_test_case(small_array_push_spill);
+    tst_run_test_case(small_array_push_spill_far);
+}
+
+#endif
@@ -0,0 +1,371 @@
+
+#include <ustd/soa.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#include <ustd/math3d.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief A single field's storage.
+ */
+struct soa_column {
+    byte *data;
+    u32 stride;
+};
+
+/**
+ * @brief Container header, followed in the same allocation by the columns table and the (aligned)
+ * columns themselves.
+ */
+struct soa {
+    size_t length;
+    size_t capacity;
+    size_t nb_fields;
+    struct soa_column columns[];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Rounds a size up to the next multiple of SOA_COLUMN_ALIGNMENT.
+ *
+ * @param size
+ * @return size_t
+ */
+static size_t soa_align(size_t size);
+
+/**
+ * @brief Creates a container whose field sizes are read every `sizes_spacing` bytes from `field_sizes`,
+ * so they can be taken directly from the columns table of another container.
+ *
+ * @param alloc
+ * @param nb_elements_max
+ * @param field_sizes
+ * @param sizes_spacing
+ * @param nb_fields
+ * @return soa*
+ */
+static soa *soa_create_spaced(allocator alloc, size_t nb_elements_max, const u32 *field_sizes, size_t sizes_spacing, size_t nb_fields);
+
+/**
+ * @brief Returns the i-th field size read by soa_create_spaced().
+ *
+ * @param field_sizes
+ * @param sizes_spacing
+ * @param i
+ * @return u32
+ */
+static u32 soa_field_size(const u32 *field_sizes, size_t sizes_spacing, size_t i);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+soa *soa_create(allocator alloc, size_t nb_elements_max, const u32 *field_sizes, size_t nb_fields)
+{
+    return soa_create_spaced(alloc, nb_elements_max, field_sizes, sizeof(*field_sizes), nb_fields);
+}
+
+// -----------------------------------------------------------------------------
+
+void soa_destroy(allocator alloc, soa **container)
+{
+    if (!container || !*container) {
+        return;
+    }
+
+    alloc.free(alloc, *container);
+    *container = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void soa_ensure_capacity(allocator alloc, soa **container, size_t additional_capacity)
+{
+    soa *target = nullptr;
+    soa *new_soa = nullptr;
+    size_t needed_size = 0;
+
+    if (!container || !*container || (additional_capacity == 0)) {
+        return;
+    }
+
+    target = *container;
+    needed_size = target->length + additional_capacity;
+
+    if (needed_size <= target->capacity) {
+        return;
+    }
+
+    new_soa = soa_create_spaced(alloc, needed_size * 2u, &target->columns[0].stride, sizeof(*target->columns), target->nb_fields);
+    if (!new_soa) {
+        return;
+    }
+
+    for (size_t i = 0 ; i < target->nb_fields ; i++) {
+        bytewise_copy(new_soa->columns[i].data, target->columns[i].data, target->length * target->columns[i].stride);
+    }
+    new_soa->length = target->length;
+
+    soa_destroy(alloc, container);
+    *container = new_soa;
+}
+
+// -----------------------------------------------------------------------------
+
+bool soa_push(soa *container, const void *const *values)
+{
+    byte *slot = nullptr;
+
+    if (!container || !values || (container->length >= container->capacity)) {
+        return false;
+    }
+
+    for (size_t i = 0 ; i < container->nb_fields ; i++) {
+        slot = container->columns[i].data + (container->length * container->columns[i].stride);
+
+        if (values[i]) {
+            bytewise_copy(slot, values[i], container->columns[i].stride);
+        } else {
+            for (size_t b = 0 ; b < container->columns[i].stride ; b++) {
+                slot[b] = 0;
+            }
+        }
+    }
+
+    container->length += 1;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool soa_remove_swapback(soa *container, size_t index)
+{
+    struct soa_column *column = nullptr;
+
+    if (!container || (index >= container->length)) {
+        return false;
+    }
+
+    container->length -= 1;
+
+    if (index == container->length) {
+        return true;
+    }
+
+    for (size_t i = 0 ; i < container->nb_fields ; i++) {
+        column = container->columns + i;
+        bytewise_copy(column->data + (index * column->stride),
+                column->data + (container->length * column->stride), column->stride);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool soa_get(const soa *container, size_t index, size_t field, void *out_value)
+{
+    if (!container || (index >= container->length) || (field >= container->nb_fields)) {
+        return false;
+    }
+
+    if (out_value) {
+        bytewise_copy(out_value, container->columns[field].data + (index * container->columns[field].stride),
+                container->columns[field].stride);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void *soa_column(const soa *container, size_t field)
+{
+    if (!container || (field >= container->nb_fields)) {
+        return nullptr;
+    }
+
+    return container->columns[field].data;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t soa_length(const soa *container)
+{
+    if (!container) {
+        return 0;
+    }
+
+    return container->length;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t soa_capacity(const soa *container)
+{
+    if (!container) {
+        return 0;
+    }
+
+    return container->capacity;
+}
+
+// -----------------------------------------------------------------------------
+
+void soa_clear(soa *container)
+{
+    if (!container) {
+        return;
+    }
+
+    container->length = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static size_t soa_align(size_t size)
+{
+    return (size + (SOA_COLUMN_ALIGNMENT - 1u)) & ~((size_t) SOA_COLUMN_ALIGNMENT - 1u);
+}
+
+// -----------------------------------------------------------------------------
+
+static soa *soa_create_spaced(allocator alloc, size_t nb_elements_max, const u32 *field_sizes, size_t sizes_spacing, size_t nb_fields)
+{
+    soa *new_soa = nullptr;
+    size_t header_size = 0;
+    size_t total_size = 0;
+    uintptr_t column_start = 0;
+    u32 field_size = 0;
+
+    if ((nb_elements_max == 0) || !field_sizes || (nb_fields == 0)) {
+        return nullptr;
+    }
+
+    header_size = sizeof(*new_soa) + (nb_fields * sizeof(*new_soa->columns));
+    total_size = header_size + SOA_COLUMN_ALIGNMENT;
+    for (size_t i = 0 ; i < nb_fields ; i++) {
+        field_size = soa_field_size(field_sizes, sizes_spacing, i);
+        if (field_size == 0) {
+            return nullptr;
+        }
+        total_size += soa_align(field_size * nb_elements_max);
+    }
+
+    new_soa = alloc.malloc(alloc, total_size);
+
+    if (!new_soa) {
+        return nullptr;
+    }
+
+    new_soa->length = 0;
+    new_soa->capacity = nb_elements_max;
+    new_soa->nb_fields = nb_fields;
+
+    column_start = soa_align((uintptr_t) new_soa + header_size);
+    for (size_t i = 0 ; i < nb_fields ; i++) {
+        field_size = soa_field_size(field_sizes, sizes_spacing, i);
+        new_soa->columns[i] = (struct soa_column) { .data = (byte *) column_start, .stride = field_size };
+        column_start += soa_align(field_size * nb_elements_max);
+    }
+
+    return new_soa;
+}
+
+// -----------------------------------------------------------------------------
+
+static u32 soa_field_size(const u32 *field_sizes, size_t sizes_spacing, size_t i)
+{
+    return *((const u32 *) ((const byte *) field_sizes + (i * sizes_spacing)));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+enum { TEST_ENTITY_POSITION, TEST_ENTITY_ORIENTATION, TEST_ENTITY_FLAGS, TEST_ENTITY_NB_FIELDS };
+
+tst_CREATE_TEST_SCENARIO(soa_entities,
+        {
+            size_t starting_capacity;
+            size_t nb_pushed;
+            size_t removed;
+        },
+        {
+            soa *entities = soa_create(make_system_allocator(), data->starting_capacity, (u32[TEST_ENTITY_NB_FIELDS]) {
+                    [TEST_ENTITY_POSITION] = sizeof(vector3),
+                    [TEST_ENTITY_ORIENTATION] = sizeof(quaternion),
+                    [TEST_ENTITY_FLAGS] = sizeof(u32),
+            }, TEST_ENTITY_NB_FIELDS);
+            vector3 position = { 0 };
+            u32 flags = 0;
+
+            for (u32 i = 0 ; i < data->nb_pushed ; i++) {
+                position.x = (f32) i;
+                position.y = (f32) i;
+                position.z = (f32) i;
+                flags = i;
+
+                soa_ensure_capacity(make_system_allocator(), &entities, 1);
+                tst_assert(soa_push(entities, (const void *[TEST_ENTITY_NB_FIELDS]) {
+                        [TEST_ENTITY_POSITION] = &position,
+                        [TEST_ENTITY_ORIENTATION] = nullptr,
+                        [TEST_ENTITY_FLAGS] = &flags,
+                }), "push %d failed", i);
+            }
+
+            tst_assert_equal(data->nb_pushed, soa_length(entities), "length of %ld");
+            for (size_t f = 0 ; f < TEST_ENTITY_NB_FIELDS ; f++) {
+                tst_assert(((uintptr_t) soa_column(entities, f) % SOA_COLUMN_ALIGNMENT) == 0, "column %ld is not aligned", f);
+            }
+
+            tst_assert(soa_remove_swapback(entities, data->removed), "removal failed");
+            tst_assert_equal(data->nb_pushed - 1, soa_length(entities), "length of %ld");
+
+            for (size_t i = 0 ; i < soa_length(entities) ; i++) {
+                u32 expected = (i == data->removed) ? (u32) (data->nb_pushed - 1) : (u32) i;
+
+                tst_assert_equal_ext(expected, SOA_COLUMN(entities, TEST_ENTITY_FLAGS, u32)[i], "%d", "flags at index %ld", i);
+                tst_assert_equal_ext((f32) expected, SOA_COLUMN(entities, TEST_ENTITY_POSITION, vector3)[i].x, "%f", "position at index %ld", i);
+                tst_assert_equal_ext(0.0f, SOA_COLUMN(entities, TEST_ENTITY_ORIENTATION, quaternion)[i].w, "%f", "orientation at index %ld", i);
+            }
+
+            tst_assert(soa_get(entities, 0, TEST_ENTITY_FLAGS, &flags), "get failed");
+            tst_assert(!soa_get(entities, 0, TEST_ENTITY_NB_FIELDS, &flags), "get on unknown field succeeded");
+
+            soa_destroy(make_system_allocator(), &entities);
+        }
+)
+
+tst_CREATE_TEST_CASE(soa_entities_no_growth, soa_entities,
+        .starting_capacity = 16,
+        .nb_pushed = 10,
+        .removed = 3,
+)
+tst_CREATE_TEST_CASE(soa_entities_growth, soa_entities,
+        .starting_capacity = 1,
+        .nb_pushed = 100,
+        .removed = 0,
+)
+tst_CREATE_TEST_CASE(soa_entities_remove_last, soa_entities,
+        .starting_capacity = 4,
+        .nb_pushed = 5,
+        .removed = 4,
+)
+
+void soa_execute_unittests(void)
+{
+    tst_run_test_case(soa_entities_no_growth);
+    tst_run_test_case(soa_entities_growth);
+    tst_run_test_case(soa_entities_remove_last);
+}
+
+#endif
@@ -25,14 +25,7 @@ void bytewise_copy(void *dest, const void *source, size_t nb_bytes)
 // -------------------------------------------------------------------------------------------------
 u8 count_set_bits(u8 value)
 {
-    u8 counter = 0u;
-
-    while (value)  {
-        counter += 1u;
-        value &= (u8) (value - 1u);
-    }
-
-    return counter;
+    return (u8) __builtin_popcount(value);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -20,6 +20,21 @@ u32 hash_jenkins_one_at_a_time(const byte *key, size_t length, u32 seed)
     return hash;
 }
 
+// -------------------------------------------------------------------------------------------------
+u32 hash_integer(u64 key, u32 seed)
+{
+    u64 hash = key ^ ((u64) seed * 0x9e3779b97f4a7c15u);
+
+    // finalizer of murmur3
+    hash ^= hash >> 33u;
+    hash *= 0xff51afd7ed558ccdu;
+    hash ^= hash >> 33u;
+    hash *= 0xc4ceb9fe1a85ec53u;
+    hash ^= hash >> 33u;
+
+    return (u32) (hash ^ (hash >> 32u));
+}
+
 // -------------------------------------------------------------------------------------------------
 i32 hash_compare(const void *lhs, const void *rhs)
 {
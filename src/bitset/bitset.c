@@ -0,0 +1,568 @@
+
+#include <ustd/bitset.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Bitset header, followed by the words.
+ * Bits of the last word past `nb_bits` are always kept cleared.
+ */
+struct bitset_impl {
+    size_t nb_bits;
+    size_t nb_words;
+    size_t capacity_words;
+    u64 words[];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief
+ *
+ * @param bitset
+ * @return struct bitset_impl*
+ */
+static struct bitset_impl *bitset_impl_of(const BITSET bitset);
+
+/**
+ * @brief Allocates a cleared bitset able to hold some number of words.
+ *
+ * @param alloc
+ * @param nb_bits
+ * @param nb_words_max
+ * @return BITSET
+ */
+static BITSET bitset_create_words(allocator alloc, size_t nb_bits, size_t nb_words_max);
+
+/**
+ * @brief Clears the bits of the last word that are past the length of the bitset.
+ *
+ * @param bitset
+ */
+static void bitset_mask_tail(BITSET bitset);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+BITSET bitset_create(allocator alloc, size_t nb_bits)
+{
+    return bitset_create_words(alloc, nb_bits, MAX(CEIL_DIV(nb_bits, BITSET_WORD_BITS), 1u));
+}
+
+// -----------------------------------------------------------------------------
+
+void bitset_destroy(allocator alloc, BITSET *bitset)
+{
+    if (!bitset || !*bitset) {
+        return;
+    }
+
+    alloc.free(alloc, bitset_impl_of(*bitset));
+    *bitset = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void bitset_resize(allocator alloc, BITSET *bitset, size_t nb_bits)
+{
+    struct bitset_impl *target = nullptr;
+    size_t nb_words = CEIL_DIV(nb_bits, BITSET_WORD_BITS);
+    BITSET new_bitset = nullptr;
+
+    if (!bitset || !*bitset) {
+        return;
+    }
+
+    target = bitset_impl_of(*bitset);
+
+    if (nb_words > target->capacity_words) {
+        new_bitset = bitset_create_words(alloc, nb_bits, nb_words * 2u);
+        if (!new_bitset) {
+            return;
+        }
+
+        bytewise_copy(new_bitset, target->words, target->nb_words * sizeof(*target->words));
+        bitset_destroy(alloc, bitset);
+        *bitset = new_bitset;
+        return;
+    }
+
+    for (size_t i = target->nb_words ; i < nb_words ; i++) {
+        (*bitset)[i] = 0u;
+    }
+
+    target->nb_bits = nb_bits;
+    target->nb_words = nb_words;
+    bitset_mask_tail(*bitset);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t bitset_length(const BITSET bitset)
+{
+    if (!bitset) {
+        return 0;
+    }
+
+    return bitset_impl_of(bitset)->nb_bits;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t bitset_nb_words(const BITSET bitset)
+{
+    if (!bitset) {
+        return 0;
+    }
+
+    return bitset_impl_of(bitset)->nb_words;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t bitset_capacity_words(const BITSET bitset)
+{
+    if (!bitset) {
+        return 0;
+    }
+
+    return bitset_impl_of(bitset)->capacity_words;
+}
+
+// -----------------------------------------------------------------------------
+
+bool bitset_set(BITSET bitset, size_t index)
+{
+    if (!bitset || (index >= bitset_impl_of(bitset)->nb_bits)) {
+        return false;
+    }
+
+    bitset[index / BITSET_WORD_BITS] |= (1ull << (index % BITSET_WORD_BITS));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool bitset_clear(BITSET bitset, size_t index)
+{
+    if (!bitset || (index >= bitset_impl_of(bitset)->nb_bits)) {
+        return false;
+    }
+
+    bitset[index / BITSET_WORD_BITS] &= ~(1ull << (index % BITSET_WORD_BITS));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool bitset_test(const BITSET bitset, size_t index)
+{
+    if (!bitset || (index >= bitset_impl_of(bitset)->nb_bits)) {
+        return false;
+    }
+
+    return (bitset[index / BITSET_WORD_BITS] >> (index % BITSET_WORD_BITS)) & 1u;
+}
+
+// -----------------------------------------------------------------------------
+
+void bitset_reset(BITSET bitset)
+{
+    size_t nb_words = 0;
+
+    if (!bitset) {
+        return;
+    }
+
+    nb_words = bitset_impl_of(bitset)->nb_words;
+    for (size_t i = 0 ; i < nb_words ; i++) {
+        bitset[i] = 0u;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void bitset_and(BITSET dest, const BITSET source)
+{
+    size_t nb_words_dest = 0;
+    size_t nb_words = 0;
+
+    if (!dest || !source) {
+        return;
+    }
+
+    nb_words_dest = bitset_impl_of(dest)->nb_words;
+    nb_words = MIN(nb_words_dest, bitset_impl_of(source)->nb_words);
+
+    for (size_t i = 0 ; i < nb_words ; i++) {
+        dest[i] &= source[i];
+    }
+    for (size_t i = nb_words ; i < nb_words_dest ; i++) {
+        dest[i] = 0u;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void bitset_or(BITSET dest, const BITSET source)
+{
+    size_t nb_words = 0;
+
+    if (!dest || !source) {
+        return;
+    }
+
+    nb_words = MIN(bitset_impl_of(dest)->nb_words, bitset_impl_of(source)->nb_words);
+    for (size_t i = 0 ; i < nb_words ; i++) {
+        dest[i] |= source[i];
+    }
+
+    bitset_mask_tail(dest);
+}
+
+// -----------------------------------------------------------------------------
+
+void bitset_xor(BITSET dest, const BITSET source)
+{
+    size_t nb_words = 0;
+
+    if (!dest || !source) {
+        return;
+    }
+
+    nb_words = MIN(bitset_impl_of(dest)->nb_words, bitset_impl_of(source)->nb_words);
+    for (size_t i = 0 ; i < nb_words ; i++) {
+        dest[i] ^= source[i];
+    }
+
+    bitset_mask_tail(dest);
+}
+
+// -----------------------------------------------------------------------------
+
+void bitset_andnot(BITSET dest, const BITSET source)
+{
+    size_t nb_words = 0;
+
+    if (!dest || !source) {
+        return;
+    }
+
+    nb_words = MIN(bitset_impl_of(dest)->nb_words, bitset_impl_of(source)->nb_words);
+    for (size_t i = 0 ; i < nb_words ; i++) {
+        dest[i] &= ~source[i];
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+size_t bitset_count(const BITSET bitset)
+{
+    size_t nb_words = 0;
+    size_t counter = 0;
+
+    if (!bitset) {
+        return 0;
+    }
+
+    nb_words = bitset_impl_of(bitset)->nb_words;
+    for (size_t i = 0 ; i < nb_words ; i++) {
+        counter += (size_t) __builtin_popcountll(bitset[i]);
+    }
+
+    return counter;
+}
+
+// -----------------------------------------------------------------------------
+
+bool bitset_next_set(const BITSET bitset, size_t from_index, size_t *out_index)
+{
+    size_t nb_words = 0;
+    size_t word_index = 0;
+    u64 word = 0u;
+
+    if (!bitset || (from_index >= bitset_impl_of(bitset)->nb_bits)) {
+        return false;
+    }
+
+    nb_words = bitset_impl_of(bitset)->nb_words;
+    word_index = from_index / BITSET_WORD_BITS;
+    word = bitset[word_index] & (~0ull << (from_index % BITSET_WORD_BITS));
+
+    while (!word && (++word_index < nb_words)) {
+        word = bitset[word_index];
+    }
+
+    if (!word) {
+        return false;
+    }
+
+    if (out_index) {
+        *out_index = (word_index * BITSET_WORD_BITS) + (size_t) __builtin_ctzll(word);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t bitset_rank(const BITSET bitset, size_t index)
+{
+    size_t counter = 0;
+    size_t nb_full_words = 0;
+
+    if (!bitset) {
+        return 0;
+    }
+
+    index = MIN(index, bitset_impl_of(bitset)->nb_bits);
+    nb_full_words = index / BITSET_WORD_BITS;
+
+    for (size_t i = 0 ; i < nb_full_words ; i++) {
+        counter += (size_t) __builtin_popcountll(bitset[i]);
+    }
+
+    if (index % BITSET_WORD_BITS) {
+        counter += (size_t) __builtin_popcountll(bitset[nb_full_words] & ~(~0ull << (index % BITSET_WORD_BITS)));
+    }
+
+    return counter;
+}
+
+// -----------------------------------------------------------------------------
+
+bool bitset_select(const BITSET bitset, size_t nth, size_t *out_index)
+{
+    size_t nb_words = 0;
+    size_t word_index = 0;
+    size_t word_count = 0;
+    u64 word = 0u;
+
+    if (!bitset) {
+        return false;
+    }
+
+    nb_words = bitset_impl_of(bitset)->nb_words;
+    while (word_index < nb_words) {
+        word_count = (size_t) __builtin_popcountll(bitset[word_index]);
+        if (nth < word_count) {
+            break;
+        }
+        nth -= word_count;
+        word_index += 1;
+    }
+
+    if (word_index == nb_words) {
+        return false;
+    }
+
+    word = bitset[word_index];
+    for (size_t i = 0 ; i < nth ; i++) {
+        word &= word - 1u;
+    }
+
+    if (out_index) {
+        *out_index = (word_index * BITSET_WORD_BITS) + (size_t) __builtin_ctzll(word);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static struct bitset_impl *bitset_impl_of(const BITSET bitset)
+{
+    return CONTAINER_OF(bitset, struct bitset_impl, words);
+}
+
+// -----------------------------------------------------------------------------
+
+static BITSET bitset_create_words(allocator alloc, size_t nb_bits, size_t nb_words_max)
+{
+    struct bitset_impl *new_bitset = nullptr;
+    BITSET words = nullptr;
+
+    new_bitset = alloc.malloc(alloc, sizeof(*new_bitset) + (nb_words_max * sizeof(*words)));
+
+    if (!new_bitset) {
+        return nullptr;
+    }
+
+    *new_bitset = (struct bitset_impl) {
+            .nb_bits = nb_bits,
+
+            .nb_words = CEIL_DIV(nb_bits, BITSET_WORD_BITS),
+            .capacity_words = nb_words_max,
+    };
+
+    words = new_bitset->words;
+    for (size_t i = 0 ; i < nb_words_max ; i++) {
+        words[i] = 0u;
+    }
+
+    return words;
+}
+
+// -----------------------------------------------------------------------------
+
+static void bitset_mask_tail(BITSET bitset)
+{
+    struct bitset_impl *target = bitset_impl_of(bitset);
+
+    if (target->nb_bits % BITSET_WORD_BITS) {
+        bitset[target->nb_words - 1] &= ~(~0ull << (target->nb_bits % BITSET_WORD_BITS));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(bitset_members,
+        {
+            size_t nb_bits;
+            size_t step;
+        },
+        {
+            BITSET bits = bitset_create(make_system_allocator(), data->nb_bits);
+            size_t expected_count = 0;
+            size_t index = 0;
+            size_t nb_iterated = 0;
+
+            tst_assert_equal(CEIL_DIV(data->nb_bits, BITSET_WORD_BITS), bitset_nb_words(bits), "%ld words");
+            tst_assert_equal(bitset_nb_words(bits), bitset_capacity_words(bits), "capacity of %ld words");
+
+            for (size_t i = 0 ; i < data->nb_bits ; i += data->step) {
+                tst_assert(bitset_set(bits, i), "set %ld failed", i);
+                expected_count += 1;
+            }
+            tst_assert(!bitset_set(bits, data->nb_bits), "out of bounds set succeeded");
+
+            tst_assert_equal(expected_count, bitset_count(bits), "count of %ld");
+
+            for (size_t i = 0 ; bitset_next_set(bits, i, &i) ; i++) {
+                tst_assert_equal_ext(nb_iterated * data->step, i, "%ld", "iterated bit %ld", nb_iterated);
+                tst_assert_equal_ext(nb_iterated, bitset_rank(bits, i), "%ld", "rank of bit %ld", i);
+                tst_assert(bitset_select(bits, nb_iterated, &index), "select %ld failed", nb_iterated);
+                tst_assert_equal_ext(i, index, "%ld", "selected bit %ld", nb_iterated);
+                nb_iterated += 1;
+            }
+            tst_assert_equal(expected_count, nb_iterated, "%ld bits iterated");
+            tst_assert(!bitset_select(bits, expected_count, &index), "select past the count succeeded");
+
+            tst_assert(bitset_clear(bits, 0), "clear failed");
+            tst_assert(!bitset_test(bits, 0), "bit 0 still set");
+            tst_assert_equal(expected_count - 1, bitset_count(bits), "count after clear of %ld");
+
+            bitset_resize(make_system_allocator(), &bits, data->nb_bits * 3);
+            tst_assert_equal(data->nb_bits * 3, bitset_length(bits), "length after resize of %ld");
+            tst_assert_equal(CEIL_DIV(data->nb_bits * 3, BITSET_WORD_BITS), bitset_nb_words(bits), "%ld words after resize");
+            tst_assert(bitset_capacity_words(bits) >= bitset_nb_words(bits), "capacity of %ld words", bitset_capacity_words(bits));
+            tst_assert_equal(expected_count - 1, bitset_count(bits), "count after resize of %ld");
+
+            bitset_resize(make_system_allocator(), &bits, 1);
+            bitset_resize(make_system_allocator(), &bits, data->nb_bits);
+            tst_assert_equal(0, bitset_count(bits), "count after shrink of %ld");
+
+            bitset_destroy(make_system_allocator(), &bits);
+        }
+)
+
+tst_CREATE_TEST_CASE(bitset_members_dense, bitset_members,
+        .nb_bits = 200,
+        .step = 1,
+)
+tst_CREATE_TEST_CASE(bitset_members_sparse, bitset_members,
+        .nb_bits = 1000,
+        .step = 97,
+)
+tst_CREATE_TEST_CASE(bitset_members_one_word, bitset_members,
+        .nb_bits = 64,
+        .step = 3,
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(bitset_bulk,
+        {
+            size_t nb_bits_lhs;
+            size_t nb_bits_rhs;
+        },
+        {
+            BITSET lhs = bitset_create(make_system_allocator(), data->nb_bits_lhs);
+            BITSET rhs = bitset_create(make_system_allocator(), data->nb_bits_rhs);
+            BITSET result = bitset_create(make_system_allocator(), data->nb_bits_lhs);
+            size_t shared = MIN(data->nb_bits_lhs, data->nb_bits_rhs);
+            size_t expected = 0;
+
+            for (size_t i = 0 ; i < data->nb_bits_lhs ; i += 2) {
+                bitset_set(lhs, i);
+            }
+            for (size_t i = 0 ; i < data->nb_bits_rhs ; i += 3) {
+                bitset_set(rhs, i);
+            }
+
+            bitset_or(result, lhs);
+            bitset_and(result, rhs);
+            expected = CEIL_DIV(shared, 6);
+            tst_assert_equal(expected, bitset_count(result), "and count of %ld");
+
+            bitset_reset(result);
+            bitset_or(result, lhs);
+            bitset_or(result, rhs);
+            expected = CEIL_DIV(data->nb_bits_lhs, 2) + CEIL_DIV(shared, 3) - CEIL_DIV(shared, 6);
+            tst_assert_equal(expected, bitset_count(result), "or count of %ld");
+
+            bitset_andnot(result, lhs);
+            expected = CEIL_DIV(shared, 3) - CEIL_DIV(shared, 6);
+            tst_assert_equal(expected, bitset_count(result), "andnot count of %ld");
+
+            bitset_xor(result, rhs);
+            expected = CEIL_DIV(shared, 6);
+            tst_assert_equal(expected, bitset_count(result), "xor count of %ld");
+            tst_assert(!bitset_next_set(result, data->nb_bits_lhs, nullptr), "bit set past the length");
+
+            bitset_destroy(make_system_allocator(), &lhs);
+            bitset_destroy(make_system_allocator(), &rhs);
+            bitset_destroy(make_system_allocator(), &result);
+        }
+)
+
+tst_CREATE_TEST_CASE(bitset_bulk_same_length, bitset_bulk,
+        .nb_bits_lhs = 300,
+        .nb_bits_rhs = 300,
+)
+tst_CREATE_TEST_CASE(bitset_bulk_shorter_source, bitset_bulk,
+        .nb_bits_lhs = 300,
+        .nb_bits_rhs = 100,
+)
+tst_CREATE_TEST_CASE(bitset_bulk_longer_source, bitset_bulk,
+        .nb_bits_lhs = 100,
+        .nb_bits_rhs = 300,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void bitset_execute_unittests(void)
+{
+    tst_run_test_case(bitset_members_dense);
+    tst_run_test_case(bitset_members_sparse);
+    tst_run_test_case(bitset_members_one_word);
+
+    tst_run_test_case(bitset_bulk_same_length);
+    tst_run_test_case(bitset_bulk_shorter_source);
+    tst_run_test_case(bitset_bulk_longer_source);
+}
+
+#endif
@@ -0,0 +1,696 @@
+
+#include <ustd/cache.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Marks the absence of an entry in the links between entries.
+#define CACHE_NO_ENTRY (UINT32_MAX)
+
+/**
+ * @brief Bookkeeping of a slot of the cache. Its value lives at the same index in the values of the cache.
+ */
+struct cache_entry {
+    u64 key;
+    size_t cost;
+    /// neighbours in the recency list (LRU) or in the ring of used entries (CLOCK), or next free slot
+    u32 previous;
+    u32 next;
+    bool used;
+    /// second chance flag (CLOCK)
+    bool referenced;
+};
+
+/**
+ * @brief Cache header, followed in the same allocation by the entries, the hash index and the values.
+ * The index is an open-addressing table of (entry index + 1), 0 marking an empty cell.
+ */
+struct cache {
+    cache_config config;
+    size_t count;
+    size_t total_cost;
+
+    /// most and least recently used entries (LRU)
+    u32 head;
+    u32 tail;
+    /// next entry of the ring looked at by the clock hand, or CACHE_NO_ENTRY when the cache is empty (CLOCK)
+    u32 hand;
+    u32 free_list;
+
+    size_t index_mask;
+    struct cache_entry *entries;
+    u32 *index;
+    byte *values;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Finds the cell of the index holding a key.
+ *
+ * @param target
+ * @param key
+ * @param out_cell receives the cell of the key, or the empty cell where it would go
+ * @return u32 the entry of the key, or CACHE_NO_ENTRY
+ */
+static u32 cache_index_find(const cache *target, u64 key, size_t *out_cell);
+
+/**
+ * @brief Empties a cell of the index, shifting back the following cells of the same probe sequence.
+ *
+ * @param target
+ * @param cell
+ */
+static void cache_index_erase(cache *target, size_t cell);
+
+/**
+ * @brief Removes an entry from the recency list.
+ *
+ * @param target
+ * @param entry
+ */
+static void cache_list_unlink(cache *target, u32 entry);
+
+/**
+ * @brief Puts an entry at the front (most recent end) of the recency list.
+ *
+ * @param target
+ * @param entry
+ */
+static void cache_list_push_front(cache *target, u32 entry);
+
+/**
+ * @brief Puts an entry in the ring of used entries, just behind the clock hand : it is looked at last.
+ *
+ * @param target
+ * @param entry
+ */
+static void cache_ring_insert(cache *target, u32 entry);
+
+/**
+ * @brief Removes an entry from the ring of used entries, moving the clock hand past it.
+ *
+ * @param target
+ * @param entry
+ */
+static void cache_ring_unlink(cache *target, u32 entry);
+
+/**
+ * @brief Frees the slot of an entry.
+ *
+ * @param target
+ * @param entry
+ */
+static void cache_detach(cache *target, u32 entry);
+
+/**
+ * @brief Picks an entry according to the policy of the cache, hands it to the eviction callback and frees its slot.
+ *
+ * @param target
+ * @param spared entry that must not be evicted, or CACHE_NO_ENTRY
+ */
+static void cache_evict_one(cache *target, u32 spared);
+
+/**
+ * @brief Tells if a cache is over one of its bounds, once some more cost would be added.
+ *
+ * @param target
+ * @param added_entries
+ * @param added_cost
+ * @return bool
+ */
+static bool cache_is_over(const cache *target, size_t added_entries, size_t added_cost);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+cache *cache_create(allocator alloc, const cache_config *config)
+{
+    cache *new_cache = nullptr;
+    size_t index_size = 1;
+    size_t size_entries = 0;
+    size_t size_index = 0;
+
+    if (!config || (config->value_size == 0) || (config->max_entries == 0) || (config->max_entries >= CACHE_NO_ENTRY)) {
+        return nullptr;
+    }
+
+    // the index is kept at most half full, so probe sequences stay short
+    while (index_size < (config->max_entries * 2u)) {
+        index_size <<= 1u;
+    }
+
+    size_entries = config->max_entries * sizeof(struct cache_entry);
+    size_index = index_size * sizeof(u32);
+
+    new_cache = alloc.malloc(alloc, sizeof(*new_cache) + size_entries + size_index + (config->max_entries * config->value_size));
+    if (!new_cache) {
+        return nullptr;
+    }
+
+    *new_cache = (cache) {
+            .config = *config,
+            .count = 0,
+            .total_cost = 0,
+            .head = CACHE_NO_ENTRY,
+            .tail = CACHE_NO_ENTRY,
+            .hand = CACHE_NO_ENTRY,
+            .free_list = 0,
+            .index_mask = index_size - 1u,
+            .entries = (struct cache_entry *) (new_cache + 1),
+    };
+    new_cache->index = (u32 *) ((byte *) new_cache->entries + size_entries);
+    new_cache->values = (byte *) new_cache->index + size_index;
+
+    for (size_t i = 0 ; i < config->max_entries ; i++) {
+        new_cache->entries[i] = (struct cache_entry) {
+                .previous = CACHE_NO_ENTRY,
+                .next = (i + 1 < config->max_entries) ? (u32) (i + 1) : CACHE_NO_ENTRY,
+        };
+    }
+    for (size_t i = 0 ; i < index_size ; i++) {
+        new_cache->index[i] = 0;
+    }
+
+    return new_cache;
+}
+
+// -----------------------------------------------------------------------------
+
+void cache_destroy(allocator alloc, cache **target)
+{
+    if (!target || !*target) {
+        return;
+    }
+
+    alloc.free(alloc, *target);
+    *target = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void *cache_get(cache *target, u64 key)
+{
+    size_t cell = 0;
+    u32 entry = 0;
+
+    if (!target) {
+        return nullptr;
+    }
+
+    entry = cache_index_find(target, key, &cell);
+    if (entry == CACHE_NO_ENTRY) {
+        return nullptr;
+    }
+
+    if (target->config.policy == CACHE_POLICY_LRU) {
+        cache_list_unlink(target, entry);
+        cache_list_push_front(target, entry);
+    } else {
+        target->entries[entry].referenced = true;
+    }
+
+    return target->values + ((size_t) entry * target->config.value_size);
+}
+
+// -----------------------------------------------------------------------------
+
+void *cache_put(cache *target, u64 key, const void *value, size_t cost)
+{
+    size_t cell = 0;
+    u32 entry = 0;
+
+    if (!target || !value || ((target->config.max_cost != 0) && (cost > target->config.max_cost))) {
+        return nullptr;
+    }
+
+    entry = cache_index_find(target, key, &cell);
+
+    if (entry != CACHE_NO_ENTRY) {
+        // replaced in place : only the cost can push other entries out
+        target->total_cost = target->total_cost - target->entries[entry].cost + cost;
+        target->entries[entry].cost = cost;
+        cache_get(target, key);
+
+        while (cache_is_over(target, 0, 0)) {
+            cache_evict_one(target, entry);
+        }
+    } else {
+        while ((target->count > 0) && cache_is_over(target, 1, cost)) {
+            cache_evict_one(target, CACHE_NO_ENTRY);
+        }
+
+        // evictions may have shifted the cells of the index
+        cache_index_find(target, key, &cell);
+
+        entry = target->free_list;
+        target->free_list = target->entries[entry].next;
+
+        target->entries[entry] = (struct cache_entry) {
+                .key = key,
+                .cost = cost,
+                .previous = CACHE_NO_ENTRY,
+                .next = CACHE_NO_ENTRY,
+                .used = true,
+                // entries only get a second chance once they are used again
+                .referenced = false,
+        };
+        target->index[cell] = entry + 1u;
+        target->count += 1;
+        target->total_cost += cost;
+
+        if (target->config.policy == CACHE_POLICY_LRU) {
+            cache_list_push_front(target, entry);
+        } else {
+            cache_ring_insert(target, entry);
+        }
+    }
+
+    bytewise_copy(target->values + ((size_t) entry * target->config.value_size), value, target->config.value_size);
+
+    return target->values + ((size_t) entry * target->config.value_size);
+}
+
+// -----------------------------------------------------------------------------
+
+bool cache_remove(cache *target, u64 key, void *out_value)
+{
+    size_t cell = 0;
+    u32 entry = 0;
+
+    if (!target) {
+        return false;
+    }
+
+    entry = cache_index_find(target, key, &cell);
+    if (entry == CACHE_NO_ENTRY) {
+        return false;
+    }
+
+    if (out_value) {
+        bytewise_copy(out_value, target->values + ((size_t) entry * target->config.value_size), target->config.value_size);
+    }
+    cache_detach(target, entry);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void cache_clear(cache *target)
+{
+    if (!target) {
+        return;
+    }
+
+    while (target->count > 0) {
+        cache_evict_one(target, CACHE_NO_ENTRY);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+size_t cache_count(const cache *target)
+{
+    if (!target) {
+        return 0;
+    }
+
+    return target->count;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t cache_cost(const cache *target)
+{
+    if (!target) {
+        return 0;
+    }
+
+    return target->total_cost;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static u32 cache_index_find(const cache *target, u64 key, size_t *out_cell)
+{
+    size_t cell = hash_integer(key, 0) & target->index_mask;
+
+    while (target->index[cell] != 0) {
+        if (target->entries[target->index[cell] - 1u].key == key) {
+            *out_cell = cell;
+            return target->index[cell] - 1u;
+        }
+        cell = (cell + 1u) & target->index_mask;
+    }
+
+    *out_cell = cell;
+
+    return CACHE_NO_ENTRY;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cache_index_erase(cache *target, size_t cell)
+{
+    size_t next = cell;
+    size_t home = 0;
+
+    for (;;) {
+        next = (next + 1u) & target->index_mask;
+        if (target->index[next] == 0) {
+            break;
+        }
+
+        // the following cell moves back if the erased one is on the way from its home cell to it
+        home = hash_integer(target->entries[target->index[next] - 1u].key, 0) & target->index_mask;
+        if (((next - home) & target->index_mask) >= ((next - cell) & target->index_mask)) {
+            target->index[cell] = target->index[next];
+            cell = next;
+        }
+    }
+
+    target->index[cell] = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cache_list_unlink(cache *target, u32 entry)
+{
+    struct cache_entry *unlinked = target->entries + entry;
+
+    if (unlinked->previous != CACHE_NO_ENTRY) {
+        target->entries[unlinked->previous].next = unlinked->next;
+    } else {
+        target->head = unlinked->next;
+    }
+
+    if (unlinked->next != CACHE_NO_ENTRY) {
+        target->entries[unlinked->next].previous = unlinked->previous;
+    } else {
+        target->tail = unlinked->previous;
+    }
+
+    unlinked->previous = CACHE_NO_ENTRY;
+    unlinked->next = CACHE_NO_ENTRY;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cache_list_push_front(cache *target, u32 entry)
+{
+    target->entries[entry].previous = CACHE_NO_ENTRY;
+    target->entries[entry].next = target->head;
+
+    if (target->head != CACHE_NO_ENTRY) {
+        target->entries[target->head].previous = entry;
+    } else {
+        target->tail = entry;
+    }
+
+    target->head = entry;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cache_ring_insert(cache *target, u32 entry)
+{
+    u32 behind = CACHE_NO_ENTRY;
+
+    if (target->hand == CACHE_NO_ENTRY) {
+        target->entries[entry].previous = entry;
+        target->entries[entry].next = entry;
+        target->hand = entry;
+        return;
+    }
+
+    behind = target->entries[target->hand].previous;
+    target->entries[entry].previous = behind;
+    target->entries[entry].next = target->hand;
+    target->entries[behind].next = entry;
+    target->entries[target->hand].previous = entry;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cache_ring_unlink(cache *target, u32 entry)
+{
+    struct cache_entry *unlinked = target->entries + entry;
+
+    if (unlinked->next == entry) {
+        target->hand = CACHE_NO_ENTRY;
+    } else {
+        target->entries[unlinked->previous].next = unlinked->next;
+        target->entries[unlinked->next].previous = unlinked->previous;
+        if (target->hand == entry) {
+            target->hand = unlinked->next;
+        }
+    }
+
+    unlinked->previous = CACHE_NO_ENTRY;
+    unlinked->next = CACHE_NO_ENTRY;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cache_detach(cache *target, u32 entry)
+{
+    size_t cell = 0;
+
+    cache_index_find(target, target->entries[entry].key, &cell);
+    cache_index_erase(target, cell);
+
+    if (target->config.policy == CACHE_POLICY_LRU) {
+        cache_list_unlink(target, entry);
+    } else {
+        cache_ring_unlink(target, entry);
+    }
+
+    target->count -= 1;
+    target->total_cost -= target->entries[entry].cost;
+
+    target->entries[entry].used = false;
+    target->entries[entry].next = target->free_list;
+    target->free_list = entry;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cache_evict_one(cache *target, u32 spared)
+{
+    u32 evicted = CACHE_NO_ENTRY;
+    struct cache_entry *candidate = nullptr;
+
+    if (target->config.policy == CACHE_POLICY_LRU) {
+        evicted = target->tail;
+        if (evicted == spared) {
+            evicted = target->entries[evicted].previous;
+        }
+    } else {
+        // the ring only holds used entries : at most two turns of them, the first one clearing all flags
+        for (size_t i = 0 ; (evicted == CACHE_NO_ENTRY) && (target->hand != CACHE_NO_ENTRY) && (i <= 2 * target->count) ; i++) {
+            candidate = target->entries + target->hand;
+            if (target->hand != spared) {
+                if (candidate->referenced) {
+                    candidate->referenced = false;
+                } else {
+                    evicted = target->hand;
+                }
+            }
+            target->hand = candidate->next;
+        }
+    }
+
+    if (evicted == CACHE_NO_ENTRY) {
+        return;
+    }
+
+    if (target->config.on_evict) {
+        target->config.on_evict(target->entries[evicted].key,
+                target->values + ((size_t) evicted * target->config.value_size), target->config.context);
+    }
+
+    cache_detach(target, evicted);
+}
+
+// -----------------------------------------------------------------------------
+
+static bool cache_is_over(const cache *target, size_t added_entries, size_t added_cost)
+{
+    return (target->count + added_entries > target->config.max_entries)
+            || ((target->config.max_cost != 0) && (target->total_cost + added_cost > target->config.max_cost));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+/**
+ * @brief Records the evicted keys of a test cache.
+ */
+struct test_cache_evictions {
+    u64 keys[64];
+    size_t nb_evicted;
+};
+
+static void test_cache_on_evict(u64 key, void *value, void *context)
+{
+    struct test_cache_evictions *evictions = (struct test_cache_evictions *) context;
+
+    (void) value;
+    if (evictions->nb_evicted < COUNT_OF(evictions->keys)) {
+        evictions->keys[evictions->nb_evicted] = key;
+    }
+    evictions->nb_evicted += 1;
+}
+
+tst_CREATE_TEST_SCENARIO(cache_eviction_order,
+        {
+            cache_policy policy;
+            u64 expected_evicted[2];
+        },
+        {
+            struct test_cache_evictions evictions = { 0 };
+            cache_config config = { 0 };
+            cache *target = nullptr;
+            u32 value = 0;
+
+            config.policy = data->policy;
+            config.value_size = sizeof(u32);
+            config.max_entries = 3;
+            config.on_evict = &test_cache_on_evict;
+            config.context = &evictions;
+            target = cache_create(make_system_allocator(), &config);
+            tst_assert(target, "creation failed");
+
+            // 1, 2 and 3 fill the cache ; 1 is used again, then 4 and 5 push two entries out
+            for (u32 key = 1 ; key <= 3 ; key++) {
+                value = key * 10;
+                cache_put(target, key, &value, 1);
+            }
+            tst_assert(cache_get(target, 1) && (*(u32 *) cache_get(target, 1) == 10), "first key lost");
+
+            value = 40;
+            cache_put(target, 4, &value, 1);
+            value = 50;
+            cache_put(target, 5, &value, 1);
+
+            tst_assert_equal(3, cache_count(target), "count of %ld");
+            tst_assert_equal(2, evictions.nb_evicted, "%ld evictions");
+            tst_assert_equal(data->expected_evicted[0], evictions.keys[0], "first eviction of %ld");
+            tst_assert_equal(data->expected_evicted[1], evictions.keys[1], "second eviction of %ld");
+            tst_assert(cache_get(target, 1), "recently used key evicted");
+            tst_assert(!cache_get(target, data->expected_evicted[0]), "evicted key still there");
+
+            tst_assert(cache_remove(target, 5, &value), "remove failed");
+            tst_assert_equal(50, value, "removed value of %d");
+            tst_assert_equal(2, evictions.nb_evicted, "%ld evictions after a removal");
+
+            cache_clear(target);
+            tst_assert_equal(0, cache_count(target), "count after clear of %ld");
+            tst_assert_equal(4, evictions.nb_evicted, "%ld evictions after a clear");
+
+            cache_destroy(make_system_allocator(), &target);
+            tst_assert(!target, "cache not reset");
+        }
+)
+
+tst_CREATE_TEST_CASE(cache_eviction_order_lru, cache_eviction_order,
+        .policy = CACHE_POLICY_LRU,
+        .expected_evicted = { 2, 3 },
+)
+tst_CREATE_TEST_CASE(cache_eviction_order_clock, cache_eviction_order,
+        .policy = CACHE_POLICY_CLOCK,
+        .expected_evicted = { 2, 3 },
+)
+
+tst_CREATE_TEST_SCENARIO(cache_bounds,
+        {
+            cache_policy policy;
+            size_t max_entries;
+            size_t max_cost;
+            u32 nb_puts;
+        },
+        {
+            cache_config config = { 0 };
+            cache *target = nullptr;
+            bool within_bounds = true;
+            bool last_ones_found = true;
+            u64 value = 0;
+
+            config.policy = data->policy;
+            config.value_size = sizeof(u64);
+            config.max_entries = data->max_entries;
+            config.max_cost = data->max_cost;
+            target = cache_create(make_system_allocator(), &config);
+
+            for (u32 i = 0 ; i < data->nb_puts ; i++) {
+                value = (u64) i * 7u;
+                tst_assert(cache_put(target, (u64) i * 2654435761u, &value, 1u + (i % 4)), "put %d failed", i);
+                within_bounds = within_bounds && (cache_count(target) <= data->max_entries)
+                        && ((data->max_cost == 0) || (cache_cost(target) <= data->max_cost));
+                // regularly read a few old keys, so some survive
+                if ((i % 16) == 0) {
+                    cache_get(target, (u64) (i / 2) * 2654435761u);
+                }
+            }
+            tst_assert(within_bounds, "cache went over its bounds");
+
+            // the last entry is always there
+            value = 0;
+            last_ones_found = cache_get(target, (u64) (data->nb_puts - 1) * 2654435761u)
+                    && (*(u64 *) cache_get(target, (u64) (data->nb_puts - 1) * 2654435761u) == (u64) (data->nb_puts - 1) * 7u);
+            tst_assert(last_ones_found, "last put lost");
+
+            tst_assert(!cache_put(target, 0, &value, data->max_cost + 1) || (data->max_cost == 0), "put over the maximum cost");
+
+            cache_destroy(make_system_allocator(), &target);
+        }
+)
+
+tst_CREATE_TEST_CASE(cache_bounds_lru_entries, cache_bounds,
+        .policy = CACHE_POLICY_LRU,
+        .max_entries = 100,
+        .max_cost = 0,
+        .nb_puts = 10000,
+)
+tst_CREATE_TEST_CASE(cache_bounds_clock_entries, cache_bounds,
+        .policy = CACHE_POLICY_CLOCK,
+        .max_entries = 100,
+        .max_cost = 0,
+        .nb_puts = 10000,
+)
+tst_CREATE_TEST_CASE(cache_bounds_lru_cost, cache_bounds,
+        .policy = CACHE_POLICY_LRU,
+        .max_entries = 1000,
+        .max_cost = 150,
+        .nb_puts = 10000,
+)
+tst_CREATE_TEST_CASE(cache_bounds_clock_cost, cache_bounds,
+        .policy = CACHE_POLICY_CLOCK,
+        .max_entries = 1000,
+        .max_cost = 150,
+        .nb_puts = 10000,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void cache_execute_unittests(void)
+{
+    tst_run_test_case(cache_eviction_order_lru);
+    tst_run_test_case(cache_eviction_order_clock);
+    tst_run_test_case(cache_bounds_lru_entries);
+    tst_run_test_case(cache_bounds_clock_entries);
+    tst_run_test_case(cache_bounds_lru_cost);
+    tst_run_test_case(cache_bounds_clock_cost);
+}
+
+#endif
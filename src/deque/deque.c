@@ -0,0 +1,540 @@
+
+#include <ustd/deque.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Ring buffer header. The fields after `head` mirror the header of an array.
+ */
+struct deque_impl {
+    size_t head;
+
+    size_t length;
+    size_t capacity;
+    u32 stride;
+    byte data[];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Translates a position from the front of the deque to a position in its buffer.
+ *
+ * @param target deque
+ * @param index position from the first element, lesser than the capacity
+ * @return size_t position in the buffer
+ */
+static size_t deque_wrap(const struct deque_impl *target, size_t index);
+
+/**
+ * @brief Copies elements from contiguous memory into the buffer, starting at some position from the
+ * front. At most two copies are made, one for each side of the wrap.
+ *
+ * @param target deque
+ * @param index position from the first element
+ * @param memory copied elements
+ * @param nb_elements number of copied elements
+ */
+static void deque_copy_in(struct deque_impl *target, size_t index, const byte *memory, size_t nb_elements);
+
+/**
+ * @brief Copies elements from the buffer to contiguous memory, starting at some position from the
+ * front. At most two copies are made, one for each side of the wrap.
+ *
+ * @param target deque
+ * @param index position from the first element
+ * @param memory destination of the elements
+ * @param nb_elements number of copied elements
+ */
+static void deque_copy_out(const struct deque_impl *target, size_t index, byte *memory, size_t nb_elements);
+
+/**
+ * @brief
+ *
+ * @param deque
+ * @return struct deque_impl*
+ */
+static struct deque_impl *deque_impl_of(DEQUE_ANY deque);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+DEQUE_ANY deque_create(allocator alloc, u32 size_element, size_t nb_elements_max)
+{
+    struct deque_impl *new_deque = nullptr;
+
+    if ((size_element == 0) || (nb_elements_max == 0)) {
+        return nullptr;
+    }
+
+    new_deque = alloc.malloc(alloc, sizeof(*new_deque) + (size_element * nb_elements_max));
+
+    if (!new_deque) {
+        return nullptr;
+    }
+
+    *new_deque = (struct deque_impl) {
+            .head = 0,
+            .length = 0,
+            .capacity = nb_elements_max,
+            .stride = size_element,
+    };
+
+    return &(new_deque->data);
+}
+
+// -----------------------------------------------------------------------------
+
+DEQUE_ANY deque_create_in(byte *mem, size_t length, u32 size_element)
+{
+    struct deque_impl *new_deque = (struct deque_impl *) mem;
+
+    if (!mem || (size_element == 0) || (length < (sizeof(*new_deque) + size_element))) {
+        return nullptr;
+    }
+
+    *new_deque = (struct deque_impl) {
+            .head = 0,
+            .length = 0,
+            .capacity = (length - sizeof(*new_deque)) / size_element,
+            .stride = size_element,
+    };
+
+    return &(new_deque->data);
+}
+
+// -----------------------------------------------------------------------------
+
+void deque_destroy(allocator alloc, DEQUE_ANY *deque)
+{
+    if (!deque || !*deque) {
+        return;
+    }
+
+    alloc.free(alloc, deque_impl_of(*deque));
+    *deque = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void deque_ensure_capacity(allocator alloc, DEQUE_ANY *deque, size_t additional_capacity)
+{
+    struct deque_impl *target = nullptr;
+    size_t needed_size = 0;
+
+    DEQUE_ANY new_deque = nullptr;
+
+    if (!deque || !*deque || (additional_capacity == 0)) {
+        return;
+    }
+
+    target = deque_impl_of(*deque);
+    needed_size = target->length + additional_capacity;
+
+    if (needed_size <= target->capacity) {
+        return;
+    }
+
+    new_deque = deque_create(alloc, target->stride, needed_size * 2u);
+    if (!new_deque) {
+        return;
+    }
+
+    deque_copy_out(target, 0, new_deque, target->length);
+    deque_impl_of(new_deque)->length = target->length;
+
+    deque_destroy(alloc, deque);
+    *deque = new_deque;
+}
+
+// -----------------------------------------------------------------------------
+
+bool deque_push_back(DEQUE_ANY deque, const void *value)
+{
+    return deque_push_back_mem(deque, value, 1);
+}
+
+// -----------------------------------------------------------------------------
+
+bool deque_push_front(DEQUE_ANY deque, const void *value)
+{
+    struct deque_impl *target = nullptr;
+
+    if (!deque || !value) {
+        return false;
+    }
+
+    target = deque_impl_of(deque);
+
+    if (target->length >= target->capacity) {
+        return false;
+    }
+
+    target->head = deque_wrap(target, target->capacity - 1);
+    target->length += 1;
+    deque_copy_in(target, 0, value, 1);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool deque_pop_back(DEQUE_ANY deque, void *out_value)
+{
+    struct deque_impl *target = nullptr;
+
+    if (!deque) {
+        return false;
+    }
+
+    target = deque_impl_of(deque);
+
+    if (target->length == 0) {
+        return false;
+    }
+
+    if (out_value) {
+        deque_copy_out(target, target->length - 1, out_value, 1);
+    }
+    target->length -= 1;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool deque_pop_front(DEQUE_ANY deque, void *out_value)
+{
+    return (deque_pop_front_mem(deque, out_value, 1) == 1);
+}
+
+// -----------------------------------------------------------------------------
+
+bool deque_push_back_mem(DEQUE_ANY deque, const void *memory, size_t nb_elements)
+{
+    struct deque_impl *target = nullptr;
+
+    if (!deque || !memory || !nb_elements) {
+        return false;
+    }
+
+    target = deque_impl_of(deque);
+
+    if ((target->length + nb_elements) > target->capacity) {
+        return false;
+    }
+
+    deque_copy_in(target, target->length, memory, nb_elements);
+    target->length += nb_elements;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t deque_pop_front_mem(DEQUE_ANY deque, void *out_memory, size_t nb_elements)
+{
+    struct deque_impl *target = nullptr;
+
+    if (!deque) {
+        return 0;
+    }
+
+    target = deque_impl_of(deque);
+    nb_elements = MIN(nb_elements, target->length);
+
+    if (nb_elements == 0) {
+        return 0;
+    }
+
+    if (out_memory) {
+        deque_copy_out(target, 0, out_memory, nb_elements);
+    }
+
+    target->head = deque_wrap(target, nb_elements % target->capacity);
+    target->length -= nb_elements;
+
+    return nb_elements;
+}
+
+// -----------------------------------------------------------------------------
+
+bool deque_get(DEQUE_ANY deque, size_t index, void *out_value)
+{
+    struct deque_impl *target = nullptr;
+
+    if (!deque) {
+        return false;
+    }
+
+    target = deque_impl_of(deque);
+
+    if (index >= target->length) {
+        return false;
+    }
+
+    if (out_value) {
+        deque_copy_out(target, index, out_value, 1);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void *deque_at(DEQUE_ANY deque, size_t index)
+{
+    struct deque_impl *target = nullptr;
+
+    if (!deque) {
+        return nullptr;
+    }
+
+    target = deque_impl_of(deque);
+
+    if (index >= target->length) {
+        return nullptr;
+    }
+
+    return target->data + (deque_wrap(target, index) * target->stride);
+}
+
+// -----------------------------------------------------------------------------
+
+void deque_clear(DEQUE_ANY deque)
+{
+    struct deque_impl *target = nullptr;
+
+    if (!deque) {
+        return;
+    }
+
+    target = deque_impl_of(deque);
+    target->head = 0;
+    target->length = 0;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static size_t deque_wrap(const struct deque_impl *target, size_t index)
+{
+    size_t position = target->head + index;
+
+    if (position >= target->capacity) {
+        position -= target->capacity;
+    }
+
+    return position;
+}
+
+// -----------------------------------------------------------------------------
+
+static void deque_copy_in(struct deque_impl *target, size_t index, const byte *memory, size_t nb_elements)
+{
+    size_t start = deque_wrap(target, index);
+    size_t first_segment = MIN(nb_elements, target->capacity - start);
+
+    bytewise_copy(target->data + (start * target->stride), memory, first_segment * target->stride);
+    bytewise_copy(target->data, memory + (first_segment * target->stride),
+            (nb_elements - first_segment) * target->stride);
+}
+
+// -----------------------------------------------------------------------------
+
+static void deque_copy_out(const struct deque_impl *target, size_t index, byte *memory, size_t nb_elements)
+{
+    size_t start = deque_wrap(target, index);
+    size_t first_segment = MIN(nb_elements, target->capacity - start);
+
+    bytewise_copy(memory, target->data + (start * target->stride), first_segment * target->stride);
+    bytewise_copy(memory + (first_segment * target->stride), target->data,
+            (nb_elements - first_segment) * target->stride);
+}
+
+// -----------------------------------------------------------------------------
+
+static struct deque_impl *deque_impl_of(DEQUE_ANY deque)
+{
+    return CONTAINER_OF(deque, struct deque_impl, data);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(deque_fifo,
+        {
+            size_t capacity;
+            size_t nb_rounds;
+            size_t nb_per_round;
+        },
+        {
+            _Alignas(size_t) byte mem[sizeof(struct deque_impl) + (64 * sizeof(u32))] = { 0 };
+            DEQUE(u32) deque = deque_create_in(mem, sizeof(struct deque_impl) + (data->capacity * sizeof(u32)), sizeof(u32));
+            u32 next_in = 0;
+            u32 next_out = 0;
+            u32 value = 0;
+
+            tst_assert_equal(data->capacity, deque_capacity(deque), "capacity of %ld");
+
+            for (size_t round = 0 ; round < data->nb_rounds ; round++) {
+                for (size_t i = 0 ; i < data->nb_per_round ; i++) {
+                    tst_assert(deque_push_back(deque, &next_in), "push %d failed", next_in);
+                    next_in += 1;
+                }
+                tst_assert_equal(data->nb_per_round, deque_length(deque), "length of %ld");
+
+                for (size_t i = 0 ; i < data->nb_per_round ; i++) {
+                    tst_assert(deque_get(deque, i, &value), "get %ld failed", i);
+                    tst_assert_equal_ext(next_out + (u32) i, value, "%d", "at index %ld", i);
+                }
+
+                for (size_t i = 0 ; i < data->nb_per_round ; i++) {
+                    tst_assert(deque_pop_front(deque, &value), "pop failed");
+                    tst_assert_equal(next_out, value, "popped %d");
+                    next_out += 1;
+                }
+            }
+
+            tst_assert(!deque_pop_front(deque, &value), "pop on empty deque succeeded");
+        }
+)
+
+tst_CREATE_TEST_CASE(deque_fifo_no_wrap, deque_fifo,
+        .capacity = 8,
+        .nb_rounds = 1,
+        .nb_per_round = 8,
+)
+tst_CREATE_TEST_CASE(deque_fifo_wrapping, deque_fifo,
+        .capacity = 7,
+        .nb_rounds = 10,
+        .nb_per_round = 5,
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(deque_both_ends,
+        {
+            u32 *pushed_front;
+            size_t nb_front;
+            u32 *pushed_back;
+            size_t nb_back;
+
+            u32 *expected;
+        },
+        {
+            DEQUE(u32) deque = deque_create(make_system_allocator(), sizeof(*deque), 2);
+            u32 value = 0;
+            size_t length = data->nb_front + data->nb_back;
+
+            for (size_t i = 0 ; i < data->nb_front ; i++) {
+                deque_ensure_capacity(make_system_allocator(), (DEQUE_ANY *) &deque, 1);
+                tst_assert(deque_push_front(deque, data->pushed_front + i), "push front %ld failed", i);
+            }
+            for (size_t i = 0 ; i < data->nb_back ; i++) {
+                deque_ensure_capacity(make_system_allocator(), (DEQUE_ANY *) &deque, 1);
+                tst_assert(deque_push_back(deque, data->pushed_back + i), "push back %ld failed", i);
+            }
+
+            tst_assert_equal(length, deque_length(deque), "length of %ld");
+            for (size_t i = 0 ; i < length ; i++) {
+                tst_assert_equal_ext(data->expected[i], *(u32 *) deque_at(deque, i), "%d", "at index %ld", i);
+            }
+
+            tst_assert(deque_pop_back(deque, &value), "pop back failed");
+            tst_assert_equal(data->expected[length - 1], value, "popped %d");
+            tst_assert(deque_pop_front(deque, &value), "pop front failed");
+            tst_assert_equal(data->expected[0], value, "popped %d");
+
+            deque_destroy(make_system_allocator(), (DEQUE_ANY *) &deque);
+        }
+)
+
+tst_CREATE_TEST_CASE(deque_both_ends_nominal, deque_both_ends,
+        .pushed_front = (u32[]) { 3, 2, 1 },
+        .nb_front = 3,
+        .pushed_back = (u32[]) { 4, 5, 6, 7 },
+        .nb_back = 4,
+        .expected = (u32[]) { 1, 2, 3, 4, 5, 6, 7 },
+)
+tst_CREATE_TEST_CASE(deque_both_ends_front_only, deque_both_ends,
+        .pushed_front = (u32[]) { 5, 4, 3, 2, 1 },
+        .nb_front = 5,
+        .nb_back = 0,
+        .expected = (u32[]) { 1, 2, 3, 4, 5 },
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(deque_bulk,
+        {
+            size_t capacity;
+            size_t head;
+            size_t nb_elements;
+            bool expect_success;
+        },
+        {
+            DEQUE(u32) deque = deque_create(make_system_allocator(), sizeof(*deque), data->capacity);
+            u32 in[32] = { 0 };
+            u32 out[32] = { 0 };
+
+            for (u32 i = 0 ; i < 32 ; i++) {
+                in[i] = i + 100;
+            }
+
+            deque_impl_of(deque)->head = data->head;
+
+            tst_assert_equal(data->expect_success, deque_push_back_mem(deque, in, data->nb_elements), "push success of %d");
+            if (data->expect_success) {
+                tst_assert_equal(data->nb_elements, deque_pop_front_mem(deque, out, 32), "popped %ld");
+                tst_assert_memory_equal(in, out, data->nb_elements * sizeof(*in), "popped values differ");
+            }
+            tst_assert_equal(0lu, deque_length(deque), "length of %ld");
+
+            deque_destroy(make_system_allocator(), (DEQUE_ANY *) &deque);
+        }
+)
+
+tst_CREATE_TEST_CASE(deque_bulk_contiguous, deque_bulk,
+        .capacity = 16,
+        .head = 0,
+        .nb_elements = 10,
+        .expect_success = true,
+)
+tst_CREATE_TEST_CASE(deque_bulk_wrapped, deque_bulk,
+        .capacity = 16,
+        .head = 12,
+        .nb_elements = 16,
+        .expect_success = true,
+)
+tst_CREATE_TEST_CASE(deque_bulk_too_much, deque_bulk,
+        .capacity = 16,
+        .head = 12,
+        .nb_elements = 17,
+        .expect_success = false,
+)
+
+// -----------------------------------------------------------------------------
+
+void deque_execute_unittests(void)
+{
+    tst_run_test_case(deque_fifo_no_wrap);
+    tst_run_test_case(deque_fifo_wrapping);
+
+    tst_run_test_case(deque_both_ends_nominal);
+    tst_run_test_case(deque_both_ends_front_only);
+
+    tst_run_test_case(deque_bulk_contiguous);
+    tst_run_test_case(deque_bulk_wrapped);
+    tst_run_test_case(deque_bulk_too_much);
+}
+
+#endif
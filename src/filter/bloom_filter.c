@@ -0,0 +1,366 @@
+
+#include <math.h>
+
+#include <ustd/filter.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Number of 64-bit words in a block.
+#define BLOOM_FILTER_BLOCK_WORDS (BLOOM_FILTER_BLOCK_SIZE / sizeof(u64))
+/// Maximum number of bits set for each hash.
+#define BLOOM_FILTER_MAX_PROBES (16u)
+/// Natural logarithm of 2 (M_LN2 is not standard C).
+#define BLOOM_FILTER_LN2 (0.69314718055994530942)
+/// First bytes of a serialized bloom filter.
+#define BLOOM_FILTER_MAGIC (0x4d4f4f4cu)
+
+/**
+ * @brief Bloom filter header, followed in the same allocation by the (aligned) blocks.
+ */
+struct bloom_filter {
+    u64 *blocks;
+    u64 nb_blocks;
+    u32 nb_probes;
+};
+
+/**
+ * @brief Header of a serialized bloom filter, followed by its blocks.
+ */
+struct bloom_filter_header {
+    u32 magic;
+    u32 nb_probes;
+    u64 nb_blocks;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Allocates a cleared filter of some number of blocks.
+ *
+ * @param alloc
+ * @param nb_blocks
+ * @param nb_probes
+ * @return bloom_filter*
+ */
+static bloom_filter *bloom_filter_allocate(allocator alloc, u64 nb_blocks, u32 nb_probes);
+
+/**
+ * @brief Expected false positive rate of a blocked filter. Blocks do not get the same number of hashes,
+ * and the most loaded ones answer wrongly more often than a classic filter of the same size would.
+ *
+ * @param nb_elements
+ * @param nb_blocks
+ * @param nb_probes
+ * @return f64
+ */
+static f64 bloom_filter_expected_rate(size_t nb_elements, u64 nb_blocks, u32 nb_probes);
+
+/**
+ * @brief Computes the block of a hash, and the bits it sets in that block.
+ *
+ * @param filter
+ * @param hash
+ * @param out_mask receives the BLOOM_FILTER_BLOCK_WORDS words of bits
+ * @return u64* the block of the hash
+ */
+static u64 *bloom_filter_probe(const bloom_filter *filter, u64 hash, u64 *out_mask);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+bloom_filter *bloom_filter_create(allocator alloc, size_t nb_elements, f64 false_positive_rate)
+{
+    f64 nb_bits = 0.;
+    u32 nb_probes = 0;
+    u64 nb_blocks = 0;
+
+    if ((nb_elements == 0) || !(false_positive_rate > 0.) || !(false_positive_rate < 1.)) {
+        return nullptr;
+    }
+
+    // size of a classic filter, then grown until the blocks are lightly loaded enough
+    nb_bits = ceil(-(f64) nb_elements * log(false_positive_rate) / (BLOOM_FILTER_LN2 * BLOOM_FILTER_LN2));
+    nb_probes = (u32) MIN(MAX(round((nb_bits / (f64) nb_elements) * BLOOM_FILTER_LN2), 1.), (f64) BLOOM_FILTER_MAX_PROBES);
+    nb_blocks = MAX((u64) ceil(nb_bits / (BLOOM_FILTER_BLOCK_SIZE * 8.)), 1u);
+
+    while (bloom_filter_expected_rate(nb_elements, nb_blocks, nb_probes) > false_positive_rate) {
+        nb_blocks += MAX(nb_blocks / 32u, 1u);
+    }
+
+    return bloom_filter_allocate(alloc, nb_blocks, nb_probes);
+}
+
+// -----------------------------------------------------------------------------
+
+void bloom_filter_destroy(allocator alloc, bloom_filter **filter)
+{
+    if (!filter || !*filter) {
+        return;
+    }
+
+    alloc.free(alloc, *filter);
+    *filter = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void bloom_filter_insert(bloom_filter *filter, u64 hash)
+{
+    u64 mask[BLOOM_FILTER_BLOCK_WORDS] = { 0 };
+    u64 *block = nullptr;
+
+    if (!filter) {
+        return;
+    }
+
+    block = bloom_filter_probe(filter, hash, mask);
+    for (size_t i = 0 ; i < BLOOM_FILTER_BLOCK_WORDS ; i++) {
+        block[i] |= mask[i];
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool bloom_filter_may_contain(const bloom_filter *filter, u64 hash)
+{
+    u64 mask[BLOOM_FILTER_BLOCK_WORDS] = { 0 };
+    u64 missing = 0;
+    const u64 *block = nullptr;
+
+    if (!filter) {
+        return false;
+    }
+
+    // no early exit : the whole line is checked in a branchless loop
+    block = bloom_filter_probe(filter, hash, mask);
+    for (size_t i = 0 ; i < BLOOM_FILTER_BLOCK_WORDS ; i++) {
+        missing |= mask[i] & ~block[i];
+    }
+
+    return missing == 0;
+}
+
+// -----------------------------------------------------------------------------
+
+void bloom_filter_clear(bloom_filter *filter)
+{
+    if (!filter) {
+        return;
+    }
+
+    for (size_t i = 0 ; i < filter->nb_blocks * BLOOM_FILTER_BLOCK_WORDS ; i++) {
+        filter->blocks[i] = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+size_t bloom_filter_serialize(const bloom_filter *filter, byte *out_buffer, size_t buffer_size)
+{
+    struct bloom_filter_header header = { 0 };
+    size_t needed_size = 0;
+
+    if (!filter) {
+        return 0;
+    }
+
+    needed_size = sizeof(header) + (filter->nb_blocks * BLOOM_FILTER_BLOCK_SIZE);
+    if (!out_buffer || (buffer_size < needed_size)) {
+        return needed_size;
+    }
+
+    header = (struct bloom_filter_header) {
+            .magic = BLOOM_FILTER_MAGIC,
+            .nb_probes = filter->nb_probes,
+            .nb_blocks = filter->nb_blocks,
+    };
+
+    bytewise_copy(out_buffer, &header, sizeof(header));
+    bytewise_copy(out_buffer + sizeof(header), filter->blocks, filter->nb_blocks * BLOOM_FILTER_BLOCK_SIZE);
+
+    return needed_size;
+}
+
+// -----------------------------------------------------------------------------
+
+bloom_filter *bloom_filter_deserialize(allocator alloc, const byte *buffer, size_t buffer_size)
+{
+    struct bloom_filter_header header = { 0 };
+    bloom_filter *new_filter = nullptr;
+
+    if (!buffer || (buffer_size < sizeof(header))) {
+        return nullptr;
+    }
+
+    bytewise_copy(&header, buffer, sizeof(header));
+    if ((header.magic != BLOOM_FILTER_MAGIC)
+            || (header.nb_probes == 0) || (header.nb_probes > BLOOM_FILTER_MAX_PROBES)
+            || (header.nb_blocks == 0) || (header.nb_blocks > ((buffer_size - sizeof(header)) / BLOOM_FILTER_BLOCK_SIZE))) {
+        return nullptr;
+    }
+
+    new_filter = bloom_filter_allocate(alloc, header.nb_blocks, header.nb_probes);
+    if (!new_filter) {
+        return nullptr;
+    }
+
+    bytewise_copy(new_filter->blocks, buffer + sizeof(header), header.nb_blocks * BLOOM_FILTER_BLOCK_SIZE);
+
+    return new_filter;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static bloom_filter *bloom_filter_allocate(allocator alloc, u64 nb_blocks, u32 nb_probes)
+{
+    bloom_filter *new_filter = nullptr;
+
+    new_filter = alloc.malloc(alloc, sizeof(*new_filter) + BLOOM_FILTER_BLOCK_SIZE + (nb_blocks * BLOOM_FILTER_BLOCK_SIZE));
+    if (!new_filter) {
+        return nullptr;
+    }
+
+    new_filter->nb_blocks = nb_blocks;
+    new_filter->nb_probes = nb_probes;
+    new_filter->blocks = (u64 *) (((uintptr_t) (new_filter + 1) + BLOOM_FILTER_BLOCK_SIZE - 1)
+            & ~((uintptr_t) BLOOM_FILTER_BLOCK_SIZE - 1));
+
+    bloom_filter_clear(new_filter);
+
+    return new_filter;
+}
+
+// -----------------------------------------------------------------------------
+
+static f64 bloom_filter_expected_rate(size_t nb_elements, u64 nb_blocks, u32 nb_probes)
+{
+    f64 load = (f64) nb_elements / (f64) nb_blocks;
+    f64 bit_kept = 1. - (1. / (BLOOM_FILTER_BLOCK_SIZE * 8.));
+    f64 rate = 0.;
+    f64 max_load = load + (10. * sqrt(load)) + 10.;
+
+    // the number of hashes in a block follows a poisson distribution
+    for (f64 j = 0. ; j <= max_load ; j += 1.) {
+        rate += exp((j * log(load)) - load - lgamma(j + 1.)) * pow(1. - pow(bit_kept, nb_probes * j), nb_probes);
+    }
+
+    return rate;
+}
+
+// -----------------------------------------------------------------------------
+
+static u64 *bloom_filter_probe(const bloom_filter *filter, u64 hash, u64 *out_mask)
+{
+    u32 high = hash_integer(hash, 0x0b100au);
+    u64 random_bits = 0;
+    u32 nb_random_bits = 0;
+    u32 bit = 0;
+
+    // multiply-shift maps the hash on the blocks without a division
+    u64 block = ((u64) high * filter->nb_blocks) >> 32u;
+
+    // each probe takes 9 fresh bits of the hash, picking one bit out of the 512 of the block
+    for (u32 i = 0 ; i < filter->nb_probes ; i++) {
+        if (nb_random_bits < 9u) {
+            random_bits = ((u64) hash_integer(hash, 0x0b100bu + i) << 32u) | hash_integer(hash, 0x0b200bu + i);
+            nb_random_bits = 64u;
+        }
+        bit = (u32) (random_bits % (BLOOM_FILTER_BLOCK_SIZE * 8u));
+        random_bits >>= 9u;
+        nb_random_bits -= 9u;
+
+        out_mask[bit / 64u] |= (u64) 1u << (bit % 64u);
+    }
+
+    return filter->blocks + (block * BLOOM_FILTER_BLOCK_WORDS);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(bloom_filter_rates,
+        {
+            u32 nb_elements;
+            f64 false_positive_rate;
+        },
+        {
+            bloom_filter *filter = bloom_filter_create(make_system_allocator(), data->nb_elements, data->false_positive_rate);
+            bloom_filter *loaded = nullptr;
+            byte *buffer = nullptr;
+            size_t buffer_size = 0;
+            bool found_all = true;
+            bool same_answers = true;
+            u32 nb_false_positives = 0;
+            u32 nb_tries = 100000;
+
+            tst_assert(filter, "creation failed");
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                bloom_filter_insert(filter, i * 2654435761u);
+            }
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                found_all = found_all && bloom_filter_may_contain(filter, i * 2654435761u);
+            }
+            tst_assert(found_all, "an inserted hash was not found");
+
+            for (u64 i = 0 ; i < nb_tries ; i++) {
+                nb_false_positives += bloom_filter_may_contain(filter, ((u64) 1u << 40u) + i);
+            }
+            tst_assert(nb_false_positives <= (u32) (2. * data->false_positive_rate * nb_tries) + 10u,
+                    "%d false positives out of %d", nb_false_positives, nb_tries);
+
+            buffer_size = bloom_filter_serialize(filter, nullptr, 0);
+            buffer = make_system_allocator().malloc(make_system_allocator(), buffer_size);
+            tst_assert_equal(buffer_size, bloom_filter_serialize(filter, buffer, buffer_size), "serialized size of %ld");
+            loaded = bloom_filter_deserialize(make_system_allocator(), buffer, buffer_size);
+            tst_assert(loaded, "deserialization failed");
+            tst_assert(!bloom_filter_deserialize(make_system_allocator(), buffer, buffer_size - 1), "deserialized a short buffer");
+
+            for (u64 i = 0 ; i < 1000 ; i++) {
+                same_answers = same_answers && (bloom_filter_may_contain(filter, i) == bloom_filter_may_contain(loaded, i));
+            }
+            tst_assert(same_answers, "deserialized filter differs");
+
+            bloom_filter_clear(filter);
+            tst_assert(!bloom_filter_may_contain(filter, 0), "cleared filter still holds hashes");
+
+            make_system_allocator().free(make_system_allocator(), buffer);
+            bloom_filter_destroy(make_system_allocator(), &loaded);
+            bloom_filter_destroy(make_system_allocator(), &filter);
+            tst_assert(!filter, "filter not reset");
+        }
+)
+
+tst_CREATE_TEST_CASE(bloom_filter_rates_one_percent, bloom_filter_rates,
+        .nb_elements = 10000,
+        .false_positive_rate = 0.01,
+)
+tst_CREATE_TEST_CASE(bloom_filter_rates_low, bloom_filter_rates,
+        .nb_elements = 50000,
+        .false_positive_rate = 0.0005,
+)
+tst_CREATE_TEST_CASE(bloom_filter_rates_tiny, bloom_filter_rates,
+        .nb_elements = 3,
+        .false_positive_rate = 0.1,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void bloom_filter_execute_unittests(void)
+{
+    tst_run_test_case(bloom_filter_rates_one_percent);
+    tst_run_test_case(bloom_filter_rates_low);
+    tst_run_test_case(bloom_filter_rates_tiny);
+}
+
+#endif
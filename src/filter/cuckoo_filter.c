@@ -0,0 +1,723 @@
+
+#include <math.h>
+
+#include <ustd/filter.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Smallest and largest sizes, in bits, of the fingerprints.
+#define CUCKOO_FILTER_MIN_FINGERPRINT_BITS (4u)
+#define CUCKOO_FILTER_MAX_FINGERPRINT_BITS (16u)
+/// Share of the slots a filter is sized to fill : buckets of 4 fingerprints start failing insertions around 95%.
+#define CUCKOO_FILTER_LOAD_FACTOR (0.9)
+/// First bytes of a serialized cuckoo filter.
+#define CUCKOO_FILTER_MAGIC (0x4b435543u)
+
+/**
+ * @brief Cuckoo filter header, followed in the same allocation by its buckets of fingerprints.
+ * Fingerprints take `fingerprint_bits` bits each and are packed one after the other, a bucket of
+ * CUCKOO_FILTER_BUCKET_SIZE fingerprints spanning at most 64 bits. A fingerprint of 0 marks an empty slot.
+ */
+struct cuckoo_filter {
+    u64 nb_buckets;
+    u64 count;
+    u32 fingerprint_bits;
+
+    /// fingerprint that found no place during the last failed insertion, and one of its buckets
+    u16 victim;
+    u64 victim_bucket;
+
+    byte slots[];
+};
+
+/**
+ * @brief Header of a serialized cuckoo filter, followed by its slots.
+ * The reserved field fills what would be trailing padding, so every byte of a serialized header is written.
+ */
+struct cuckoo_filter_header {
+    u32 magic;
+    u32 fingerprint_bits;
+    u64 nb_buckets;
+    u64 count;
+    u64 victim_bucket;
+    u16 victim;
+    u16 reserved[3];
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Allocates an empty filter.
+ *
+ * @param alloc
+ * @param nb_buckets
+ * @param fingerprint_bits
+ * @return cuckoo_filter*
+ */
+static cuckoo_filter *cuckoo_filter_allocate(allocator alloc, u64 nb_buckets, u32 fingerprint_bits);
+
+/**
+ * @brief Computes the size, in bytes, of the packed slots of a filter. A word of padding lets the last bucket
+ * be read as a whole word like the others.
+ *
+ * @param nb_buckets
+ * @param fingerprint_bits
+ * @return size_t
+ */
+static size_t cuckoo_filter_size_slots(u64 nb_buckets, u32 fingerprint_bits);
+
+/**
+ * @brief Reads the fingerprints of a bucket, the first one in the lowest bits. A bucket starts on a byte or
+ * on half a byte, and is at most 60 bits long when it starts on half a byte : it always fits in the 8 bytes
+ * read from its first byte.
+ *
+ * @param filter
+ * @param bucket
+ * @return u64
+ */
+static u64 cuckoo_filter_bucket_read(const cuckoo_filter *filter, u64 bucket);
+
+/**
+ * @brief Writes back the fingerprints of a bucket read by cuckoo_filter_bucket_read().
+ *
+ * @param filter
+ * @param bucket
+ * @param fingerprints
+ */
+static void cuckoo_filter_bucket_write(cuckoo_filter *filter, u64 bucket, u64 fingerprints);
+
+/**
+ * @brief Extracts a fingerprint from the fingerprints of a bucket.
+ *
+ * @param filter
+ * @param fingerprints
+ * @param slot
+ * @return u16
+ */
+static u16 cuckoo_filter_slot_of(const cuckoo_filter *filter, u64 fingerprints, size_t slot);
+
+/**
+ * @brief Replaces the fingerprint in a slot of a bucket.
+ *
+ * @param filter
+ * @param bucket
+ * @param slot
+ * @param fingerprint
+ * @return u16 the fingerprint that was in the slot
+ */
+static u16 cuckoo_filter_slot_swap(cuckoo_filter *filter, u64 bucket, size_t slot, u16 fingerprint);
+
+/**
+ * @brief Computes the fingerprint and the first bucket of a hash.
+ *
+ * @param filter
+ * @param hash
+ * @param out_bucket
+ * @return u16 never 0
+ */
+static u16 cuckoo_filter_fingerprint_of(const cuckoo_filter *filter, u64 hash, u64 *out_bucket);
+
+/**
+ * @brief Computes the other bucket of a fingerprint. Applied twice, gives back the first bucket.
+ *
+ * @param filter
+ * @param bucket
+ * @param fingerprint
+ * @return u64
+ */
+static u64 cuckoo_filter_alternate(const cuckoo_filter *filter, u64 bucket, u16 fingerprint);
+
+/**
+ * @brief Puts a fingerprint in a free slot of a bucket.
+ *
+ * @param filter
+ * @param bucket
+ * @param fingerprint
+ * @return true if there was a free slot
+ * @return false otherwise
+ */
+static bool cuckoo_filter_bucket_add(cuckoo_filter *filter, u64 bucket, u16 fingerprint);
+
+/**
+ * @brief Looks for a fingerprint in a bucket.
+ *
+ * @param filter
+ * @param bucket
+ * @param fingerprint
+ * @param out_slot receives the index of the slot in the bucket ; can be NULL
+ * @return true if the fingerprint is in the bucket
+ * @return false otherwise
+ */
+static bool cuckoo_filter_bucket_find(const cuckoo_filter *filter, u64 bucket, u16 fingerprint, size_t *out_slot);
+
+/**
+ * @brief Places a fingerprint in one of its buckets, moving other fingerprints to their other bucket if
+ * needed. A fingerprint that finds no place is kept as the victim of the filter.
+ *
+ * @param filter
+ * @param bucket
+ * @param fingerprint
+ */
+static void cuckoo_filter_place(cuckoo_filter *filter, u64 bucket, u16 fingerprint);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+cuckoo_filter *cuckoo_filter_create(allocator alloc, size_t nb_elements, f64 false_positive_rate)
+{
+    u64 nb_buckets = 1;
+    u64 needed_buckets = 0;
+    f64 fingerprint_bits = 0.;
+
+    if ((nb_elements == 0) || !(false_positive_rate > 0.) || !(false_positive_rate < 1.)) {
+        return nullptr;
+    }
+
+    // a lookup compares the fingerprint against the 2 * CUCKOO_FILTER_BUCKET_SIZE slots of its buckets
+    fingerprint_bits = ceil(log2((2. * CUCKOO_FILTER_BUCKET_SIZE) / false_positive_rate));
+    fingerprint_bits = MIN(MAX(fingerprint_bits, (f64) CUCKOO_FILTER_MIN_FINGERPRINT_BITS), (f64) CUCKOO_FILTER_MAX_FINGERPRINT_BITS);
+
+    needed_buckets = (u64) ceil((f64) nb_elements / (CUCKOO_FILTER_BUCKET_SIZE * CUCKOO_FILTER_LOAD_FACTOR));
+    while (nb_buckets < needed_buckets) {
+        nb_buckets <<= 1u;
+    }
+
+    return cuckoo_filter_allocate(alloc, nb_buckets, (u32) fingerprint_bits);
+}
+
+// -----------------------------------------------------------------------------
+
+void cuckoo_filter_destroy(allocator alloc, cuckoo_filter **filter)
+{
+    if (!filter || !*filter) {
+        return;
+    }
+
+    alloc.free(alloc, *filter);
+    *filter = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool cuckoo_filter_insert(cuckoo_filter *filter, u64 hash)
+{
+    u64 bucket = 0;
+    u16 fingerprint = 0;
+
+    if (!filter || (filter->victim != 0)) {
+        return false;
+    }
+
+    fingerprint = cuckoo_filter_fingerprint_of(filter, hash, &bucket);
+    cuckoo_filter_place(filter, bucket, fingerprint);
+    filter->count += 1;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool cuckoo_filter_may_contain(const cuckoo_filter *filter, u64 hash)
+{
+    u64 bucket = 0;
+    u64 other_bucket = 0;
+    u16 fingerprint = 0;
+
+    if (!filter) {
+        return false;
+    }
+
+    fingerprint = cuckoo_filter_fingerprint_of(filter, hash, &bucket);
+    other_bucket = cuckoo_filter_alternate(filter, bucket, fingerprint);
+
+    return cuckoo_filter_bucket_find(filter, bucket, fingerprint, nullptr)
+            || cuckoo_filter_bucket_find(filter, other_bucket, fingerprint, nullptr)
+            || ((filter->victim == fingerprint)
+                    && ((filter->victim_bucket == bucket) || (filter->victim_bucket == other_bucket)));
+}
+
+// -----------------------------------------------------------------------------
+
+bool cuckoo_filter_remove(cuckoo_filter *filter, u64 hash)
+{
+    u64 bucket = 0;
+    u64 other_bucket = 0;
+    u16 fingerprint = 0;
+    u16 victim = 0;
+    size_t slot = 0;
+
+    if (!filter) {
+        return false;
+    }
+
+    fingerprint = cuckoo_filter_fingerprint_of(filter, hash, &bucket);
+    other_bucket = cuckoo_filter_alternate(filter, bucket, fingerprint);
+
+    if ((filter->victim == fingerprint) && ((filter->victim_bucket == bucket) || (filter->victim_bucket == other_bucket))) {
+        filter->victim = 0;
+    } else if (cuckoo_filter_bucket_find(filter, bucket, fingerprint, &slot)) {
+        cuckoo_filter_slot_swap(filter, bucket, slot, 0);
+    } else if (cuckoo_filter_bucket_find(filter, other_bucket, fingerprint, &slot)) {
+        cuckoo_filter_slot_swap(filter, other_bucket, slot, 0);
+    } else {
+        return false;
+    }
+
+    filter->count -= 1;
+
+    // a slot was freed : the victim can try again
+    if (filter->victim != 0) {
+        victim = filter->victim;
+        filter->victim = 0;
+        cuckoo_filter_place(filter, filter->victim_bucket, victim);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t cuckoo_filter_count(const cuckoo_filter *filter)
+{
+    if (!filter) {
+        return 0;
+    }
+
+    return filter->count;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t cuckoo_filter_serialize(const cuckoo_filter *filter, byte *out_buffer, size_t buffer_size)
+{
+    struct cuckoo_filter_header header = { 0 };
+    size_t needed_size = 0;
+
+    if (!filter) {
+        return 0;
+    }
+
+    needed_size = sizeof(header) + cuckoo_filter_size_slots(filter->nb_buckets, filter->fingerprint_bits);
+    if (!out_buffer || (buffer_size < needed_size)) {
+        return needed_size;
+    }
+
+    header = (struct cuckoo_filter_header) {
+            .magic = CUCKOO_FILTER_MAGIC,
+            .fingerprint_bits = filter->fingerprint_bits,
+            .nb_buckets = filter->nb_buckets,
+            .count = filter->count,
+            .victim_bucket = filter->victim_bucket,
+            .victim = filter->victim,
+            .reserved = { 0 },
+    };
+
+    bytewise_copy(out_buffer, &header, sizeof(header));
+    bytewise_copy(out_buffer + sizeof(header), filter->slots, needed_size - sizeof(header));
+
+    return needed_size;
+}
+
+// -----------------------------------------------------------------------------
+
+cuckoo_filter *cuckoo_filter_deserialize(allocator alloc, const byte *buffer, size_t buffer_size)
+{
+    struct cuckoo_filter_header header = { 0 };
+    cuckoo_filter *new_filter = nullptr;
+    size_t size_slots = 0;
+
+    if (!buffer || (buffer_size < sizeof(header))) {
+        return nullptr;
+    }
+
+    bytewise_copy(&header, buffer, sizeof(header));
+    if ((header.magic != CUCKOO_FILTER_MAGIC)
+            || (header.fingerprint_bits < CUCKOO_FILTER_MIN_FINGERPRINT_BITS)
+            || (header.fingerprint_bits > CUCKOO_FILTER_MAX_FINGERPRINT_BITS)
+            || (header.nb_buckets == 0) || ((header.nb_buckets & (header.nb_buckets - 1u)) != 0)
+            || (header.nb_buckets > (buffer_size - sizeof(header)))
+            || (cuckoo_filter_size_slots(header.nb_buckets, header.fingerprint_bits) > (buffer_size - sizeof(header)))
+            || (header.victim_bucket >= header.nb_buckets)
+            || (((u32) header.victim >> header.fingerprint_bits) != 0)) {
+        return nullptr;
+    }
+
+    new_filter = cuckoo_filter_allocate(alloc, header.nb_buckets, header.fingerprint_bits);
+    if (!new_filter) {
+        return nullptr;
+    }
+
+    size_slots = cuckoo_filter_size_slots(header.nb_buckets, header.fingerprint_bits);
+    bytewise_copy(new_filter->slots, buffer + sizeof(header), size_slots);
+    new_filter->count = header.count;
+    new_filter->victim = header.victim;
+    new_filter->victim_bucket = header.victim_bucket;
+
+    return new_filter;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static cuckoo_filter *cuckoo_filter_allocate(allocator alloc, u64 nb_buckets, u32 fingerprint_bits)
+{
+    cuckoo_filter *new_filter = nullptr;
+    size_t size_slots = cuckoo_filter_size_slots(nb_buckets, fingerprint_bits);
+
+    new_filter = alloc.malloc(alloc, sizeof(*new_filter) + size_slots);
+    if (!new_filter) {
+        return nullptr;
+    }
+
+    *new_filter = (cuckoo_filter) {
+            .nb_buckets = nb_buckets,
+            .count = 0,
+            .fingerprint_bits = fingerprint_bits,
+            .victim = 0,
+            .victim_bucket = 0,
+    };
+
+    for (size_t i = 0 ; i < size_slots ; i++) {
+        new_filter->slots[i] = 0;
+    }
+
+    return new_filter;
+}
+
+// -----------------------------------------------------------------------------
+
+static size_t cuckoo_filter_size_slots(u64 nb_buckets, u32 fingerprint_bits)
+{
+    return CEIL_DIV(nb_buckets * CUCKOO_FILTER_BUCKET_SIZE * fingerprint_bits, 8u) + sizeof(u64);
+}
+
+// -----------------------------------------------------------------------------
+
+static u64 cuckoo_filter_bucket_read(const cuckoo_filter *filter, u64 bucket)
+{
+    u64 first_bit = bucket * CUCKOO_FILTER_BUCKET_SIZE * filter->fingerprint_bits;
+    u32 bucket_bits = CUCKOO_FILTER_BUCKET_SIZE * filter->fingerprint_bits;
+    const byte *bytes = filter->slots + (first_bit / 8u);
+    u64 word = 0;
+
+    // assembled byte by byte, so serialized filters do not depend on the byte order
+    for (size_t i = 0 ; i < sizeof(word) ; i++) {
+        word |= (u64) bytes[i] << (8u * i);
+    }
+
+    word >>= first_bit % 8u;
+
+    return (bucket_bits < 64u) ? (word & ((1ull << bucket_bits) - 1u)) : word;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cuckoo_filter_bucket_write(cuckoo_filter *filter, u64 bucket, u64 fingerprints)
+{
+    u64 first_bit = bucket * CUCKOO_FILTER_BUCKET_SIZE * filter->fingerprint_bits;
+    u32 bucket_bits = CUCKOO_FILTER_BUCKET_SIZE * filter->fingerprint_bits;
+    u64 mask = (bucket_bits < 64u) ? ((1ull << bucket_bits) - 1u) : ~0ull;
+    byte *bytes = filter->slots + (first_bit / 8u);
+    u64 word = 0;
+
+    for (size_t i = 0 ; i < sizeof(word) ; i++) {
+        word |= (u64) bytes[i] << (8u * i);
+    }
+
+    word &= ~(mask << (first_bit % 8u));
+    word |= (fingerprints & mask) << (first_bit % 8u);
+
+    for (size_t i = 0 ; i < sizeof(word) ; i++) {
+        bytes[i] = (byte) (word >> (8u * i));
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+static u16 cuckoo_filter_slot_of(const cuckoo_filter *filter, u64 fingerprints, size_t slot)
+{
+    return (u16) ((fingerprints >> (slot * filter->fingerprint_bits)) & ((1u << filter->fingerprint_bits) - 1u));
+}
+
+// -----------------------------------------------------------------------------
+
+static u16 cuckoo_filter_slot_swap(cuckoo_filter *filter, u64 bucket, size_t slot, u16 fingerprint)
+{
+    u64 fingerprints = cuckoo_filter_bucket_read(filter, bucket);
+    u64 shift = slot * filter->fingerprint_bits;
+    u16 previous = cuckoo_filter_slot_of(filter, fingerprints, slot);
+
+    fingerprints &= ~((u64) ((1u << filter->fingerprint_bits) - 1u) << shift);
+    fingerprints |= (u64) fingerprint << shift;
+    cuckoo_filter_bucket_write(filter, bucket, fingerprints);
+
+    return previous;
+}
+
+// -----------------------------------------------------------------------------
+
+static u16 cuckoo_filter_fingerprint_of(const cuckoo_filter *filter, u64 hash, u64 *out_bucket)
+{
+    u64 mixed = ((u64) hash_integer(hash, 0xc0c0au) << 32u) | hash_integer(hash, 0xc0c0bu);
+    u16 fingerprint = (u16) ((mixed >> 32u) & ((1u << filter->fingerprint_bits) - 1u));
+
+    *out_bucket = mixed & (filter->nb_buckets - 1u);
+
+    // 0 marks empty slots
+    return (fingerprint == 0) ? 1u : fingerprint;
+}
+
+// -----------------------------------------------------------------------------
+
+static u64 cuckoo_filter_alternate(const cuckoo_filter *filter, u64 bucket, u16 fingerprint)
+{
+    return (bucket ^ hash_integer(fingerprint, 0xc0c0cu)) & (filter->nb_buckets - 1u);
+}
+
+// -----------------------------------------------------------------------------
+
+static bool cuckoo_filter_bucket_add(cuckoo_filter *filter, u64 bucket, u16 fingerprint)
+{
+    u64 fingerprints = cuckoo_filter_bucket_read(filter, bucket);
+
+    for (size_t i = 0 ; i < CUCKOO_FILTER_BUCKET_SIZE ; i++) {
+        if (cuckoo_filter_slot_of(filter, fingerprints, i) == 0) {
+            fingerprints |= (u64) fingerprint << (i * filter->fingerprint_bits);
+            cuckoo_filter_bucket_write(filter, bucket, fingerprints);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+static bool cuckoo_filter_bucket_find(const cuckoo_filter *filter, u64 bucket, u16 fingerprint, size_t *out_slot)
+{
+    u64 fingerprints = cuckoo_filter_bucket_read(filter, bucket);
+
+    for (size_t i = 0 ; i < CUCKOO_FILTER_BUCKET_SIZE ; i++) {
+        if (cuckoo_filter_slot_of(filter, fingerprints, i) == fingerprint) {
+            if (out_slot) {
+                *out_slot = i;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+static void cuckoo_filter_place(cuckoo_filter *filter, u64 bucket, u16 fingerprint)
+{
+    u16 evicted = 0;
+    size_t slot = 0;
+
+    if (cuckoo_filter_bucket_add(filter, bucket, fingerprint)) {
+        return;
+    }
+
+    bucket = cuckoo_filter_alternate(filter, bucket, fingerprint);
+    for (u32 kick = 0 ; kick < CUCKOO_FILTER_MAX_KICKS ; kick++) {
+        if (cuckoo_filter_bucket_add(filter, bucket, fingerprint)) {
+            return;
+        }
+
+        // swap with a slot picked from the fingerprint itself, to avoid cycling on the same slot
+        slot = (fingerprint + kick) % CUCKOO_FILTER_BUCKET_SIZE;
+        evicted = cuckoo_filter_slot_swap(filter, bucket, slot, fingerprint);
+        fingerprint = evicted;
+        bucket = cuckoo_filter_alternate(filter, bucket, fingerprint);
+    }
+
+    filter->victim = fingerprint;
+    filter->victim_bucket = bucket;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(cuckoo_filter_rates,
+        {
+            u32 nb_elements;
+            f64 false_positive_rate;
+        },
+        {
+            cuckoo_filter *filter = cuckoo_filter_create(make_system_allocator(), data->nb_elements, data->false_positive_rate);
+            cuckoo_filter *loaded = nullptr;
+            byte *buffer = nullptr;
+            byte *tampered = nullptr;
+            struct cuckoo_filter_header header = { 0 };
+            size_t buffer_size = 0;
+            bool inserted_all = true;
+            bool found_all = true;
+            bool same_answers = true;
+            u32 nb_false_positives = 0;
+            u32 nb_tries = 100000;
+
+            tst_assert(filter, "creation failed");
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                inserted_all = inserted_all && cuckoo_filter_insert(filter, i * 2654435761u);
+            }
+            tst_assert(inserted_all, "an insertion failed");
+            tst_assert_equal(data->nb_elements, cuckoo_filter_count(filter), "count of %ld");
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                found_all = found_all && cuckoo_filter_may_contain(filter, i * 2654435761u);
+            }
+            tst_assert(found_all, "an inserted hash was not found");
+
+            for (u64 i = 0 ; i < nb_tries ; i++) {
+                nb_false_positives += cuckoo_filter_may_contain(filter, ((u64) 1u << 40u) + i);
+            }
+            tst_assert(nb_false_positives <= (u32) (2. * data->false_positive_rate * nb_tries) + 10u,
+                    "%d false positives out of %d", nb_false_positives, nb_tries);
+
+            buffer_size = cuckoo_filter_serialize(filter, nullptr, 0);
+            buffer = make_system_allocator().malloc(make_system_allocator(), buffer_size);
+            tst_assert_equal(buffer_size, cuckoo_filter_serialize(filter, buffer, buffer_size), "serialized size of %ld");
+            loaded = cuckoo_filter_deserialize(make_system_allocator(), buffer, buffer_size);
+            tst_assert(loaded, "deserialization failed");
+            tst_assert(!cuckoo_filter_deserialize(make_system_allocator(), buffer, buffer_size - 1), "deserialized a short buffer");
+
+            bytewise_copy(&header, buffer, sizeof(header));
+            tst_assert_equal(0, header.reserved[0] | header.reserved[1] | header.reserved[2], "reserved bits of %x");
+            if (header.fingerprint_bits < CUCKOO_FILTER_MAX_FINGERPRINT_BITS) {
+                tampered = make_system_allocator().malloc(make_system_allocator(), buffer_size);
+                header.victim = 0xffffu;
+                bytewise_copy(tampered, buffer, buffer_size);
+                bytewise_copy(tampered, &header, sizeof(header));
+                tst_assert(!cuckoo_filter_deserialize(make_system_allocator(), tampered, buffer_size), "deserialized a wide victim");
+                make_system_allocator().free(make_system_allocator(), tampered);
+            }
+
+            for (u64 i = 0 ; i < 1000 ; i++) {
+                same_answers = same_answers && (cuckoo_filter_may_contain(filter, i) == cuckoo_filter_may_contain(loaded, i));
+            }
+            tst_assert(same_answers, "deserialized filter differs");
+
+            // removing even hashes must keep the odd ones
+            for (u32 i = 0 ; i < data->nb_elements ; i += 2) {
+                tst_assert(cuckoo_filter_remove(filter, i * 2654435761u), "removal %d failed", i);
+            }
+            for (u32 i = 1 ; i < data->nb_elements ; i += 2) {
+                found_all = found_all && cuckoo_filter_may_contain(filter, i * 2654435761u);
+            }
+            tst_assert(found_all, "a kept hash was lost by a removal");
+            tst_assert_equal(data->nb_elements / 2, cuckoo_filter_count(filter), "count after removal of %ld");
+
+            make_system_allocator().free(make_system_allocator(), buffer);
+            cuckoo_filter_destroy(make_system_allocator(), &loaded);
+            cuckoo_filter_destroy(make_system_allocator(), &filter);
+            tst_assert(!filter, "filter not reset");
+        }
+)
+
+tst_CREATE_TEST_CASE(cuckoo_filter_rates_one_percent, cuckoo_filter_rates,
+        .nb_elements = 10000,
+        .false_positive_rate = 0.01,
+)
+tst_CREATE_TEST_CASE(cuckoo_filter_rates_low, cuckoo_filter_rates,
+        .nb_elements = 50000,
+        .false_positive_rate = 0.0005,
+)
+tst_CREATE_TEST_CASE(cuckoo_filter_rates_tiny, cuckoo_filter_rates,
+        .nb_elements = 2,
+        .false_positive_rate = 0.1,
+)
+tst_CREATE_TEST_CASE(cuckoo_filter_rates_fullest, cuckoo_filter_rates,
+        .nb_elements = 58982,
+        .false_positive_rate = 0.01,
+)
+tst_CREATE_TEST_CASE(cuckoo_filter_rates_short_fingerprints, cuckoo_filter_rates,
+        .nb_elements = 20000,
+        .false_positive_rate = 0.3,
+)
+
+tst_CREATE_TEST_SCENARIO(cuckoo_filter_packing,
+        {
+            f64 false_positive_rate;
+            f64 max_size_ratio;
+        },
+        {
+            cuckoo_filter *small = cuckoo_filter_create(make_system_allocator(), 10000, data->false_positive_rate);
+            cuckoo_filter *large = cuckoo_filter_create(make_system_allocator(), 10000, 0.0001);
+            size_t small_size = cuckoo_filter_serialize(small, nullptr, 0);
+            size_t large_size = cuckoo_filter_serialize(large, nullptr, 0);
+
+            tst_assert((f64) small_size <= (data->max_size_ratio * (f64) large_size),
+                    "%ld bytes against %ld for 16 bits fingerprints", small_size, large_size);
+
+            cuckoo_filter_destroy(make_system_allocator(), &small);
+            cuckoo_filter_destroy(make_system_allocator(), &large);
+        }
+)
+
+tst_CREATE_TEST_CASE(cuckoo_filter_packing_eight_bits, cuckoo_filter_packing,
+        .false_positive_rate = 0.04,
+        .max_size_ratio = 0.51,
+)
+tst_CREATE_TEST_CASE(cuckoo_filter_packing_five_bits, cuckoo_filter_packing,
+        .false_positive_rate = 0.25,
+        .max_size_ratio = 0.32,
+)
+
+tst_CREATE_TEST_SCENARIO(cuckoo_filter_overflow,
+        {
+            u32 nb_elements;
+        },
+        {
+            cuckoo_filter *filter = cuckoo_filter_create(make_system_allocator(), data->nb_elements, 0.01);
+            u32 nb_inserted = 0;
+            bool found_all = true;
+
+            while (cuckoo_filter_insert(filter, nb_inserted * 2654435761u)) {
+                nb_inserted += 1;
+            }
+            tst_assert(nb_inserted >= data->nb_elements, "only %d insertions", nb_inserted);
+            tst_assert_equal(nb_inserted, cuckoo_filter_count(filter), "count of %ld");
+
+            for (u32 i = 0 ; i < nb_inserted ; i++) {
+                found_all = found_all && cuckoo_filter_may_contain(filter, i * 2654435761u);
+            }
+            tst_assert(found_all, "a hash was lost when the filter filled up");
+
+            tst_assert(cuckoo_filter_remove(filter, 0), "removal failed");
+            tst_assert(cuckoo_filter_insert(filter, 0), "no room after a removal");
+
+            cuckoo_filter_destroy(make_system_allocator(), &filter);
+        }
+)
+
+tst_CREATE_TEST_CASE(cuckoo_filter_overflow_nominal, cuckoo_filter_overflow,
+        .nb_elements = 1000,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void cuckoo_filter_execute_unittests(void)
+{
+    tst_run_test_case(cuckoo_filter_rates_one_percent);
+    tst_run_test_case(cuckoo_filter_rates_low);
+    tst_run_test_case(cuckoo_filter_rates_tiny);
+    tst_run_test_case(cuckoo_filter_rates_fullest);
+    tst_run_test_case(cuckoo_filter_rates_short_fingerprints);
+    tst_run_test_case(cuckoo_filter_packing_eight_bits);
+    tst_run_test_case(cuckoo_filter_packing_five_bits);
+    tst_run_test_case(cuckoo_filter_overflow_nominal);
+}
+
+#endif
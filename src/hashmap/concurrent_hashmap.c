@@ -0,0 +1,394 @@
+
+// reader-writer locks are a POSIX extension
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+
+#include <ustd/concurrent_hashmap.h>
+
+#ifdef UNITTESTING
+#include <threads.h>
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Alignment of the shards, so two shards never share a cache line.
+#define CONCURRENT_HASHMAP_SHARD_ALIGNMENT (64u)
+
+/**
+ * @brief A hashmap and the lock guarding it.
+ */
+struct concurrent_hashmap_shard {
+    _Alignas(CONCURRENT_HASHMAP_SHARD_ALIGNMENT) pthread_rwlock_t lock;
+    HASHMAP_ANY map;
+};
+
+/**
+ * @brief Concurrent hashmap header, followed in the same allocation by the (aligned) shards.
+ */
+struct concurrent_hashmap {
+    struct concurrent_hashmap_shard *shards;
+    size_t nb_shards;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Finds the shard holding a hash.
+ *
+ * @param map
+ * @param hash
+ * @return struct concurrent_hashmap_shard*
+ */
+static struct concurrent_hashmap_shard *concurrent_hashmap_shard_of(concurrent_hashmap *map, u32 hash);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+concurrent_hashmap *concurrent_hashmap_create(allocator alloc, size_t element_size, size_t nb_shards, size_t starting_capacity)
+{
+    concurrent_hashmap *new_map = nullptr;
+    size_t nb_shards_pow2 = 1;
+    size_t nb_initialized = 0;
+
+    if ((element_size == 0) || (nb_shards == 0) || (starting_capacity == 0)) {
+        return nullptr;
+    }
+
+    while ((nb_shards_pow2 < nb_shards) && (nb_shards_pow2 < CONCURRENT_HASHMAP_MAX_SHARDS)) {
+        nb_shards_pow2 <<= 1u;
+    }
+
+    new_map = alloc.malloc(alloc, sizeof(*new_map) + CONCURRENT_HASHMAP_SHARD_ALIGNMENT
+            + (nb_shards_pow2 * sizeof(*new_map->shards)));
+
+    if (!new_map) {
+        return nullptr;
+    }
+
+    new_map->nb_shards = nb_shards_pow2;
+    new_map->shards = (struct concurrent_hashmap_shard *) (((uintptr_t) (new_map + 1) + CONCURRENT_HASHMAP_SHARD_ALIGNMENT - 1)
+            & ~((uintptr_t) CONCURRENT_HASHMAP_SHARD_ALIGNMENT - 1));
+
+    for (nb_initialized = 0 ; nb_initialized < nb_shards_pow2 ; nb_initialized++) {
+        new_map->shards[nb_initialized].map = hashmap_create(alloc, element_size, starting_capacity);
+        if (!new_map->shards[nb_initialized].map) {
+            break;
+        }
+        if (pthread_rwlock_init(&new_map->shards[nb_initialized].lock, nullptr) != 0) {
+            hashmap_destroy(alloc, &new_map->shards[nb_initialized].map);
+            break;
+        }
+    }
+
+    if (nb_initialized < nb_shards_pow2) {
+        new_map->nb_shards = nb_initialized;
+        concurrent_hashmap_destroy(alloc, &new_map);
+    }
+
+    return new_map;
+}
+
+// -----------------------------------------------------------------------------
+
+void concurrent_hashmap_destroy(allocator alloc, concurrent_hashmap **map)
+{
+    if (!map || !*map) {
+        return;
+    }
+
+    for (size_t i = 0 ; i < (*map)->nb_shards ; i++) {
+        pthread_rwlock_destroy(&(*map)->shards[i].lock);
+        hashmap_destroy(alloc, &(*map)->shards[i].map);
+    }
+
+    alloc.free(alloc, *map);
+    *map = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool concurrent_hashmap_set_hashed(allocator alloc, concurrent_hashmap *map, u32 hash, const void *value)
+{
+    struct concurrent_hashmap_shard *shard = nullptr;
+    size_t pos = 0;
+    bool stored = false;
+
+    if (!map || !value) {
+        return false;
+    }
+
+    shard = concurrent_hashmap_shard_of(map, hash);
+    pthread_rwlock_wrlock(&shard->lock);
+
+    // a stop-the-world growth only stalls this shard, a fraction of the map, and keeps all its elements in a
+    // single table : the position returned below always indexes the shard's keys
+    hashmap_ensure_capacity(alloc, &shard->map, 1);
+    pos = hashmap_set_hashed(shard->map, hash, (void *) value);
+    stored = (pos < hashmap_length(shard->map)) && (hashmap_keys(shard->map)[pos] == hash);
+
+    pthread_rwlock_unlock(&shard->lock);
+
+    return stored;
+}
+
+// -----------------------------------------------------------------------------
+
+bool concurrent_hashmap_get_hashed(concurrent_hashmap *map, u32 hash, void *out_value)
+{
+    struct concurrent_hashmap_shard *shard = nullptr;
+    size_t pos = 0;
+    bool found = false;
+
+    if (!map) {
+        return false;
+    }
+
+    shard = concurrent_hashmap_shard_of(map, hash);
+    pthread_rwlock_rdlock(&shard->lock);
+
+    pos = hashmap_index_of_hashed(shard->map, hash);
+    found = (pos < hashmap_length(shard->map));
+    if (found && out_value) {
+        hashmap_get(shard->map, pos, out_value);
+    }
+
+    pthread_rwlock_unlock(&shard->lock);
+
+    return found;
+}
+
+// -----------------------------------------------------------------------------
+
+bool concurrent_hashmap_remove_hashed(concurrent_hashmap *map, u32 hash)
+{
+    struct concurrent_hashmap_shard *shard = nullptr;
+    size_t length_before = 0;
+    bool removed = false;
+
+    if (!map) {
+        return false;
+    }
+
+    shard = concurrent_hashmap_shard_of(map, hash);
+    pthread_rwlock_wrlock(&shard->lock);
+
+    length_before = hashmap_length(shard->map);
+    hashmap_remove_hashed(shard->map, hash);
+    removed = (hashmap_length(shard->map) < length_before);
+
+    pthread_rwlock_unlock(&shard->lock);
+
+    return removed;
+}
+
+// -----------------------------------------------------------------------------
+
+bool concurrent_hashmap_set(allocator alloc, concurrent_hashmap *map, const char *key, const void *value)
+{
+    if (!key) {
+        return false;
+    }
+
+    return concurrent_hashmap_set_hashed(alloc, map, hashmap_hash_of(key, 0), value);
+}
+
+// -----------------------------------------------------------------------------
+
+bool concurrent_hashmap_get(concurrent_hashmap *map, const char *key, void *out_value)
+{
+    if (!key) {
+        return false;
+    }
+
+    return concurrent_hashmap_get_hashed(map, hashmap_hash_of(key, 0), out_value);
+}
+
+// -----------------------------------------------------------------------------
+
+bool concurrent_hashmap_remove(concurrent_hashmap *map, const char *key)
+{
+    if (!key) {
+        return false;
+    }
+
+    return concurrent_hashmap_remove_hashed(map, hashmap_hash_of(key, 0));
+}
+
+// -----------------------------------------------------------------------------
+
+size_t concurrent_hashmap_count(concurrent_hashmap *map)
+{
+    size_t count = 0;
+
+    if (!map) {
+        return 0;
+    }
+
+    for (size_t i = 0 ; i < map->nb_shards ; i++) {
+        pthread_rwlock_rdlock(&map->shards[i].lock);
+        count += hashmap_length(map->shards[i].map);
+        pthread_rwlock_unlock(&map->shards[i].lock);
+    }
+
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t concurrent_hashmap_nb_shards(const concurrent_hashmap *map)
+{
+    if (!map) {
+        return 0;
+    }
+
+    return map->nb_shards;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static struct concurrent_hashmap_shard *concurrent_hashmap_shard_of(concurrent_hashmap *map, u32 hash)
+{
+    return map->shards + (hash & (map->nb_shards - 1u));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+/**
+ * @brief Work of a test thread : writes its own range of keys, then reads back the keys of all threads.
+ */
+struct test_concurrent_worker {
+    concurrent_hashmap *map;
+    u32 first_key;
+    u32 nb_keys;
+    u32 nb_keys_total;
+    size_t nb_mismatches;
+};
+
+static int test_concurrent_work(void *worker)
+{
+    struct test_concurrent_worker *target = (struct test_concurrent_worker *) worker;
+    u32 value = 0;
+
+    for (u32 i = target->first_key ; i < target->first_key + target->nb_keys ; i++) {
+        value = i * 3u;
+        if (!concurrent_hashmap_set_hashed(make_system_allocator(), target->map, i * 2654435761u, &value)) {
+            target->nb_mismatches += 1;
+        }
+    }
+
+    // keys of the other threads might not be there yet, but must hold the right value when they are
+    for (u32 i = 0 ; i < target->nb_keys_total ; i++) {
+        if (concurrent_hashmap_get_hashed(target->map, i * 2654435761u, &value) && (value != i * 3u)) {
+            target->nb_mismatches += 1;
+        }
+    }
+
+    return 0;
+}
+
+tst_CREATE_TEST_SCENARIO(concurrent_hashmap_threads,
+        {
+            size_t nb_shards;
+            u32 nb_threads;
+            u32 nb_keys_per_thread;
+        },
+        {
+            concurrent_hashmap *map = concurrent_hashmap_create(make_system_allocator(), sizeof(u32), data->nb_shards, 4);
+            struct test_concurrent_worker workers[8] = { 0 };
+            thrd_t threads[8] = { 0 };
+            u32 nb_keys_total = data->nb_threads * data->nb_keys_per_thread;
+            size_t nb_mismatches = 0;
+            bool found_all = true;
+            u32 value = 0;
+
+            tst_assert(map, "creation failed");
+            tst_assert(concurrent_hashmap_nb_shards(map) >= data->nb_shards, "%ld shards", concurrent_hashmap_nb_shards(map));
+
+            for (u32 i = 0 ; i < data->nb_threads ; i++) {
+                workers[i].map = map;
+                workers[i].first_key = i * data->nb_keys_per_thread;
+                workers[i].nb_keys = data->nb_keys_per_thread;
+                workers[i].nb_keys_total = nb_keys_total;
+                tst_assert(thrd_create(threads + i, &test_concurrent_work, workers + i) == thrd_success, "thread %d not started", i);
+            }
+            for (u32 i = 0 ; i < data->nb_threads ; i++) {
+                thrd_join(threads[i], nullptr);
+                nb_mismatches += workers[i].nb_mismatches;
+            }
+
+            tst_assert_equal(0, nb_mismatches, "%ld mismatched values");
+            tst_assert_equal(nb_keys_total, concurrent_hashmap_count(map), "count of %ld");
+
+            for (u32 i = 0 ; i < nb_keys_total ; i++) {
+                found_all = found_all && concurrent_hashmap_get_hashed(map, i * 2654435761u, &value) && (value == i * 3u);
+            }
+            tst_assert(found_all, "lost values");
+
+            for (u32 i = 0 ; i < nb_keys_total ; i += 2) {
+                found_all = found_all && concurrent_hashmap_remove_hashed(map, i * 2654435761u);
+            }
+            tst_assert(found_all, "failed removals");
+            tst_assert(!concurrent_hashmap_remove_hashed(map, 0), "removed a missing key");
+            tst_assert_equal(nb_keys_total / 2, concurrent_hashmap_count(map), "count after removal of %ld");
+
+            concurrent_hashmap_destroy(make_system_allocator(), &map);
+            tst_assert(!map, "map not reset");
+        }
+)
+
+tst_CREATE_TEST_CASE(concurrent_hashmap_threads_single_shard, concurrent_hashmap_threads,
+        .nb_shards = 1,
+        .nb_threads = 4,
+        .nb_keys_per_thread = 2000,
+)
+tst_CREATE_TEST_CASE(concurrent_hashmap_threads_many_shards, concurrent_hashmap_threads,
+        .nb_shards = 13,
+        .nb_threads = 8,
+        .nb_keys_per_thread = 5000,
+)
+
+tst_CREATE_TEST_SCENARIO(concurrent_hashmap_string_keys,
+        {
+            const char *keys[4];
+        },
+        {
+            concurrent_hashmap *map = concurrent_hashmap_create(make_system_allocator(), sizeof(u32), 4, 1);
+            u32 value = 0;
+
+            for (u32 i = 0 ; i < 4 ; i++) {
+                tst_assert(concurrent_hashmap_set(make_system_allocator(), map, data->keys[i], &i), "set %d failed", i);
+            }
+            for (u32 i = 0 ; i < 4 ; i++) {
+                tst_assert(concurrent_hashmap_get(map, data->keys[i], &value), "key %d not found", i);
+                tst_assert_equal(i, value, "value of %d");
+            }
+            tst_assert(concurrent_hashmap_remove(map, data->keys[0]), "remove failed");
+            tst_assert(!concurrent_hashmap_get(map, data->keys[0], nullptr), "removed key found");
+
+            concurrent_hashmap_destroy(make_system_allocator(), &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(concurrent_hashmap_string_keys_nominal, concurrent_hashmap_string_keys,
+        .keys = { "alpha", "beta", "gamma", "delta" },
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void concurrent_hashmap_execute_unittests(void)
+{
+    tst_run_test_case(concurrent_hashmap_threads_single_shard);
+    tst_run_test_case(concurrent_hashmap_threads_many_shards);
+    tst_run_test_case(concurrent_hashmap_string_keys_nominal);
+}
+
+#endif
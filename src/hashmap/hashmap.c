@@ -2,26 +2,132 @@
 #include <ustd/hashmap.h>
 
 #include <ustd_impl/array_impl.h>
+#include <ustd_impl/hashmap_impl.h>
 
-// -----------------------------------------------------------------------------
-// -----------------------------------------------------------------------------
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
 
 /**
- * @brief
+ * @brief Hash of a key and position of its value in the arrays given to hashmap_create_from().
  */
-struct hashmap_impl {
-    ARRAY(u32) keys;
-
-    size_t length;
-    size_t capacity;
-    u32 stride;
-    byte data[];
+struct hashmap_bulk_entry {
+    u32 hash;
+    u32 index;
 };
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 
-static struct hashmap_impl *hashmap_impl_of(HASHMAP_ANY map);
+/**
+ * @brief Fills an empty hashmap from entries sorted by hash. The last of several entries of the same hash wins.
+ *
+ * @param map
+ * @param entries
+ * @param values
+ * @param count
+ */
+static void hashmap_fill_sorted(HASHMAP_ANY map, const struct hashmap_bulk_entry *entries, const byte *values, size_t count);
+
+/**
+ * @brief Sorts entries by hash with a stable radix sort, 8 bits at a time.
+ *
+ * @param entries
+ * @param buffer as many entries of scratch memory
+ * @param count
+ */
+static void hashmap_radix_sort(struct hashmap_bulk_entry *entries, struct hashmap_bulk_entry *buffer, size_t count);
+
+/**
+ * @brief Inserts or replaces a value in the current table of a hashmap, ignoring any previous table.
+ *
+ * @param target
+ * @param hash
+ * @param value
+ * @return size_t
+ */
+static size_t hashmap_insert_hashed(struct hashmap_impl *target, u32 hash, const void *value);
+
+/**
+ * @brief Finds the element of a given hash in the previous table of a migrating hashmap, if it still lives there.
+ *
+ * @param target
+ * @param hash
+ * @param out_index receives the index of the element in the previous table
+ * @return true if the element is in the previous table
+ * @return false otherwise
+ */
+static bool hashmap_find_previous(const struct hashmap_impl *target, u32 hash, size_t *out_index);
+
+/**
+ * @brief Returns the value at an index given by a lookup, in the current or the previous table.
+ *
+ * @param target
+ * @param index
+ * @return byte* the value, or NULL if no element has this index
+ */
+static byte *hashmap_value_at(const struct hashmap_impl *target, size_t index);
+
+/**
+ * @brief Merges the elements left in a window of the previous table into the current table, from the back :
+ * elements of the current table are each shifted once, and only those with a larger hash than the window.
+ *
+ * @param target
+ * @param start first index of the window in the previous table
+ * @param end index after the last one of the window
+ * @param nb_moved number of elements of the window that were not removed
+ */
+static void hashmap_migrate_window(struct hashmap_impl *target, size_t start, size_t end, size_t nb_moved);
+
+/**
+ * @brief Moves elements of the previous table into the current one, in the order of their hashes, and
+ * releases the previous table once it is empty.
+ *
+ * @param alloc
+ * @param target
+ * @param nb_visited maximum number of elements of the previous table visited
+ */
+static void hashmap_migration_step(struct allocator alloc, struct hashmap_impl *target, size_t nb_visited);
+
+/**
+ * @brief Releases the previous table of a hashmap and the state of its migration.
+ *
+ * @param alloc
+ * @param target
+ */
+static void hashmap_migration_destroy(struct allocator alloc, struct hashmap_impl *target);
+
+/**
+ * @brief Counts the hashes compared by the binary search of a hash in sorted keys, mirroring array_sorted_find().
+ *
+ * @param keys
+ * @param length
+ * @param hash
+ * @return size_t
+ */
+static size_t hashmap_probe_length(const u32 *keys, size_t length, u32 hash);
+
+/**
+ * @brief Adds the elements of one table of a hashmap to its stats.
+ *
+ * @param table
+ * @param start index of the first element of the table still in use
+ * @param removed elements of the table to skip ; can be NULL
+ * @param current current table, searched first for the elements of a previous one ; can be NULL
+ * @param inout_stats
+ * @param inout_total_probes
+ */
+static void hashmap_stats_of_table(const struct hashmap_impl *table, size_t start, const BITSET removed, const struct hashmap_impl *current,
+        struct hashmap_stats *inout_stats, size_t *inout_total_probes);
+
+/**
+ * @brief Measures the gaps between hashes next to each other once sorted, going through both tables of a
+ * migration at once.
+ *
+ * @param target
+ * @param inout_stats
+ */
+static void hashmap_stats_of_gaps(const struct hashmap_impl *target, struct hashmap_stats *inout_stats);
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -47,9 +153,12 @@ HASHMAP_ANY hashmap_create(
 
     new_hashmap = alloc.malloc(alloc,
             sizeof(*new_hashmap) + (starting_capacity * element_size));
-
+    if (!new_hashmap) {
+        return nullptr;
+    }
 
     *new_hashmap = (struct hashmap_impl) {
+            .migration = nullptr,
             .keys = array_create(alloc,
                     sizeof(*new_hashmap->keys),
                     starting_capacity),
@@ -59,9 +168,104 @@ HASHMAP_ANY hashmap_create(
             .stride = (u32) element_size,
     };
 
+    if (!new_hashmap->keys) {
+        alloc.free(alloc, new_hashmap);
+        return nullptr;
+    }
+
     return &(new_hashmap->data);
 }
 
+/**
+ * @brief Builds a hashmap from an array of keys and the array of their values, in one go.
+ * Keys are all hashed first, then sorted, and values are copied once at their final place : nothing is
+ * shifted and the map is allocated a single time. If a key is given several times, its last value wins.
+ *
+ * @param alloc
+ * @param keys NUL-terminated keys
+ * @param values contiguous values, in the order of the keys
+ * @param element_size
+ * @param count number of keys and values
+ * @return HASHMAP_ANY
+ */
+HASHMAP_ANY hashmap_create_from(
+        struct allocator alloc,
+        const char *const *keys,
+        const void *values,
+        size_t element_size,
+        size_t count)
+{
+    u32 *hashes = nullptr;
+    HASHMAP_ANY new_map = nullptr;
+
+    if (!keys || !values || (count == 0)) {
+        return hashmap_create(alloc, element_size, 1);
+    }
+
+    hashes = alloc.malloc(alloc, count * sizeof(*hashes));
+    if (!hashes) {
+        return nullptr;
+    }
+
+    for (size_t i = 0 ; i < count ; i++) {
+        hashes[i] = hashmap_hash_of(keys[i], 0);
+    }
+
+    new_map = hashmap_create_from_hashed(alloc, hashes, values, element_size, count);
+    alloc.free(alloc, hashes);
+
+    return new_map;
+}
+
+/**
+ * @brief Builds a hashmap from an array of hashes and the array of their values, in one go (see
+ * hashmap_create_from()).
+ *
+ * @param alloc
+ * @param hashes hashes of the keys
+ * @param values contiguous values, in the order of the hashes
+ * @param element_size
+ * @param count number of hashes and values
+ * @return HASHMAP_ANY
+ */
+HASHMAP_ANY hashmap_create_from_hashed(
+        struct allocator alloc,
+        const u32 *hashes,
+        const void *values,
+        size_t element_size,
+        size_t count)
+{
+    struct hashmap_bulk_entry *entries = nullptr;
+    HASHMAP_ANY new_map = nullptr;
+
+    if (!hashes || !values || (count == 0)) {
+        return hashmap_create(alloc, element_size, 1);
+    }
+
+    if (count > UINT32_MAX) {
+        return nullptr;
+    }
+
+    new_map = hashmap_create(alloc, element_size, count);
+    entries = alloc.malloc(alloc, 2 * count * sizeof(*entries));
+    if (!new_map || !entries) {
+        hashmap_destroy(alloc, &new_map);
+        alloc.free(alloc, entries);
+        return nullptr;
+    }
+
+    for (size_t i = 0 ; i < count ; i++) {
+        entries[i] = (struct hashmap_bulk_entry) { .hash = hashes[i], .index = (u32) i };
+    }
+
+    hashmap_radix_sort(entries, entries + count, count);
+    hashmap_fill_sorted(new_map, entries, values, count);
+
+    alloc.free(alloc, entries);
+
+    return new_map;
+}
+
 /**
  * @brief
  *
@@ -80,6 +284,7 @@ void hashmap_destroy(
 
     target = hashmap_impl_of(*map);
 
+    hashmap_migration_destroy(alloc, target);
     array_destroy(alloc, (ARRAY_ANY *) &(target->keys));
     alloc.free(alloc, target);
 
@@ -111,6 +316,10 @@ void hashmap_ensure_capacity(
 
     target = hashmap_impl_of(*map);
 
+    if (target->migration) {
+        hashmap_migration_step(alloc, target, SIZE_MAX);
+    }
+
     needed_size = target->length + additional_capacity;
     if (needed_size < target->capacity) {
         return;
@@ -135,134 +344,215 @@ void hashmap_ensure_capacity(
 }
 
 /**
- * @brief
+ * @brief Grows a hashmap without copying all of its elements at once. When the hashmap is full, a new
+ * table is allocated and the previous one is kept alongside it ; each following call then merges the next
+ * HASHMAP_MIGRATION_STEP elements of the previous table into the new one, in a single pass. The previous table
+ * is released once all of its elements were moved.
+ * While the migration runs, lookups search both tables without modifying either : elements still in the
+ * previous table get indices past hashmap_length(), that hashmap_get() reads like the others. New keys are
+ * inserted in the new table, keys of the previous table are updated in place there, and removals of them are
+ * only marked. hashmap_length() and hashmap_keys() only describe the new table : use hashmap_count() for the
+ * number of elements, and hashmap_finish_migration() before going through the keys.
  *
- * @param key
- * @return u32
+ * @param alloc
+ * @param map
+ * @param additional_capacity
  */
-u32 hashmap_hash_of(
-        const char *key, u32 seed)
+void hashmap_ensure_capacity_incremental(
+        struct allocator alloc,
+        HASHMAP_ANY *map,
+        size_t additional_capacity)
 {
-    return hash_jenkins_one_at_a_time((const byte *) key,
-            c_string_length(key, 128, false), seed);
+    struct hashmap_impl *target = nullptr;
+    size_t needed_size = 0;
+
+    HASHMAP_ANY new_map = nullptr;
+    struct hashmap_migration *migration = nullptr;
+    BITSET removed = nullptr;
+
+    if (!map || !*map || (additional_capacity == 0)) {
+        return;
+    }
+
+    target = hashmap_impl_of(*map);
+
+    if (target->migration) {
+        hashmap_migration_step(alloc, target, HASHMAP_MIGRATION_STEP);
+    }
+
+    if (target->migration) {
+        needed_size = target->length + target->migration->remaining + additional_capacity;
+        if (needed_size >= target->capacity) {
+            // the new table filled up before the end of the migration
+            hashmap_migration_step(alloc, target, SIZE_MAX);
+        } else {
+            return;
+        }
+    }
+
+    needed_size = target->length + additional_capacity;
+    if (needed_size < target->capacity) {
+        return;
+    }
+
+    new_map = hashmap_create(alloc, target->stride, needed_size*2);
+    migration = alloc.malloc(alloc, sizeof(*migration));
+    removed = bitset_create(alloc, MAX(target->length, 1u));
+    if (!new_map || !migration || !removed) {
+        // without its bitset, a migration would move removed elements back : the map keeps its table
+        hashmap_destroy(alloc, &new_map);
+        alloc.free(alloc, migration);
+        bitset_destroy(alloc, &removed);
+        return;
+    }
+
+    *migration = (struct hashmap_migration) {
+            .previous = *map,
+            .next = 0,
+            .remaining = target->length,
+            .removed = removed,
+    };
+
+    hashmap_impl_of(new_map)->migration = migration;
+    *map = new_map;
+
+    hashmap_migration_step(alloc, hashmap_impl_of(new_map), HASHMAP_MIGRATION_STEP);
 }
 
 /**
- * @brief
+ * @brief Moves all elements left in the previous table of a migrating hashmap, and releases it.
  *
+ * @param alloc
  * @param map
- * @param key
- * @return size_t
  */
-size_t hashmap_index_of(
-        HASHMAP_ANY map,
-        const char *key)
+void hashmap_finish_migration(
+        struct allocator alloc,
+        HASHMAP_ANY *map)
 {
-    u32 hash = 0;
+    struct hashmap_impl *target = nullptr;
 
-    if (!map) {
-        return 0;
+    if (!map || !*map) {
+        return;
     }
 
-    if (!key) {
-        return array_length(map);
+    target = hashmap_impl_of(*map);
+    if (target->migration) {
+        hashmap_migration_step(alloc, target, SIZE_MAX);
     }
+}
 
-    hash = hashmap_hash_of(key, 0);
-    return hashmap_index_of_hashed(map, hash);
+/**
+ * @brief Tells if a hashmap still holds elements in a previous table.
+ *
+ * @param map
+ * @return bool
+ */
+bool hashmap_is_migrating(
+        HASHMAP_ANY map)
+{
+    if (!map) {
+        return false;
+    }
+
+    return hashmap_impl_of(map)->migration != nullptr;
 }
 
 /**
- * @brief
+ * @brief Counts the elements of a hashmap, including those still living in a previous table.
  *
  * @param map
- * @param hash
  * @return size_t
  */
-size_t hashmap_index_of_hashed(
-        HASHMAP_ANY map,
-        u32 hash)
+size_t hashmap_count(
+        HASHMAP_ANY map)
 {
     struct hashmap_impl *target = nullptr;
-    bool exists = false;
-    size_t pos = 0;
 
     if (!map) {
         return 0;
     }
 
     target = hashmap_impl_of(map);
-    exists = array_sorted_find(target->keys, &hash_compare, &hash, &pos);
-
-    if (exists) {
-        return pos;
-    } else {
-        return array_length(map);
+    if (target->migration) {
+        return target->length + target->migration->remaining;
     }
+
+    return target->length;
 }
 
 /**
- * @brief
+ * @brief Hashes a whole NUL-terminated string, whatever its length.
  *
- * @param map
  * @param key
- * @param value
+ * @return u32
  */
-size_t hashmap_set(
-        HASHMAP_ANY map,
-        const char *key,
-        void *value)
+u32 hashmap_hash_of(
+        const char *key, u32 seed)
 {
-    u32 hash = 0;
-
-    if (!map) {
-        return 0;
-    }
+    return hash_jenkins_one_at_a_time((const byte *) key,
+            c_string_length(key, SIZE_MAX, false), seed);
+}
 
-    if (!key) {
-        return array_length(map);
-    }
+/**
+ * @brief Hashes a key made of arbitrary bytes.
+ *
+ * @param key
+ * @param length
+ * @param seed
+ * @return u32
+ */
+u32 hashmap_hash_of_bytes(
+        const void *key, size_t length, u32 seed)
+{
+    return hash_jenkins_one_at_a_time((const byte *) key, length, seed);
+}
 
-    hash = hashmap_hash_of(key, 0);
-    return hashmap_set_hashed(map, hash, value);
+/**
+ * @brief Hashes an integer key, without going through its bytes.
+ *
+ * @param key
+ * @param seed
+ * @return u32
+ */
+u32 hashmap_hash_of_u64(
+        u64 key, u32 seed)
+{
+    return hash_integer(key, seed);
 }
 
 /**
- * @brief
+ * @brief Copies the value at an index given by a lookup or an insertion. While a migration runs, this
+ * includes the indices past hashmap_length() of the elements still in the previous table.
  *
  * @param map
- * @param hash
- * @param value
+ * @param index
+ * @param out_value can be NULL
+ * @return true if an element has this index
+ * @return false otherwise
  */
-size_t hashmap_set_hashed(
+bool hashmap_get(
         HASHMAP_ANY map,
-        u32 hash,
-        void *value)
+        size_t index,
+        void *out_value)
 {
     struct hashmap_impl *target = nullptr;
-    bool exists = false;
-    size_t pos = 0;
+    byte *value = nullptr;
 
     if (!map) {
-        return 0;
+        return false;
     }
 
+    target = hashmap_impl_of(map);
+    value = hashmap_value_at(target, index);
     if (!value) {
-        return array_length(map);
+        return false;
     }
 
-    target = hashmap_impl_of(map);
-    exists = array_sorted_find(target->keys, &hash_compare, &hash, &pos);
-
-    if (exists) {
-        bytewise_copy(target->data + (target->stride * pos),
-                value, target->stride);
-    } else {
-        array_insert_value(target->keys, pos, &hash);
-        array_insert_value(map, pos, value);
+    if (out_value) {
+        bytewise_copy(out_value, value, target->stride);
     }
 
-    return pos;
+    return true;
 }
 
 /**
@@ -272,22 +562,22 @@ size_t hashmap_set_hashed(
  * @param key
  * @return size_t
  */
-void hashmap_remove(
+size_t hashmap_index_of(
         HASHMAP_ANY map,
         const char *key)
 {
     u32 hash = 0;
 
     if (!map) {
-        return;
+        return 0;
     }
 
     if (!key) {
-        return;
+        return array_length(map);
     }
 
     hash = hashmap_hash_of(key, 0);
-    hashmap_remove_hashed(map, hash);
+    return hashmap_index_of_hashed(map, hash);
 }
 
 /**
@@ -295,8 +585,9 @@ void hashmap_remove(
  *
  * @param map
  * @param hash
+ * @return size_t
  */
-void hashmap_remove_hashed(
+size_t hashmap_index_of_hashed(
         HASHMAP_ANY map,
         u32 hash)
 {
@@ -304,16 +595,270 @@ void hashmap_remove_hashed(
     size_t pos = 0;
 
     if (!map) {
-        return;
+        return 0;
+    }
+
+    target = hashmap_impl_of(map);
+    if (array_sorted_find(target->keys, &hash_compare, &hash, &pos)) {
+        return pos;
+    }
+
+    if (hashmap_find_previous(target, hash, &pos)) {
+        // elements of the previous table are numbered after the end of the current one
+        return target->length + 1 + pos;
+    }
+
+    return array_length(map);
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ * @param length
+ * @return size_t
+ */
+size_t hashmap_index_of_bytes(
+        HASHMAP_ANY map,
+        const void *key,
+        size_t length)
+{
+    if (!map) {
+        return 0;
+    }
+
+    if (!key) {
+        return array_length(map);
+    }
+
+    return hashmap_index_of_hashed(map, hashmap_hash_of_bytes(key, length, 0));
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ * @return size_t
+ */
+size_t hashmap_index_of_u64(
+        HASHMAP_ANY map,
+        u64 key)
+{
+    if (!map) {
+        return 0;
+    }
+
+    return hashmap_index_of_hashed(map, hashmap_hash_of_u64(key, 0));
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ * @param value
+ */
+size_t hashmap_set(
+        HASHMAP_ANY map,
+        const char *key,
+        void *value)
+{
+    u32 hash = 0;
+
+    if (!map) {
+        return 0;
+    }
+
+    if (!key) {
+        return array_length(map);
+    }
+
+    hash = hashmap_hash_of(key, 0);
+    return hashmap_set_hashed(map, hash, value);
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param hash
+ * @param value
+ */
+size_t hashmap_set_hashed(
+        HASHMAP_ANY map,
+        u32 hash,
+        void *value)
+{
+    struct hashmap_impl *target = nullptr;
+    struct hashmap_impl *previous = nullptr;
+    size_t pos = 0;
+
+    if (!map) {
+        return 0;
+    }
+
+    if (!value) {
+        return array_length(map);
+    }
+
+    target = hashmap_impl_of(map);
+    if (array_sorted_find(target->keys, &hash_compare, &hash, &pos)) {
+        bytewise_copy(target->data + (pos * target->stride), value, target->stride);
+        return pos;
+    }
+
+    if (hashmap_find_previous(target, hash, &pos)) {
+        previous = hashmap_impl_of(target->migration->previous);
+        bytewise_copy(previous->data + (pos * previous->stride), value, previous->stride);
+        return target->length + 1 + pos;
+    }
+
+    // only insertions take room : updates of existing keys were handled above
+    if (target->migration && ((target->length + target->migration->remaining) >= target->capacity)) {
+        // the elements left in the previous table need their room in the new one
+        return array_length(map);
+    }
+
+    return hashmap_insert_hashed(target, hash, value);
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ * @param length
+ * @param value
+ * @return size_t
+ */
+size_t hashmap_set_bytes(
+        HASHMAP_ANY map,
+        const void *key,
+        size_t length,
+        void *value)
+{
+    if (!map) {
+        return 0;
+    }
+
+    if (!key) {
+        return array_length(map);
+    }
+
+    return hashmap_set_hashed(map, hashmap_hash_of_bytes(key, length, 0), value);
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ * @param value
+ * @return size_t
+ */
+size_t hashmap_set_u64(
+        HASHMAP_ANY map,
+        u64 key,
+        void *value)
+{
+    if (!map) {
+        return 0;
+    }
+
+    return hashmap_set_hashed(map, hashmap_hash_of_u64(key, 0), value);
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ * @return size_t
+ */
+void hashmap_remove(
+        HASHMAP_ANY map,
+        const char *key)
+{
+    u32 hash = 0;
+
+    if (!map) {
+        return;
+    }
+
+    if (!key) {
+        return;
+    }
+
+    hash = hashmap_hash_of(key, 0);
+    hashmap_remove_hashed(map, hash);
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param hash
+ */
+void hashmap_remove_hashed(
+        HASHMAP_ANY map,
+        u32 hash)
+{
+    struct hashmap_impl *target = nullptr;
+    size_t pos = 0;
+
+    if (!map) {
+        return;
     }
 
     target = hashmap_impl_of(map);
-    if (!array_sorted_find(target->keys, &hash_compare, &hash, &pos)) {
+    if (array_sorted_find(target->keys, &hash_compare, &hash, &pos)) {
+        array_remove(target->keys, pos);
+        array_remove(map, pos);
         return;
     }
 
-    array_remove(target->keys, pos);
-    array_remove(map, pos);
+    if (hashmap_find_previous(target, hash, &pos)) {
+        bitset_set(target->migration->removed, pos);
+        target->migration->remaining -= 1;
+    }
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ * @param length
+ */
+void hashmap_remove_bytes(
+        HASHMAP_ANY map,
+        const void *key,
+        size_t length)
+{
+    if (!map || !key) {
+        return;
+    }
+
+    hashmap_remove_hashed(map, hashmap_hash_of_bytes(key, length, 0));
+}
+
+/**
+ * @brief
+ *
+ * @param map
+ * @param key
+ */
+void hashmap_remove_u64(
+        HASHMAP_ANY map,
+        u64 key)
+{
+    if (!map) {
+        return;
+    }
+
+    hashmap_remove_hashed(map, hashmap_hash_of_u64(key, 0));
 }
 
 /**
@@ -334,6 +879,126 @@ const ARRAY(u32) hashmap_keys(
     return target->keys;
 }
 
+/**
+ * @brief Starts a walk over the elements of a hashmap, in no particular order. Elements still in the previous
+ * table of a migration come after the others.
+ *
+ * @code
+ * hashmap_iterator it = hashmap_iterate(map);
+ * while (hashmap_iterator_next(&it)) {
+ *     use(it.hash, it.value);
+ * }
+ * @endcode
+ *
+ * @param map
+ * @return hashmap_iterator an iterator placed before the first element
+ */
+hashmap_iterator hashmap_iterate(
+        HASHMAP_ANY map)
+{
+    return (hashmap_iterator) { .map = map };
+}
+
+/**
+ * @brief Moves an iterator to the next element, and fills its hash and value.
+ *
+ * @param iterator
+ * @return true if the iterator is on an element
+ * @return false once all elements were visited
+ */
+bool hashmap_iterator_next(
+        hashmap_iterator *iterator)
+{
+    struct hashmap_impl *target = nullptr;
+    struct hashmap_impl *table = nullptr;
+
+    if (!iterator || !iterator->map) {
+        return false;
+    }
+
+    target = hashmap_impl_of(iterator->map);
+
+    if (!iterator->in_previous) {
+        if (iterator->index < target->length) {
+            iterator->hash = target->keys[iterator->index];
+            iterator->value = target->data + (iterator->index * target->stride);
+            iterator->index += 1;
+            return true;
+        }
+
+        if (!target->migration) {
+            return false;
+        }
+
+        iterator->in_previous = true;
+        iterator->index = target->migration->next;
+    }
+
+    if (!target->migration) {
+        return false;
+    }
+
+    table = hashmap_impl_of(target->migration->previous);
+    while ((iterator->index < table->length) && bitset_test(target->migration->removed, iterator->index)) {
+        iterator->index += 1;
+    }
+
+    if (iterator->index == table->length) {
+        return false;
+    }
+
+    iterator->hash = table->keys[iterator->index];
+    iterator->value = table->data + (iterator->index * table->stride);
+    iterator->index += 1;
+
+    return true;
+}
+
+/**
+ * @brief Measures the load, probe lengths, spread of the hashes and memory footprint of a hashmap. Goes
+ * through all of its elements, without modifying it.
+ *
+ * @param map
+ * @param out_stats
+ * @return true if the stats were filled
+ * @return false otherwise
+ */
+bool hashmap_stats(
+        HASHMAP_ANY map,
+        struct hashmap_stats *out_stats)
+{
+    struct hashmap_impl *target = nullptr;
+    struct hashmap_impl *previous = nullptr;
+    size_t total_probes = 0;
+
+    if (!map || !out_stats) {
+        return false;
+    }
+
+    target = hashmap_impl_of(map);
+    *out_stats = (struct hashmap_stats) {
+            .count = hashmap_count(map),
+            .capacity = target->capacity,
+    };
+
+    hashmap_stats_of_table(target, 0, nullptr, nullptr, out_stats, &total_probes);
+    if (target->migration) {
+        previous = hashmap_impl_of(target->migration->previous);
+        hashmap_stats_of_table(previous, target->migration->next, target->migration->removed, target, out_stats, &total_probes);
+        out_stats->memory_footprint += sizeof(*target->migration)
+                + (bitset_capacity_words(target->migration->removed) * sizeof(u64));
+    }
+
+    hashmap_stats_of_gaps(target, out_stats);
+
+    if (out_stats->count > 0) {
+        out_stats->load_factor = (f32) out_stats->count / (f32) MAX(out_stats->capacity, 1u);
+        out_stats->average_probe_length = (f32) total_probes / (f32) out_stats->count;
+    }
+
+    return true;
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 
@@ -343,7 +1008,735 @@ const ARRAY(u32) hashmap_keys(
  * @param map
  * @return struct hashmap_impl*
  */
-static struct hashmap_impl *hashmap_impl_of(HASHMAP_ANY map)
+struct hashmap_impl *hashmap_impl_of(HASHMAP_ANY map)
 {
     return CONTAINER_OF(map, struct hashmap_impl, data);
 }
+
+// -----------------------------------------------------------------------------
+
+static void hashmap_fill_sorted(HASHMAP_ANY map, const struct hashmap_bulk_entry *entries, const byte *values, size_t count)
+{
+    struct hashmap_impl *target = hashmap_impl_of(map);
+    size_t length = 0;
+
+    for (size_t i = 0 ; i < count ; i++) {
+        if ((i + 1 < count) && (entries[i + 1].hash == entries[i].hash)) {
+            continue;
+        }
+
+        target->keys[length] = entries[i].hash;
+        bytewise_copy(target->data + (length * target->stride),
+                values + ((size_t) entries[i].index * target->stride), target->stride);
+        length += 1;
+    }
+
+    target->length = length;
+    array_impl_of(target->keys)->length = length;
+}
+
+// -----------------------------------------------------------------------------
+
+static void hashmap_radix_sort(struct hashmap_bulk_entry *entries, struct hashmap_bulk_entry *buffer, size_t count)
+{
+    struct hashmap_bulk_entry *source = entries;
+    struct hashmap_bulk_entry *destination = buffer;
+    struct hashmap_bulk_entry *swap = nullptr;
+    size_t offsets[256] = { 0 };
+    size_t total = 0;
+    size_t digit_count = 0;
+
+    for (u32 shift = 0 ; shift < 32u ; shift += 8u) {
+        for (size_t i = 0 ; i < 256 ; i++) {
+            offsets[i] = 0;
+        }
+        for (size_t i = 0 ; i < count ; i++) {
+            offsets[(source[i].hash >> shift) & 0xffu] += 1;
+        }
+
+        total = 0;
+        for (size_t i = 0 ; i < 256 ; i++) {
+            digit_count = offsets[i];
+            offsets[i] = total;
+            total += digit_count;
+        }
+
+        for (size_t i = 0 ; i < count ; i++) {
+            destination[offsets[(source[i].hash >> shift) & 0xffu]++] = source[i];
+        }
+
+        swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    // an even number of passes : the sorted entries are back in the first array
+}
+
+// -----------------------------------------------------------------------------
+
+static size_t hashmap_insert_hashed(struct hashmap_impl *target, u32 hash, const void *value)
+{
+    size_t pos = 0;
+
+    if (array_sorted_find(target->keys, &hash_compare, &hash, &pos)) {
+        bytewise_copy(target->data + (target->stride * pos),
+                value, target->stride);
+    } else {
+        array_insert_value(target->keys, pos, &hash);
+        array_insert_value(&target->data, pos, value);
+    }
+
+    return pos;
+}
+
+// -----------------------------------------------------------------------------
+
+static bool hashmap_find_previous(const struct hashmap_impl *target, u32 hash, size_t *out_index)
+{
+    struct hashmap_migration *migration = target->migration;
+    size_t index = 0;
+
+    if (!migration) {
+        return false;
+    }
+
+    // elements before `next` were merged into the current table
+    if (!array_sorted_find(hashmap_impl_of(migration->previous)->keys, &hash_compare, &hash, &index)
+            || (index < migration->next) || bitset_test(migration->removed, index)) {
+        return false;
+    }
+
+    *out_index = index;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+static byte *hashmap_value_at(const struct hashmap_impl *target, size_t index)
+{
+    struct hashmap_migration *migration = target->migration;
+    struct hashmap_impl *previous = nullptr;
+
+    if (index < target->length) {
+        return (byte *) target->data + (index * target->stride);
+    }
+
+    if (!migration || (index == target->length)) {
+        return nullptr;
+    }
+
+    previous = hashmap_impl_of(migration->previous);
+    index -= target->length + 1;
+    if ((index < migration->next) || (index >= previous->length) || bitset_test(migration->removed, index)) {
+        return nullptr;
+    }
+
+    return previous->data + (index * previous->stride);
+}
+
+// -----------------------------------------------------------------------------
+
+static void hashmap_migrate_window(struct hashmap_impl *target, size_t start, size_t end, size_t nb_moved)
+{
+    struct hashmap_migration *migration = target->migration;
+    struct hashmap_impl *previous = hashmap_impl_of(migration->previous);
+    size_t from_current = target->length;
+    size_t from_previous = end;
+    size_t to = target->length + nb_moved;
+
+    target->length += nb_moved;
+    array_impl_of(target->keys)->length += nb_moved;
+
+    // once the window is placed, the smaller elements of the current table are already where they belong
+    while (nb_moved > 0) {
+        while ((from_previous > start) && bitset_test(migration->removed, from_previous - 1)) {
+            from_previous -= 1;
+        }
+
+        to -= 1;
+        if ((from_current > 0) && (target->keys[from_current - 1] > previous->keys[from_previous - 1])) {
+            from_current -= 1;
+            target->keys[to] = target->keys[from_current];
+            bytewise_copy(target->data + (to * target->stride), target->data + (from_current * target->stride), target->stride);
+        } else {
+            from_previous -= 1;
+            target->keys[to] = previous->keys[from_previous];
+            bytewise_copy(target->data + (to * target->stride), previous->data + (from_previous * previous->stride), target->stride);
+            nb_moved -= 1;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+static void hashmap_migration_step(struct allocator alloc, struct hashmap_impl *target, size_t nb_visited)
+{
+    struct hashmap_migration *migration = target->migration;
+    size_t previous_length = hashmap_impl_of(migration->previous)->length;
+    size_t end = migration->next;
+    size_t nb_moved = 0;
+
+    while ((nb_visited > 0) && (end < previous_length)) {
+        nb_moved += !bitset_test(migration->removed, end);
+        end += 1;
+        nb_visited -= 1;
+    }
+
+    hashmap_migrate_window(target, migration->next, end, nb_moved);
+    migration->next = end;
+    migration->remaining -= nb_moved;
+
+    if (migration->remaining == 0) {
+        hashmap_migration_destroy(alloc, target);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+static void hashmap_migration_destroy(struct allocator alloc, struct hashmap_impl *target)
+{
+    if (!target->migration) {
+        return;
+    }
+
+    hashmap_destroy(alloc, &target->migration->previous);
+    bitset_destroy(alloc, &target->migration->removed);
+    alloc.free(alloc, target->migration);
+
+    target->migration = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+static size_t hashmap_probe_length(const u32 *keys, size_t length, u32 hash)
+{
+    i64 beginning = 0;
+    i64 end = (i64) length - 1;
+    i64 index = 0;
+    size_t nb_probes = 0;
+
+    while (beginning <= end) {
+        index = (i64) CEIL_DIV(beginning + end, 2);
+        nb_probes += 1;
+
+        if (keys[index] == hash) {
+            break;
+        } else if (keys[index] < hash) {
+            beginning = index + 1;
+        } else {
+            end = index - 1;
+        }
+    }
+
+    return nb_probes;
+}
+
+// -----------------------------------------------------------------------------
+
+static void hashmap_stats_of_table(const struct hashmap_impl *table, size_t start, const BITSET removed, const struct hashmap_impl *current,
+        struct hashmap_stats *inout_stats, size_t *inout_total_probes)
+{
+    size_t probes = 0;
+
+    inout_stats->memory_footprint += sizeof(*table) + (table->capacity * table->stride)
+            + sizeof(struct array_impl) + (array_capacity(table->keys) * sizeof(u32));
+
+    for (size_t i = start ; i < table->length ; i++) {
+        if (removed && bitset_test(removed, i)) {
+            continue;
+        }
+
+        probes = hashmap_probe_length(table->keys, table->length, table->keys[i]);
+        if (current) {
+            // lookups miss in the current table before reaching the previous one
+            probes += hashmap_probe_length(current->keys, current->length, table->keys[i]);
+        }
+        *inout_total_probes += probes;
+        inout_stats->max_probe_length = MAX(inout_stats->max_probe_length, probes);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+static void hashmap_stats_of_gaps(const struct hashmap_impl *target, struct hashmap_stats *inout_stats)
+{
+    const struct hashmap_impl *previous = nullptr;
+    size_t in_current = 0;
+    size_t in_previous = 0;
+    size_t previous_length = 0;
+    size_t nb_hashes = 0;
+    u32 last_hash = 0;
+    u32 hash = 0;
+
+    if (target->migration) {
+        previous = hashmap_impl_of(target->migration->previous);
+        in_previous = target->migration->next;
+        previous_length = previous->length;
+    }
+
+    inout_stats->min_hash_gap = UINT32_MAX;
+    inout_stats->max_hash_gap = 0;
+
+    // both tables are sorted : merged, they give all hashes in order
+    for (;;) {
+        while ((in_previous < previous_length) && bitset_test(target->migration->removed, in_previous)) {
+            in_previous += 1;
+        }
+
+        if ((in_current < target->length)
+                && ((in_previous == previous_length) || (target->keys[in_current] < previous->keys[in_previous]))) {
+            hash = target->keys[in_current++];
+        } else if (in_previous < previous_length) {
+            hash = previous->keys[in_previous++];
+        } else {
+            break;
+        }
+
+        if (nb_hashes > 0) {
+            inout_stats->min_hash_gap = MIN(inout_stats->min_hash_gap, hash - last_hash);
+            inout_stats->max_hash_gap = MAX(inout_stats->max_hash_gap, hash - last_hash);
+        }
+        last_hash = hash;
+        nb_hashes += 1;
+    }
+
+    if (nb_hashes < 2) {
+        inout_stats->min_hash_gap = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(hashmap_incremental_growth,
+        {
+            size_t nb_elements;
+            size_t starting_capacity;
+            bool remove_odd;
+        },
+        {
+            HASHMAP(u32) map = hashmap_create(make_system_allocator(), sizeof(u32), data->starting_capacity);
+            bool migrated = false;
+            bool found_all = true;
+            bool found_removed = false;
+            bool sorted = true;
+            size_t expected_count = data->nb_elements;
+            size_t length_before_lookups = 0;
+            size_t pos = 0;
+            u32 value = 0;
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                hashmap_ensure_capacity_incremental(make_system_allocator(), (HASHMAP_ANY *) &map, 1);
+                migrated = migrated || hashmap_is_migrating(map);
+                hashmap_set_hashed(map, i * 2654435761u, &i);
+            }
+            tst_assert(migrated, "no migration was started");
+            tst_assert_equal(data->nb_elements, hashmap_count(map), "count of %ld");
+
+            if (data->remove_odd) {
+                tst_assert(hashmap_is_migrating(map), "migration ended before the removals");
+                for (u32 i = 1 ; i < data->nb_elements ; i += 2) {
+                    hashmap_remove_hashed(map, i * 2654435761u);
+                    expected_count -= 1;
+                }
+                tst_assert_equal(expected_count, hashmap_count(map), "count after removal of %ld");
+
+                hashmap_remove_hashed(map, 1u * 2654435761u);
+                tst_assert_equal(expected_count, hashmap_count(map), "count after a second removal of %ld");
+            }
+
+            length_before_lookups = hashmap_length(map);
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                pos = hashmap_index_of_hashed(map, i * 2654435761u);
+                if (data->remove_odd && (i % 2)) {
+                    found_removed = found_removed || (pos != hashmap_length(map));
+                } else {
+                    found_all = found_all && hashmap_get(map, pos, &value) && (value == i);
+                }
+            }
+            tst_assert(found_all, "lost elements during the migration");
+            tst_assert(!found_removed, "found removed elements");
+            tst_assert_equal(length_before_lookups, hashmap_length(map), "length after the lookups of %ld");
+
+            // updates land in whichever table holds the element
+            for (u32 i = 0 ; i < data->nb_elements ; i += 2) {
+                value = i + 1;
+                hashmap_set_hashed(map, i * 2654435761u, &value);
+            }
+            tst_assert_equal(expected_count, hashmap_count(map), "count after the updates of %ld");
+
+            hashmap_finish_migration(make_system_allocator(), (HASHMAP_ANY *) &map);
+            tst_assert(!hashmap_is_migrating(map), "migration was not finished");
+            tst_assert_equal(expected_count, hashmap_length(map), "length of %ld");
+            tst_assert_equal(expected_count, array_length(hashmap_keys(map)), "number of keys of %ld");
+
+            for (size_t i = 1 ; i < array_length(hashmap_keys(map)) ; i++) {
+                sorted = sorted && (hashmap_keys(map)[i - 1] < hashmap_keys(map)[i]);
+            }
+            tst_assert(sorted, "keys are not sorted");
+
+            found_all = true;
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                if (!data->remove_odd || !(i % 2)) {
+                    found_all = found_all && hashmap_get(map, hashmap_index_of_hashed(map, i * 2654435761u), &value)
+                            && (value == ((i % 2) ? i : i + 1));
+                }
+            }
+            tst_assert(found_all, "lost updates during the migration");
+
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashmap_incremental_growth_small, hashmap_incremental_growth,
+        .nb_elements = 1000,
+        .starting_capacity = 4,
+        .remove_odd = false,
+)
+tst_CREATE_TEST_CASE(hashmap_incremental_growth_large, hashmap_incremental_growth,
+        .nb_elements = 20000,
+        .starting_capacity = 16,
+        .remove_odd = false,
+)
+tst_CREATE_TEST_CASE(hashmap_incremental_growth_removal, hashmap_incremental_growth,
+        .nb_elements = 5000,
+        .starting_capacity = 2490,
+        .remove_odd = true,
+)
+
+tst_CREATE_TEST_SCENARIO(hashmap_incremental_growth_full,
+        {
+            u32 nb_elements;
+        },
+        {
+            HASHMAP(u32) map = hashmap_create(make_system_allocator(), sizeof(u32), data->nb_elements);
+            u32 last_inserted = 0;
+            u32 value = 0;
+            size_t pos = 0;
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                hashmap_set_hashed(map, i * 2654435761u, &i);
+            }
+            hashmap_ensure_capacity_incremental(make_system_allocator(), (HASHMAP_ANY *) &map, 1);
+            tst_assert(hashmap_is_migrating(map), "no migration was started");
+
+            // new keys until the room left for the previous table runs out
+            for (u32 i = data->nb_elements ; hashmap_set_hashed(map, i * 2654435761u, &i) != hashmap_length(map) ; i++) {
+                last_inserted = i;
+            }
+            tst_assert(hashmap_is_migrating(map), "the migration ended");
+            tst_assert(hashmap_index_of_hashed(map, last_inserted * 2654435761u) < hashmap_length(map), "last insertion is not in the new table");
+
+            value = 42;
+            pos = hashmap_set_hashed(map, last_inserted * 2654435761u, &value);
+            tst_assert(pos < hashmap_length(map), "update of the new table refused");
+            tst_assert(hashmap_get(map, hashmap_index_of_hashed(map, last_inserted * 2654435761u), &value) && (value == 42),
+                    "update of the new table lost, value of %d", value);
+
+            value = 43;
+            pos = hashmap_set_hashed(map, (data->nb_elements - 1) * 2654435761u, &value);
+            tst_assert(pos != hashmap_length(map), "update of the previous table refused");
+
+            tst_assert_equal(hashmap_length(map), hashmap_set_hashed(map, (last_inserted + 1) * 2654435761u, &value), "insertion at %ld");
+
+            hashmap_finish_migration(make_system_allocator(), (HASHMAP_ANY *) &map);
+            tst_assert(hashmap_get(map, hashmap_index_of_hashed(map, (data->nb_elements - 1) * 2654435761u), &value) && (value == 43),
+                    "update of the previous table lost, value of %d", value);
+
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashmap_incremental_growth_full_nominal, hashmap_incremental_growth_full,
+        .nb_elements = 500,
+)
+
+/**
+ * @brief Allocator failing once the number of allocations held in its data runs out.
+ */
+static void *hashmap_test_limited_malloc(allocator alloc, size_t size)
+{
+    size_t *budget = alloc.allocator_data;
+
+    if (*budget == 0) {
+        return nullptr;
+    }
+    *budget -= 1;
+
+    return make_system_allocator().malloc(make_system_allocator(), size);
+}
+
+static void hashmap_test_limited_free(allocator alloc, void *ptr)
+{
+    (void) alloc;
+    make_system_allocator().free(make_system_allocator(), ptr);
+}
+
+tst_CREATE_TEST_SCENARIO(hashmap_incremental_growth_failure,
+        {
+            size_t nb_elements;
+            size_t nb_allocations;
+        },
+        {
+            size_t budget = 2;
+            allocator limited = make_system_allocator();
+            HASHMAP(u32) map = nullptr;
+            HASHMAP(u32) before = nullptr;
+            bool found_all = true;
+            u32 value = 0;
+
+            limited.malloc = &hashmap_test_limited_malloc;
+            limited.free = &hashmap_test_limited_free;
+            limited.allocator_data = &budget;
+            map = hashmap_create(limited, sizeof(u32), data->nb_elements);
+            before = map;
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                hashmap_set_hashed(map, i * 2654435761u, &i);
+            }
+
+            budget = data->nb_allocations;
+            hashmap_ensure_capacity_incremental(limited, (HASHMAP_ANY *) &map, 1);
+            tst_assert(map == before, "the map was replaced");
+            tst_assert(!hashmap_is_migrating(map), "a migration was started");
+
+            budget = SIZE_MAX;
+            hashmap_ensure_capacity_incremental(limited, (HASHMAP_ANY *) &map, 1);
+            tst_assert(hashmap_is_migrating(map), "no migration was started");
+
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                found_all = found_all && hashmap_get(map, hashmap_index_of_hashed(map, i * 2654435761u), &value) && (value == i);
+            }
+            tst_assert(found_all, "lost elements");
+
+            hashmap_destroy(limited, (HASHMAP_ANY *) &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashmap_incremental_growth_failure_table, hashmap_incremental_growth_failure,
+        .nb_elements = 300,
+        .nb_allocations = 1,
+)
+tst_CREATE_TEST_CASE(hashmap_incremental_growth_failure_bitset, hashmap_incremental_growth_failure,
+        .nb_elements = 300,
+        .nb_allocations = 3,
+)
+
+tst_CREATE_TEST_SCENARIO(hashmap_binary_keys,
+        {
+            size_t long_key_length;
+            u64 integer_keys[4];
+        },
+        {
+            HASHMAP(u32) map = hashmap_create(make_system_allocator(), sizeof(u32), 16);
+            struct { u32 x; u32 y; } tuple = { 0 };
+            char long_key[512] = { 0 };
+            u32 value = 0;
+
+            // two long strings only differing after their first 128 bytes
+            for (size_t i = 0 ; i < data->long_key_length ; i++) {
+                long_key[i] = 'a';
+            }
+            value = 1;
+            hashmap_set(map, long_key, &value);
+            long_key[data->long_key_length - 1] = 'b';
+            value = 2;
+            hashmap_set(map, long_key, &value);
+            tst_assert_equal(2, hashmap_length(map), "long keys collided, length of %ld");
+            tst_assert(hashmap_get(map, hashmap_index_of(map, long_key), &value) && (value == 2), "long key not found");
+
+            tuple.x = 3;
+            tuple.y = 4;
+            value = 34;
+            hashmap_set_bytes(map, &tuple, sizeof(tuple), &value);
+            tuple.y = 5;
+            value = 35;
+            hashmap_set_bytes(map, &tuple, sizeof(tuple), &value);
+            tst_assert(hashmap_get(map, hashmap_index_of_bytes(map, &tuple, sizeof(tuple)), &value) && (value == 35), "tuple key not found");
+            tuple.y = 4;
+            tst_assert(hashmap_get(map, hashmap_index_of_bytes(map, &tuple, sizeof(tuple)), &value) && (value == 34), "tuple key not found");
+            hashmap_remove_bytes(map, &tuple, sizeof(tuple));
+            tst_assert_equal(hashmap_length(map), hashmap_index_of_bytes(map, &tuple, sizeof(tuple)), "removed tuple key found at %ld");
+
+            for (u32 i = 0 ; i < 4 ; i++) {
+                hashmap_set_u64(map, data->integer_keys[i], &i);
+            }
+            for (u32 i = 0 ; i < 4 ; i++) {
+                tst_assert(hashmap_get(map, hashmap_index_of_u64(map, data->integer_keys[i]), &value) && (value == i), "integer key %d not found", i);
+            }
+            hashmap_remove_u64(map, data->integer_keys[0]);
+            tst_assert_equal(hashmap_length(map), hashmap_index_of_u64(map, data->integer_keys[0]), "removed integer key found at %ld");
+
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashmap_binary_keys_nominal, hashmap_binary_keys,
+        .long_key_length = 300,
+        .integer_keys = { 0, 1, 1ull << 32u, UINT64_MAX },
+)
+
+tst_CREATE_TEST_SCENARIO(hashmap_bulk_build,
+        {
+            u32 nb_elements;
+            u32 nb_distinct;
+        },
+        {
+            ARRAY(u32) hashes = array_create(make_system_allocator(), sizeof(u32), data->nb_elements + 1);
+            ARRAY(u32) values = array_create(make_system_allocator(), sizeof(u32), data->nb_elements + 1);
+            HASHMAP(u32) built = nullptr;
+            HASHMAP(u32) expected = hashmap_create(make_system_allocator(), sizeof(u32), data->nb_elements + 1);
+            bool identical = true;
+            u32 hash = 0;
+
+            // repeated hashes, in no particular order
+            for (u32 i = 0 ; i < data->nb_elements ; i++) {
+                hash = (i % data->nb_distinct) * 2654435761u;
+                array_push(hashes, &hash);
+                array_push(values, &i);
+                hashmap_set_hashed(expected, hash, &i);
+            }
+
+            built = hashmap_create_from_hashed(make_system_allocator(), hashes, values, sizeof(u32), data->nb_elements);
+            tst_assert(built, "build failed");
+            tst_assert_equal(hashmap_length(expected), hashmap_length(built), "length of %ld");
+
+            for (size_t i = 0 ; i < hashmap_length(expected) ; i++) {
+                identical = identical && (hashmap_keys(expected)[i] == hashmap_keys(built)[i]) && (expected[i] == built[i]);
+            }
+            tst_assert(identical, "built map differs from the one filled in a loop");
+
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &built);
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &expected);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &hashes);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &values);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashmap_bulk_build_distinct, hashmap_bulk_build,
+        .nb_elements = 10000,
+        .nb_distinct = 10000,
+)
+tst_CREATE_TEST_CASE(hashmap_bulk_build_duplicates, hashmap_bulk_build,
+        .nb_elements = 10000,
+        .nb_distinct = 37,
+)
+tst_CREATE_TEST_CASE(hashmap_bulk_build_single, hashmap_bulk_build,
+        .nb_elements = 1,
+        .nb_distinct = 1,
+)
+
+tst_CREATE_TEST_SCENARIO(hashmap_bulk_build_strings,
+        {
+            const char *keys[5];
+            u32 values[5];
+        },
+        {
+            HASHMAP(u32) built = hashmap_create_from(make_system_allocator(), data->keys, data->values, sizeof(u32), 5);
+            u32 value = 0;
+
+            tst_assert(built, "build failed");
+            tst_assert_equal(4, hashmap_length(built), "length of %ld");
+            tst_assert(hashmap_get(built, hashmap_index_of(built, data->keys[0]), &value), "first key not found");
+            tst_assert_equal(data->values[4], value, "value of a repeated key of %d");
+            tst_assert(hashmap_get(built, hashmap_index_of(built, data->keys[2]), &value), "third key not found");
+            tst_assert_equal(data->values[2], value, "value of %d");
+
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &built);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashmap_bulk_build_strings_repeated, hashmap_bulk_build_strings,
+        .keys = { "width", "height", "depth", "mass", "width" },
+        .values = { 1, 2, 3, 4, 5 },
+)
+
+tst_CREATE_TEST_SCENARIO(hashmap_iteration,
+        {
+            size_t nb_elements;
+            size_t starting_capacity;
+        },
+        {
+            HASHMAP(u64) map = hashmap_create(make_system_allocator(), sizeof(u64), data->starting_capacity);
+            hashmap_iterator it = { 0 };
+            struct hashmap_stats stats = { 0 };
+            size_t nb_visited = 0;
+            size_t max_probes = 0;
+            u64 value = 0;
+            u64 sum = 0;
+            u64 expected_sum = 0;
+            bool consistent = true;
+
+            for (u64 i = 0 ; i < data->nb_elements ; i++) {
+                hashmap_ensure_capacity_incremental(make_system_allocator(), (HASHMAP_ANY *) &map, 1);
+                hashmap_set_u64(map, i, &i);
+                expected_sum += i;
+            }
+
+            it = hashmap_iterate(map);
+            while (hashmap_iterator_next(&it)) {
+                // values of hashmaps are not aligned for u64
+                bytewise_copy(&value, it.value, sizeof(value));
+                consistent = consistent && (it.hash == hashmap_hash_of_u64(value, 0));
+                sum += value;
+                nb_visited += 1;
+            }
+            tst_assert(consistent, "iterated hashes do not match their values");
+            tst_assert_equal(hashmap_count(map), nb_visited, "visited %ld elements");
+            tst_assert_equal(expected_sum, sum, "sum of %ld");
+
+            tst_assert(hashmap_stats(map, &stats), "no stats");
+            tst_assert_equal(data->nb_elements, stats.count, "counted %ld elements");
+            tst_assert((stats.load_factor > 0.f) == (stats.count > 0), "load factor of %f", (f64) stats.load_factor);
+            tst_assert(stats.average_probe_length <= (f32) stats.max_probe_length, "average probe length of %f", (f64) stats.average_probe_length);
+            tst_assert((stats.min_hash_gap > 0) || (stats.count < 2), "smallest gap of %d", stats.min_hash_gap);
+            tst_assert(stats.min_hash_gap <= stats.max_hash_gap, "smallest gap of %d", stats.min_hash_gap);
+            // the gaps add up to the distance between the smallest and largest hashes
+            tst_assert(((u64) stats.min_hash_gap * (MAX(stats.count, 2u) - 1u)) <= UINT32_MAX, "smallest gap of %d", stats.min_hash_gap);
+            tst_assert(stats.memory_footprint >= stats.capacity * sizeof(u64), "footprint of %ld", stats.memory_footprint);
+
+            hashmap_finish_migration(make_system_allocator(), (HASHMAP_ANY *) &map);
+            tst_assert(hashmap_stats(map, &stats), "no stats");
+            for (size_t length = hashmap_length(map) ; length > 0 ; length /= 2) {
+                max_probes += 1;
+            }
+            tst_assert(stats.max_probe_length <= max_probes, "max probe length of %ld", stats.max_probe_length);
+
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashmap_iteration_migrating, hashmap_iteration,
+        .nb_elements = 3000,
+        .starting_capacity = 10,
+)
+tst_CREATE_TEST_CASE(hashmap_iteration_empty, hashmap_iteration,
+        .nb_elements = 0,
+        .starting_capacity = 10,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void hashmap_execute_unittests(void)
+{
+    tst_run_test_case(hashmap_incremental_growth_small);
+    tst_run_test_case(hashmap_incremental_growth_large);
+    tst_run_test_case(hashmap_incremental_growth_removal);
+    tst_run_test_case(hashmap_incremental_growth_full_nominal);
+    tst_run_test_case(hashmap_incremental_growth_failure_table);
+    tst_run_test_case(hashmap_incremental_growth_failure_bitset);
+    tst_run_test_case(hashmap_binary_keys_nominal);
+    tst_run_test_case(hashmap_bulk_build_distinct);
+    tst_run_test_case(hashmap_bulk_build_duplicates);
+    tst_run_test_case(hashmap_bulk_build_single);
+    tst_run_test_case(hashmap_bulk_build_strings_repeated);
+    tst_run_test_case(hashmap_iteration_migrating);
+    tst_run_test_case(hashmap_iteration_empty);
+}
+
+#endif
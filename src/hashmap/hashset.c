@@ -0,0 +1,339 @@
+
+#include <ustd/hashset.h>
+#include <ustd_impl/array_impl.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+HASHSET hashset_create(allocator alloc, size_t starting_capacity)
+{
+    return array_create(alloc, sizeof(u32), MAX(starting_capacity, 1u));
+}
+
+// -----------------------------------------------------------------------------
+
+void hashset_destroy(allocator alloc, HASHSET *set)
+{
+    array_destroy(alloc, (ARRAY_ANY *) set);
+}
+
+// -----------------------------------------------------------------------------
+
+void hashset_ensure_capacity(allocator alloc, HASHSET *set, size_t additional_capacity)
+{
+    array_ensure_capacity(alloc, (ARRAY_ANY *) set, additional_capacity);
+}
+
+// -----------------------------------------------------------------------------
+
+bool hashset_insert_hashed(HASHSET set, u32 hash)
+{
+    size_t pos = 0;
+
+    if (!set || array_sorted_find(set, &hash_compare, &hash, &pos)) {
+        return false;
+    }
+
+    return array_insert_value(set, pos, &hash);
+}
+
+// -----------------------------------------------------------------------------
+
+bool hashset_contains_hashed(const HASHSET set, u32 hash)
+{
+    size_t pos = 0;
+
+    if (!set) {
+        return false;
+    }
+
+    return array_sorted_find((ARRAY_ANY) set, &hash_compare, &hash, &pos);
+}
+
+// -----------------------------------------------------------------------------
+
+bool hashset_remove_hashed(HASHSET set, u32 hash)
+{
+    size_t pos = 0;
+
+    if (!set || !array_sorted_find(set, &hash_compare, &hash, &pos)) {
+        return false;
+    }
+
+    return array_remove(set, pos);
+}
+
+// -----------------------------------------------------------------------------
+
+bool hashset_insert(HASHSET set, const char *key)
+{
+    if (!key) {
+        return false;
+    }
+
+    return hashset_insert_hashed(set, hashmap_hash_of(key, 0));
+}
+
+// -----------------------------------------------------------------------------
+
+bool hashset_contains(const HASHSET set, const char *key)
+{
+    if (!key) {
+        return false;
+    }
+
+    return hashset_contains_hashed(set, hashmap_hash_of(key, 0));
+}
+
+// -----------------------------------------------------------------------------
+
+bool hashset_remove(HASHSET set, const char *key)
+{
+    if (!key) {
+        return false;
+    }
+
+    return hashset_remove_hashed(set, hashmap_hash_of(key, 0));
+}
+
+// -----------------------------------------------------------------------------
+
+void hashset_union(allocator alloc, HASHSET *dest, const HASHSET source)
+{
+    size_t dest_length = 0;
+    size_t source_length = 0;
+    size_t nb_added = 0;
+    size_t i = 0;
+    size_t j = 0;
+    size_t write = 0;
+
+    if (!dest || !*dest || !source) {
+        return;
+    }
+
+    dest_length = array_length(*dest);
+    source_length = array_length(source);
+
+    // first pass : count the hashes missing from the destination, to merge in place from the end
+    while (j < source_length) {
+        if ((i < dest_length) && ((*dest)[i] < source[j])) {
+            i += 1;
+        } else {
+            nb_added += ((i == dest_length) || ((*dest)[i] != source[j]));
+            j += 1;
+        }
+    }
+
+    if (nb_added == 0) {
+        return;
+    }
+
+    hashset_ensure_capacity(alloc, dest, nb_added);
+    if (array_capacity(*dest) < dest_length + nb_added) {
+        return;
+    }
+
+    i = dest_length;
+    j = source_length;
+    write = dest_length + nb_added;
+    while (j > 0) {
+        if ((i > 0) && ((*dest)[i - 1] > source[j - 1])) {
+            (*dest)[--write] = (*dest)[--i];
+        } else {
+            if ((i > 0) && ((*dest)[i - 1] == source[j - 1])) {
+                i -= 1;
+            }
+            (*dest)[--write] = source[--j];
+        }
+    }
+
+    array_impl_of(*dest)->length = dest_length + nb_added;
+}
+
+// -----------------------------------------------------------------------------
+
+void hashset_intersect(HASHSET dest, const HASHSET source)
+{
+    size_t dest_length = 0;
+    size_t source_length = 0;
+    size_t j = 0;
+    size_t write = 0;
+
+    if (!dest || !source) {
+        return;
+    }
+
+    dest_length = array_length(dest);
+    source_length = array_length(source);
+
+    for (size_t i = 0 ; i < dest_length ; i++) {
+        while ((j < source_length) && (source[j] < dest[i])) {
+            j += 1;
+        }
+        if ((j < source_length) && (source[j] == dest[i])) {
+            dest[write++] = dest[i];
+        }
+    }
+
+    array_impl_of(dest)->length = write;
+}
+
+// -----------------------------------------------------------------------------
+
+void hashset_difference(HASHSET dest, const HASHSET source)
+{
+    size_t dest_length = 0;
+    size_t source_length = 0;
+    size_t j = 0;
+    size_t write = 0;
+
+    if (!dest || !source) {
+        return;
+    }
+
+    dest_length = array_length(dest);
+    source_length = array_length(source);
+
+    for (size_t i = 0 ; i < dest_length ; i++) {
+        while ((j < source_length) && (source[j] < dest[i])) {
+            j += 1;
+        }
+        if ((j == source_length) || (source[j] != dest[i])) {
+            dest[write++] = dest[i];
+        }
+    }
+
+    array_impl_of(dest)->length = write;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+tst_CREATE_TEST_SCENARIO(hashset_algebra,
+        {
+            u32 nb_lhs;
+            u32 lhs_multiple;
+            u32 nb_rhs;
+            u32 rhs_multiple;
+        },
+        {
+            HASHSET lhs = hashset_create(make_system_allocator(), 1);
+            HASHSET rhs = hashset_create(make_system_allocator(), 1);
+            HASHSET both = nullptr;
+            HASHSET only_lhs = nullptr;
+            size_t expected_union = 0;
+            size_t expected_both = 0;
+            bool sorted = true;
+            bool consistent = true;
+            bool in_lhs = false;
+
+            for (u32 i = 0 ; i < data->nb_lhs ; i++) {
+                hashset_ensure_capacity(make_system_allocator(), &lhs, 1);
+                tst_assert(hashset_insert_hashed(lhs, i * data->lhs_multiple), "insert %d failed", i);
+            }
+            tst_assert(!hashset_insert_hashed(lhs, 0), "inserted a hash twice");
+            for (u32 i = 0 ; i < data->nb_rhs ; i++) {
+                hashset_ensure_capacity(make_system_allocator(), &rhs, 1);
+                hashset_insert_hashed(rhs, i * data->rhs_multiple);
+            }
+
+            for (u32 i = 0 ; i < data->nb_lhs * data->lhs_multiple ; i++) {
+                expected_both += ((i % data->lhs_multiple) == 0) && ((i % data->rhs_multiple) == 0) && (i < data->nb_rhs * data->rhs_multiple);
+            }
+            expected_union = data->nb_lhs + data->nb_rhs - expected_both;
+
+            both = hashset_create(make_system_allocator(), 1);
+            hashset_union(make_system_allocator(), &both, lhs);
+            only_lhs = hashset_create(make_system_allocator(), 1);
+            hashset_union(make_system_allocator(), &only_lhs, lhs);
+            tst_assert_equal(data->nb_lhs, array_length(both), "copy length of %ld");
+
+            hashset_intersect(both, rhs);
+            tst_assert_equal(expected_both, array_length(both), "intersection length of %ld");
+            hashset_difference(only_lhs, rhs);
+            tst_assert_equal(data->nb_lhs - expected_both, array_length(only_lhs), "difference length of %ld");
+
+            hashset_union(make_system_allocator(), &lhs, rhs);
+            tst_assert_equal(expected_union, array_length(lhs), "union length of %ld");
+            for (size_t i = 1 ; i < array_length(lhs) ; i++) {
+                sorted = sorted && (lhs[i - 1] < lhs[i]);
+            }
+            tst_assert(sorted, "union is not sorted");
+
+            for (u32 i = 0 ; i < data->nb_rhs ; i++) {
+                in_lhs = (((i * data->rhs_multiple) % data->lhs_multiple) == 0) && ((i * data->rhs_multiple) < data->nb_lhs * data->lhs_multiple);
+                consistent = consistent && hashset_contains_hashed(lhs, i * data->rhs_multiple)
+                        && (hashset_contains_hashed(both, i * data->rhs_multiple) == in_lhs)
+                        && !hashset_contains_hashed(only_lhs, i * data->rhs_multiple);
+            }
+            tst_assert(consistent, "set algebra is inconsistent");
+
+            hashset_destroy(make_system_allocator(), &lhs);
+            hashset_destroy(make_system_allocator(), &rhs);
+            hashset_destroy(make_system_allocator(), &both);
+            hashset_destroy(make_system_allocator(), &only_lhs);
+        }
+)
+
+tst_CREATE_TEST_CASE(hashset_algebra_overlap, hashset_algebra,
+        .nb_lhs = 1000,
+        .lhs_multiple = 2,
+        .nb_rhs = 700,
+        .rhs_multiple = 3,
+)
+tst_CREATE_TEST_CASE(hashset_algebra_disjoint, hashset_algebra,
+        .nb_lhs = 10,
+        .lhs_multiple = 1,
+        .nb_rhs = 10,
+        .rhs_multiple = 100,
+)
+tst_CREATE_TEST_CASE(hashset_algebra_empty_rhs, hashset_algebra,
+        .nb_lhs = 50,
+        .lhs_multiple = 5,
+        .nb_rhs = 0,
+        .rhs_multiple = 1,
+)
+
+tst_CREATE_TEST_SCENARIO(hashset_string_keys,
+        {
+            const char *keys[4];
+        },
+        {
+            HASHSET set = hashset_create(make_system_allocator(), 4);
+
+            for (size_t i = 0 ; i < 4 ; i++) {
+                tst_assert(hashset_insert(set, data->keys[i]), "insert of %s failed", data->keys[i]);
+            }
+            tst_assert(hashset_contains(set, data->keys[2]), "key not found");
+            tst_assert(hashset_remove(set, data->keys[2]), "remove failed");
+            tst_assert(!hashset_contains(set, data->keys[2]), "removed key found");
+            tst_assert(!hashset_remove(set, data->keys[2]), "removed a key twice");
+            tst_assert_equal(3, array_length(set), "length of %ld");
+
+            hashset_destroy(make_system_allocator(), &set);
+            tst_assert(!set, "set not reset");
+        }
+)
+
+tst_CREATE_TEST_CASE(hashset_string_keys_nominal, hashset_string_keys,
+        .keys = { "north", "south", "east", "west" },
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void hashset_execute_unittests(void)
+{
+    tst_run_test_case(hashset_algebra_overlap);
+    tst_run_test_case(hashset_algebra_disjoint);
+    tst_run_test_case(hashset_algebra_empty_rhs);
+    tst_run_test_case(hashset_string_keys_nominal);
+}
+
+#endif
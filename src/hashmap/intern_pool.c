@@ -0,0 +1,629 @@
+
+#include <stdatomic.h>
+#include <threads.h>
+
+#include <ustd/intern_pool.h>
+#include <ustd/hashmap.h>
+
+#ifdef UNITTESTING
+#include <stdio.h>
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Number of entries in the first block of entries. Each following block is twice as large as the previous one.
+#define INTERN_POOL_FIRST_BLOCK (256u)
+/// Number of blocks of entries, enough to give out every u32 id.
+#define INTERN_POOL_MAX_BLOCKS (25u)
+
+/**
+ * @brief Interned string, found from its id.
+ */
+struct intern_entry {
+    const char *string;
+    u32 hash;
+    u32 length;
+};
+
+/**
+ * @brief Memory the strings are copied into.
+ */
+struct intern_chunk {
+    struct intern_chunk *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+/**
+ * @brief Open-addressing table of (id + 1), 0 marking an empty slot. Tables replaced by a larger one are
+ * kept until the pool is destroyed, since readers may still be probing them.
+ */
+struct intern_table {
+    struct intern_table *retired;
+    size_t mask;
+    _Atomic u32 slots[];
+};
+
+/**
+ * @brief Intern pool header. Entries live in blocks of growing sizes that are never re-allocated, so readers
+ * can reach them while new ones are added.
+ */
+struct intern_pool {
+    _Atomic(struct intern_table *) table;
+    _Atomic u32 count;
+    _Atomic(struct intern_entry *) blocks[INTERN_POOL_MAX_BLOCKS];
+
+    struct intern_chunk *chunks;
+    mtx_t lock;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Finds the entry of an id.
+ *
+ * @param pool
+ * @param id
+ * @return struct intern_entry* the entry, or NULL if its block is not allocated
+ */
+static struct intern_entry *intern_pool_entry(const intern_pool *pool, u32 id);
+
+/**
+ * @brief Probes a table for a string.
+ *
+ * @param pool
+ * @param table
+ * @param string
+ * @param length
+ * @param hash
+ * @return u32 the id of the string, or INTERN_POOL_NOT_FOUND
+ */
+static u32 intern_pool_probe(const intern_pool *pool, const struct intern_table *table, const char *string, size_t length, u32 hash);
+
+/**
+ * @brief Allocates an empty table of at least a number of slots.
+ *
+ * @param alloc
+ * @param nb_slots
+ * @return struct intern_table*
+ */
+static struct intern_table *intern_table_create(allocator alloc, size_t nb_slots);
+
+/**
+ * @brief Puts an id in the first free slot of the probe sequence of its hash.
+ *
+ * @param table
+ * @param hash
+ * @param id
+ */
+static void intern_table_place(struct intern_table *table, u32 hash, u32 id);
+
+/**
+ * @brief Replaces the table of a pool by one twice as large, retiring the old one. Must hold the lock.
+ *
+ * @param alloc
+ * @param pool
+ * @return true if the table was replaced
+ * @return false on allocation failure
+ */
+static bool intern_pool_grow(allocator alloc, intern_pool *pool);
+
+/**
+ * @brief Copies a string into the chunks of a pool, followed by a terminator. Must hold the lock.
+ *
+ * @param alloc
+ * @param pool
+ * @param string
+ * @param length
+ * @return const char* the copy, or NULL on allocation failure
+ */
+static const char *intern_pool_copy(allocator alloc, intern_pool *pool, const char *string, size_t length);
+
+/**
+ * @brief Finds the block of an id and the position of the id in it.
+ *
+ * @param id
+ * @param out_offset
+ * @return size_t
+ */
+static size_t intern_pool_block_of(u32 id, size_t *out_offset);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+intern_pool *intern_pool_create(allocator alloc, size_t starting_capacity)
+{
+    intern_pool *new_pool = nullptr;
+    struct intern_table *table = nullptr;
+
+    new_pool = alloc.malloc(alloc, sizeof(*new_pool));
+    table = intern_table_create(alloc, (MAX(starting_capacity, 1u) * 4u) / 3u + 1u);
+
+    if (!new_pool || !table || (mtx_init(&new_pool->lock, mtx_plain) != thrd_success)) {
+        alloc.free(alloc, new_pool);
+        alloc.free(alloc, table);
+        return nullptr;
+    }
+
+    atomic_init(&new_pool->table, table);
+    atomic_init(&new_pool->count, 0);
+    for (size_t i = 0 ; i < INTERN_POOL_MAX_BLOCKS ; i++) {
+        atomic_init(&new_pool->blocks[i], nullptr);
+    }
+    new_pool->chunks = nullptr;
+
+    return new_pool;
+}
+
+// -----------------------------------------------------------------------------
+
+void intern_pool_destroy(allocator alloc, intern_pool **pool)
+{
+    struct intern_table *table = nullptr;
+    struct intern_table *retired = nullptr;
+    struct intern_chunk *chunk = nullptr;
+    struct intern_chunk *next = nullptr;
+
+    if (!pool || !*pool) {
+        return;
+    }
+
+    table = atomic_load_explicit(&(*pool)->table, memory_order_relaxed);
+    while (table) {
+        retired = table->retired;
+        alloc.free(alloc, table);
+        table = retired;
+    }
+
+    chunk = (*pool)->chunks;
+    while (chunk) {
+        next = chunk->next;
+        alloc.free(alloc, chunk);
+        chunk = next;
+    }
+
+    for (size_t i = 0 ; i < INTERN_POOL_MAX_BLOCKS ; i++) {
+        alloc.free(alloc, atomic_load_explicit(&(*pool)->blocks[i], memory_order_relaxed));
+    }
+
+    mtx_destroy(&(*pool)->lock);
+    alloc.free(alloc, *pool);
+
+    *pool = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+u32 intern_pool_intern(allocator alloc, intern_pool *pool, const char *string, size_t length, const char **out_string)
+{
+    struct intern_table *table = nullptr;
+    struct intern_entry *block = nullptr;
+    const char *copy = nullptr;
+    size_t block_index = 0;
+    size_t offset = 0;
+    u32 hash = 0;
+    u32 id = INTERN_POOL_NOT_FOUND;
+
+    if (!pool || (!string && (length > 0)) || (length > UINT32_MAX)) {
+        return INTERN_POOL_NOT_FOUND;
+    }
+
+    hash = hashmap_hash_of_bytes(string, length, 0);
+
+    // already interned : no lock
+    table = atomic_load_explicit(&pool->table, memory_order_acquire);
+    id = intern_pool_probe(pool, table, string, length, hash);
+    if (id != INTERN_POOL_NOT_FOUND) {
+        if (out_string) {
+            *out_string = intern_pool_entry(pool, id)->string;
+        }
+        return id;
+    }
+
+    mtx_lock(&pool->lock);
+
+    // another thread may have interned it while we were waiting
+    table = atomic_load_explicit(&pool->table, memory_order_relaxed);
+    id = intern_pool_probe(pool, table, string, length, hash);
+    if (id != INTERN_POOL_NOT_FOUND) {
+        mtx_unlock(&pool->lock);
+        if (out_string) {
+            *out_string = intern_pool_entry(pool, id)->string;
+        }
+        return id;
+    }
+
+    id = atomic_load_explicit(&pool->count, memory_order_relaxed);
+    if (id == INTERN_POOL_NOT_FOUND) {
+        mtx_unlock(&pool->lock);
+        return INTERN_POOL_NOT_FOUND;
+    }
+
+    if ((((size_t) id + 1u) * 4u > (table->mask + 1u) * 3u) && !intern_pool_grow(alloc, pool)) {
+        mtx_unlock(&pool->lock);
+        return INTERN_POOL_NOT_FOUND;
+    }
+
+    block_index = intern_pool_block_of(id, &offset);
+    block = atomic_load_explicit(&pool->blocks[block_index], memory_order_relaxed);
+    if (!block) {
+        block = alloc.malloc(alloc, ((size_t) INTERN_POOL_FIRST_BLOCK << block_index) * sizeof(*block));
+        if (!block) {
+            mtx_unlock(&pool->lock);
+            return INTERN_POOL_NOT_FOUND;
+        }
+        atomic_store_explicit(&pool->blocks[block_index], block, memory_order_release);
+    }
+
+    copy = intern_pool_copy(alloc, pool, string, length);
+    if (!copy) {
+        mtx_unlock(&pool->lock);
+        return INTERN_POOL_NOT_FOUND;
+    }
+
+    block[offset] = (struct intern_entry) { .string = copy, .hash = hash, .length = (u32) length };
+
+    // the entry is written before its id is published to the readers
+    table = atomic_load_explicit(&pool->table, memory_order_relaxed);
+    intern_table_place(table, hash, id);
+    atomic_store_explicit(&pool->count, id + 1u, memory_order_release);
+
+    mtx_unlock(&pool->lock);
+
+    if (out_string) {
+        *out_string = copy;
+    }
+
+    return id;
+}
+
+// -----------------------------------------------------------------------------
+
+u32 intern_pool_find(const intern_pool *pool, const char *string, size_t length)
+{
+    if (!pool || (!string && (length > 0)) || (length > UINT32_MAX)) {
+        return INTERN_POOL_NOT_FOUND;
+    }
+
+    return intern_pool_probe(pool, atomic_load_explicit(&pool->table, memory_order_acquire), string, length,
+            hashmap_hash_of_bytes(string, length, 0));
+}
+
+// -----------------------------------------------------------------------------
+
+const char *intern_pool_string(const intern_pool *pool, u32 id)
+{
+    if (!pool || (id >= atomic_load_explicit(&pool->count, memory_order_acquire))) {
+        return nullptr;
+    }
+
+    return intern_pool_entry(pool, id)->string;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t intern_pool_length(const intern_pool *pool, u32 id)
+{
+    if (!pool || (id >= atomic_load_explicit(&pool->count, memory_order_acquire))) {
+        return 0;
+    }
+
+    return intern_pool_entry(pool, id)->length;
+}
+
+// -----------------------------------------------------------------------------
+
+u32 intern_pool_hash(const intern_pool *pool, u32 id)
+{
+    if (!pool || (id >= atomic_load_explicit(&pool->count, memory_order_acquire))) {
+        return 0;
+    }
+
+    return intern_pool_entry(pool, id)->hash;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t intern_pool_count(const intern_pool *pool)
+{
+    if (!pool) {
+        return 0;
+    }
+
+    return atomic_load_explicit(&pool->count, memory_order_acquire);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static struct intern_entry *intern_pool_entry(const intern_pool *pool, u32 id)
+{
+    struct intern_entry *block = nullptr;
+    size_t block_index = 0;
+    size_t offset = 0;
+
+    block_index = intern_pool_block_of(id, &offset);
+    block = atomic_load_explicit(&((intern_pool *) pool)->blocks[block_index], memory_order_acquire);
+
+    return block ? (block + offset) : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+static u32 intern_pool_probe(const intern_pool *pool, const struct intern_table *table, const char *string, size_t length, u32 hash)
+{
+    const struct intern_entry *entry = nullptr;
+    size_t slot = hash & table->mask;
+    u32 stored = 0;
+    bool same = false;
+
+    stored = atomic_load_explicit(&((struct intern_table *) table)->slots[slot], memory_order_acquire);
+    while (stored != 0) {
+        entry = intern_pool_entry(pool, stored - 1u);
+
+        if ((entry->hash == hash) && (entry->length == length)) {
+            same = true;
+            for (size_t i = 0 ; same && (i < length) ; i++) {
+                same = (entry->string[i] == string[i]);
+            }
+            if (same) {
+                return stored - 1u;
+            }
+        }
+
+        slot = (slot + 1u) & table->mask;
+        stored = atomic_load_explicit(&((struct intern_table *) table)->slots[slot], memory_order_acquire);
+    }
+
+    return INTERN_POOL_NOT_FOUND;
+}
+
+// -----------------------------------------------------------------------------
+
+static struct intern_table *intern_table_create(allocator alloc, size_t nb_slots)
+{
+    struct intern_table *new_table = nullptr;
+    size_t nb_slots_pow2 = 16u;
+
+    while (nb_slots_pow2 < nb_slots) {
+        nb_slots_pow2 <<= 1u;
+    }
+
+    new_table = alloc.malloc(alloc, sizeof(*new_table) + (nb_slots_pow2 * sizeof(*new_table->slots)));
+    if (!new_table) {
+        return nullptr;
+    }
+
+    new_table->retired = nullptr;
+    new_table->mask = nb_slots_pow2 - 1u;
+    for (size_t i = 0 ; i < nb_slots_pow2 ; i++) {
+        atomic_init(&new_table->slots[i], 0);
+    }
+
+    return new_table;
+}
+
+// -----------------------------------------------------------------------------
+
+static void intern_table_place(struct intern_table *table, u32 hash, u32 id)
+{
+    size_t slot = hash & table->mask;
+
+    while (atomic_load_explicit(&table->slots[slot], memory_order_relaxed) != 0) {
+        slot = (slot + 1u) & table->mask;
+    }
+
+    atomic_store_explicit(&table->slots[slot], id + 1u, memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+
+static bool intern_pool_grow(allocator alloc, intern_pool *pool)
+{
+    struct intern_table *table = atomic_load_explicit(&pool->table, memory_order_relaxed);
+    struct intern_table *new_table = nullptr;
+    u32 count = atomic_load_explicit(&pool->count, memory_order_relaxed);
+
+    new_table = intern_table_create(alloc, (table->mask + 1u) * 2u);
+    if (!new_table) {
+        return false;
+    }
+
+    for (u32 id = 0 ; id < count ; id++) {
+        intern_table_place(new_table, intern_pool_entry(pool, id)->hash, id);
+    }
+
+    // readers still probing the old table find every string that was interned before the swap
+    new_table->retired = table;
+    atomic_store_explicit(&pool->table, new_table, memory_order_release);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+static const char *intern_pool_copy(allocator alloc, intern_pool *pool, const char *string, size_t length)
+{
+    struct intern_chunk *chunk = pool->chunks;
+    struct intern_chunk *new_chunk = nullptr;
+    size_t size = 0;
+    char *copy = nullptr;
+
+    if (!chunk || ((chunk->size - chunk->used) < length + 1u)) {
+        size = MAX(INTERN_POOL_CHUNK_SIZE, length + 1u);
+        new_chunk = alloc.malloc(alloc, sizeof(*new_chunk) + size);
+        if (!new_chunk) {
+            return nullptr;
+        }
+
+        new_chunk->used = 0;
+        new_chunk->size = size;
+
+        // an oversized string fills its chunk : keep the current one first to go on filling it
+        if (chunk && (size > INTERN_POOL_CHUNK_SIZE)) {
+            new_chunk->next = chunk->next;
+            chunk->next = new_chunk;
+        } else {
+            new_chunk->next = chunk;
+            pool->chunks = new_chunk;
+        }
+        chunk = new_chunk;
+    }
+
+    copy = chunk->data + chunk->used;
+    bytewise_copy(copy, string, length);
+    copy[length] = '\0';
+    chunk->used += length + 1u;
+
+    return copy;
+}
+
+// -----------------------------------------------------------------------------
+
+static size_t intern_pool_block_of(u32 id, size_t *out_offset)
+{
+    // block b starts at id FIRST_BLOCK * (2^b - 1)
+    u64 scaled = ((u64) id / INTERN_POOL_FIRST_BLOCK) + 1u;
+    size_t block_index = (size_t) (63 - __builtin_clzll(scaled));
+
+    *out_offset = (size_t) (id - (INTERN_POOL_FIRST_BLOCK * ((1ull << block_index) - 1u)));
+
+    return block_index;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+/**
+ * @brief Shared state of the threads of the concurrent test.
+ */
+struct test_intern_context {
+    intern_pool *pool;
+    u32 nb_strings;
+    _Atomic bool mismatch;
+};
+
+static int test_intern_worker(void *context)
+{
+    struct test_intern_context *target = (struct test_intern_context *) context;
+    char buffer[32] = { 0 };
+    size_t length = 0;
+    u32 id = 0;
+
+    for (u32 i = 0 ; i < target->nb_strings ; i++) {
+        length = (size_t) snprintf(buffer, sizeof(buffer), "symbol_%u", i % (target->nb_strings / 2u));
+        id = intern_pool_intern(make_system_allocator(), target->pool, buffer, length, nullptr);
+        if ((id == INTERN_POOL_NOT_FOUND) || (intern_pool_find(target->pool, buffer, length) != id)) {
+            atomic_store(&target->mismatch, true);
+        }
+    }
+
+    return 0;
+}
+
+tst_CREATE_TEST_SCENARIO(intern_pool_unique_ids,
+        {
+            u32 nb_strings;
+            size_t starting_capacity;
+        },
+        {
+            intern_pool *pool = intern_pool_create(make_system_allocator(), data->starting_capacity);
+            const char *copy = nullptr;
+            const char *again = nullptr;
+            char buffer[32] = { 0 };
+            size_t length = 0;
+            bool consistent = true;
+            u32 id = 0;
+
+            tst_assert(pool, "pool was not created");
+
+            for (u32 i = 0 ; i < data->nb_strings ; i++) {
+                length = (size_t) snprintf(buffer, sizeof(buffer), "symbol_%u", i);
+                id = intern_pool_intern(make_system_allocator(), pool, buffer, length, &copy);
+                consistent = consistent && (id == i) && (copy == intern_pool_string(pool, id))
+                        && (intern_pool_length(pool, id) == length)
+                        && (intern_pool_hash(pool, id) == hashmap_hash_of(buffer, 0));
+            }
+            tst_assert(consistent, "ids are not given in order");
+            tst_assert_equal(data->nb_strings, intern_pool_count(pool), "count of %ld");
+
+            for (u32 i = 0 ; i < data->nb_strings ; i++) {
+                length = (size_t) snprintf(buffer, sizeof(buffer), "symbol_%u", i);
+                copy = intern_pool_string(pool, i);
+                id = intern_pool_intern(make_system_allocator(), pool, buffer, length, &again);
+                consistent = consistent && (id == i) && (again == copy) && (intern_pool_find(pool, buffer, length) == i);
+                consistent = consistent && (c_string_length(copy, SIZE_MAX, false) == length);
+            }
+            tst_assert(consistent, "strings were interned twice");
+            tst_assert_equal(data->nb_strings, intern_pool_count(pool), "count after interning again of %ld");
+
+            tst_assert_equal(INTERN_POOL_NOT_FOUND, intern_pool_find(pool, "missing", 7), "missing string found as %d");
+            tst_assert_equal(INTERN_POOL_NOT_FOUND, intern_pool_find(pool, "symbol_1", 7), "prefix found as %d");
+            tst_assert(intern_pool_string(pool, data->nb_strings) == nullptr, "string out of the pool");
+
+            id = intern_pool_intern(make_system_allocator(), pool, "", 0, &copy);
+            tst_assert((id == data->nb_strings) && (copy[0] == '\0'), "empty string interned as %d", id);
+
+            intern_pool_destroy(make_system_allocator(), &pool);
+            tst_assert(pool == nullptr, "pool was not reset");
+        }
+)
+
+tst_CREATE_TEST_CASE(intern_pool_unique_ids_small, intern_pool_unique_ids,
+        .nb_strings = 10,
+        .starting_capacity = 100,
+)
+tst_CREATE_TEST_CASE(intern_pool_unique_ids_growing, intern_pool_unique_ids,
+        .nb_strings = 20000,
+        .starting_capacity = 1,
+)
+
+tst_CREATE_TEST_SCENARIO(intern_pool_concurrent,
+        {
+            u32 nb_strings;
+            size_t nb_threads;
+        },
+        {
+            struct test_intern_context context = { 0 };
+            thrd_t threads[8] = { 0 };
+
+            context.pool = intern_pool_create(make_system_allocator(), 16);
+            context.nb_strings = data->nb_strings;
+            atomic_init(&context.mismatch, false);
+
+            for (size_t i = 0 ; i < data->nb_threads ; i++) {
+                thrd_create(threads + i, &test_intern_worker, &context);
+            }
+            for (size_t i = 0 ; i < data->nb_threads ; i++) {
+                thrd_join(threads[i], nullptr);
+            }
+
+            tst_assert(!atomic_load(&context.mismatch), "threads saw different ids");
+            tst_assert_equal(data->nb_strings / 2u, intern_pool_count(context.pool), "count of %ld");
+
+            intern_pool_destroy(make_system_allocator(), &context.pool);
+        }
+)
+
+tst_CREATE_TEST_CASE(intern_pool_concurrent_nominal, intern_pool_concurrent,
+        .nb_strings = 20000,
+        .nb_threads = 8,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void intern_pool_execute_unittests(void)
+{
+    tst_run_test_case(intern_pool_unique_ids_small);
+    tst_run_test_case(intern_pool_unique_ids_growing);
+    tst_run_test_case(intern_pool_concurrent_nominal);
+}
+
+#endif
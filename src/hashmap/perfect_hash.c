@@ -0,0 +1,461 @@
+
+#include <stdio.h>
+
+#include <ustd/perfect_hash.h>
+#include <ustd/hashmap.h>
+#include <ustd/bitset.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Maximum number of full turns of the table a bucket displacement can take.
+#define PERFECT_HASH_MAX_TURNS (64u)
+
+/**
+ * @brief Everything a table needs to know about a key, computed once per build attempt.
+ */
+struct perfect_hash_key {
+    u32 bucket;
+    u32 first;
+    u32 step;
+    u32 fingerprint;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Hashes a key for a table of some size.
+ *
+ * @param key
+ * @param seed
+ * @param nb_keys
+ * @param nb_buckets
+ * @return struct perfect_hash_key
+ */
+static struct perfect_hash_key perfect_hash_key_of(const char *key, u32 seed, u32 nb_keys, u32 nb_buckets);
+
+/**
+ * @brief Computes the slot of a key, given the displacement of its bucket.
+ *
+ * @param key
+ * @param displacement
+ * @param nb_keys
+ * @return u32
+ */
+static u32 perfect_hash_slot_of(const struct perfect_hash_key *key, u32 displacement, u32 nb_keys);
+
+/**
+ * @brief Tries to place all keys with a given seed, filling the displacements and fingerprints.
+ *
+ * @param alloc
+ * @param keys
+ * @param count
+ * @param seed
+ * @param out_displacements
+ * @param out_fingerprints
+ * @return true
+ * @return false
+ */
+static bool perfect_hash_try_build(allocator alloc, const char *const *keys, u32 count, u32 seed, u32 nb_buckets,
+        u32 *out_displacements, u32 *out_fingerprints);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+bool perfect_hash_build(allocator alloc, const char *const *keys, size_t count, perfect_hash *out_table)
+{
+    u32 nb_buckets = 0;
+    u32 *storage = nullptr;
+    u32 seed = 0;
+
+    if (!keys || !out_table || (count == 0) || (count > (UINT32_MAX / PERFECT_HASH_MAX_TURNS))) {
+        return false;
+    }
+
+    nb_buckets = (u32) MAX(CEIL_DIV(count, PERFECT_HASH_BUCKET_SIZE), 1u);
+    storage = alloc.malloc(alloc, (nb_buckets + count) * sizeof(*storage));
+    if (!storage) {
+        return false;
+    }
+
+    for (u32 attempt = 0 ; attempt < PERFECT_HASH_MAX_ATTEMPTS ; attempt++) {
+        seed = hash_integer(attempt, 0x5eedu);
+
+        if (perfect_hash_try_build(alloc, keys, (u32) count, seed, nb_buckets, storage, storage + nb_buckets)) {
+            *out_table = (perfect_hash) {
+                    .seed = seed,
+                    .nb_keys = (u32) count,
+                    .nb_buckets = nb_buckets,
+                    .displacements = storage,
+                    .fingerprints = storage + nb_buckets,
+            };
+            return true;
+        }
+    }
+
+    alloc.free(alloc, storage);
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+void perfect_hash_destroy(allocator alloc, perfect_hash *table)
+{
+    if (!table) {
+        return;
+    }
+
+    // fingerprints live in the same allocation
+    alloc.free(alloc, (void *) table->displacements);
+    *table = (perfect_hash) { 0 };
+}
+
+// -----------------------------------------------------------------------------
+
+size_t perfect_hash_index_of(const perfect_hash *table, const char *key)
+{
+    struct perfect_hash_key hashed = { 0 };
+    u32 slot = 0;
+
+    if (!table || !key || (table->nb_keys == 0)) {
+        return 0;
+    }
+
+    hashed = perfect_hash_key_of(key, table->seed, table->nb_keys, table->nb_buckets);
+    slot = perfect_hash_slot_of(&hashed, table->displacements[hashed.bucket], table->nb_keys);
+
+    if (table->fingerprints[slot] != hashed.fingerprint) {
+        return table->nb_keys;
+    }
+
+    return slot;
+}
+
+// -----------------------------------------------------------------------------
+
+i32 perfect_hash_write_source(const char *path, const perfect_hash *table, const char *name)
+{
+    FILE *file = nullptr;
+    bool written = true;
+
+    if (!path || !table || !name || (table->nb_keys == 0)) {
+        return FILE_OP_CANNOT_WORK;
+    }
+
+    file = fopen(path, "w");
+    if (!file) {
+        return FILE_OP_OPEN_FAILED;
+    }
+
+    written = written && (fprintf(file, "// generated by perfect_hash_write_source(), do not edit\n\n#include <ustd/perfect_hash.h>\n\n") > 0);
+
+    written = written && (fprintf(file, "static const u32 %s_displacements[%u] = {", name, table->nb_buckets) > 0);
+    for (size_t i = 0 ; i < table->nb_buckets ; i++) {
+        written = written && (fprintf(file, "%s%u,", ((i % 8) == 0) ? "\n    " : " ", table->displacements[i]) > 0);
+    }
+    written = written && (fprintf(file, "\n};\n\n") > 0);
+
+    written = written && (fprintf(file, "static const u32 %s_fingerprints[%u] = {", name, table->nb_keys) > 0);
+    for (size_t i = 0 ; i < table->nb_keys ; i++) {
+        written = written && (fprintf(file, "%s0x%08x,", ((i % 8) == 0) ? "\n    " : " ", table->fingerprints[i]) > 0);
+    }
+    written = written && (fprintf(file, "\n};\n\n") > 0);
+
+    written = written && (fprintf(file, "const perfect_hash %s = {\n"
+            "    .seed = 0x%08xu,\n"
+            "    .nb_keys = %uu,\n"
+            "    .nb_buckets = %uu,\n"
+            "    .displacements = %s_displacements,\n"
+            "    .fingerprints = %s_fingerprints,\n"
+            "};\n", name, table->seed, table->nb_keys, table->nb_buckets, name, name) > 0);
+
+    written = (fclose(file) == 0) && written;
+
+    return written ? FILE_OP_OK : FILE_OP_CANNOT_WORK;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static struct perfect_hash_key perfect_hash_key_of(const char *key, u32 seed, u32 nb_keys, u32 nb_buckets)
+{
+    u32 low = hashmap_hash_of(key, seed);
+    u32 high = hashmap_hash_of(key, seed ^ 0x9e3779b9u);
+    u64 full = ((u64) high << 32u) | low;
+
+    return (struct perfect_hash_key) {
+            .bucket = low % nb_buckets,
+            .first = high % nb_keys,
+            .step = hash_integer(full, 1u) % nb_keys,
+            .fingerprint = hash_integer(full, 2u),
+    };
+}
+
+// -----------------------------------------------------------------------------
+
+static u32 perfect_hash_slot_of(const struct perfect_hash_key *key, u32 displacement, u32 nb_keys)
+{
+    u64 turn = displacement / nb_keys;
+    u64 offset = displacement % nb_keys;
+
+    return (u32) ((key->first + (turn * key->step) + offset) % nb_keys);
+}
+
+// -----------------------------------------------------------------------------
+
+static bool perfect_hash_try_build(allocator alloc, const char *const *keys, u32 count, u32 seed, u32 nb_buckets,
+        u32 *out_displacements, u32 *out_fingerprints)
+{
+    struct perfect_hash_key *hashed = nullptr;
+    u32 *bucket_starts = nullptr;
+    u32 *bucket_keys = nullptr;
+    u32 *bucket_order = nullptr;
+    u32 *slots = nullptr;
+    BITSET taken = nullptr;
+    u32 max_bucket_size = 0;
+    u32 nb_ordered = 0;
+    bool success = true;
+
+    hashed = alloc.malloc(alloc, count * sizeof(*hashed));
+    bucket_starts = alloc.malloc(alloc, (nb_buckets + 1) * sizeof(*bucket_starts));
+    bucket_keys = alloc.malloc(alloc, count * sizeof(*bucket_keys));
+    bucket_order = alloc.malloc(alloc, nb_buckets * sizeof(*bucket_order));
+    taken = bitset_create(alloc, count);
+    success = hashed && bucket_starts && bucket_keys && bucket_order && taken;
+
+    // group the keys by bucket
+    if (success) {
+        for (u32 i = 0 ; i <= nb_buckets ; i++) {
+            bucket_starts[i] = 0;
+        }
+        for (u32 i = 0 ; i < count ; i++) {
+            hashed[i] = perfect_hash_key_of(keys[i], seed, count, nb_buckets);
+            bucket_starts[hashed[i].bucket + 1] += 1;
+        }
+        for (u32 i = 0 ; i < nb_buckets ; i++) {
+            max_bucket_size = MAX(max_bucket_size, bucket_starts[i + 1]);
+            bucket_starts[i + 1] += bucket_starts[i];
+        }
+        for (u32 i = 0 ; i < count ; i++) {
+            // bucket_starts[b] is used as a cursor, and ends up at the start of bucket b + 1
+            bucket_keys[bucket_starts[hashed[i].bucket]++] = i;
+        }
+        for (u32 i = nb_buckets ; i > 0 ; i--) {
+            bucket_starts[i] = bucket_starts[i - 1];
+        }
+        bucket_starts[0] = 0;
+
+        // largest buckets are placed first, while the table is still empty
+        for (u32 size = max_bucket_size ; size > 0 ; size--) {
+            for (u32 b = 0 ; b < nb_buckets ; b++) {
+                if (bucket_starts[b + 1] - bucket_starts[b] == size) {
+                    bucket_order[nb_ordered++] = b;
+                }
+            }
+        }
+        for (u32 b = 0 ; b < nb_buckets ; b++) {
+            out_displacements[b] = 0;
+        }
+
+        slots = alloc.malloc(alloc, MAX(max_bucket_size, 1u) * sizeof(*slots));
+        success = (slots != nullptr);
+    }
+
+    for (u32 o = 0 ; success && (o < nb_ordered) ; o++) {
+        u32 bucket = bucket_order[o];
+        u32 size = bucket_starts[bucket + 1] - bucket_starts[bucket];
+        bool placed = false;
+
+        for (u32 displacement = 0 ; !placed && (displacement < count * PERFECT_HASH_MAX_TURNS) ; displacement++) {
+            placed = true;
+            for (u32 k = 0 ; placed && (k < size) ; k++) {
+                slots[k] = perfect_hash_slot_of(hashed + bucket_keys[bucket_starts[bucket] + k], displacement, count);
+                placed = !bitset_test(taken, slots[k]);
+                for (u32 other = 0 ; placed && (other < k) ; other++) {
+                    placed = (slots[other] != slots[k]);
+                }
+            }
+
+            if (placed) {
+                out_displacements[bucket] = displacement;
+                for (u32 k = 0 ; k < size ; k++) {
+                    bitset_set(taken, slots[k]);
+                    out_fingerprints[slots[k]] = hashed[bucket_keys[bucket_starts[bucket] + k]].fingerprint;
+                }
+            }
+        }
+
+        success = placed;
+    }
+
+    alloc.free(alloc, hashed);
+    alloc.free(alloc, bucket_starts);
+    alloc.free(alloc, bucket_keys);
+    alloc.free(alloc, bucket_order);
+    alloc.free(alloc, slots);
+    bitset_destroy(alloc, &taken);
+
+    return success;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+#define TEST_PERFECT_HASH_PATH "ustd_perfect_hash_test.c"
+
+tst_CREATE_TEST_SCENARIO(perfect_hash_generated_keys,
+        {
+            u32 nb_keys;
+        },
+        {
+            ARRAY(char) names = array_create(make_system_allocator(), sizeof(char), (size_t) data->nb_keys * 16u);
+            const char **keys = make_system_allocator().malloc(make_system_allocator(), data->nb_keys * sizeof(*keys));
+            BITSET seen = bitset_create(make_system_allocator(), data->nb_keys);
+            perfect_hash table = { 0 };
+            char name[16] = { 0 };
+            bool permutation = true;
+            size_t slot = 0;
+
+            for (u32 i = 0 ; i < data->nb_keys ; i++) {
+                snprintf(name, sizeof(name), "key_%u", i);
+                array_append_mem(names, name, c_string_length(name, sizeof(name), true));
+            }
+            keys[0] = names;
+            for (u32 i = 1 ; i < data->nb_keys ; i++) {
+                keys[i] = keys[i - 1] + c_string_length(keys[i - 1], sizeof(name), true);
+            }
+
+            tst_assert(perfect_hash_build(make_system_allocator(), keys, data->nb_keys, &table), "build failed");
+            tst_assert_equal(data->nb_keys, table.nb_keys, "%d slots");
+
+            for (u32 i = 0 ; i < data->nb_keys ; i++) {
+                slot = perfect_hash_index_of(&table, keys[i]);
+                permutation = permutation && (slot < data->nb_keys) && !bitset_test(seen, slot);
+                bitset_set(seen, slot);
+            }
+            tst_assert(permutation, "keys do not map to distinct slots");
+            tst_assert_equal(data->nb_keys, perfect_hash_index_of(&table, "not a key"), "missing key found at %ld");
+            tst_assert_equal(data->nb_keys, perfect_hash_index_of(&table, "key_"), "missing key found at %ld");
+
+            perfect_hash_destroy(make_system_allocator(), &table);
+            tst_assert(!table.displacements, "table not reset");
+
+            bitset_destroy(make_system_allocator(), &seen);
+            make_system_allocator().free(make_system_allocator(), keys);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &names);
+        }
+)
+
+tst_CREATE_TEST_CASE(perfect_hash_generated_keys_single, perfect_hash_generated_keys,
+        .nb_keys = 1,
+)
+tst_CREATE_TEST_CASE(perfect_hash_generated_keys_few, perfect_hash_generated_keys,
+        .nb_keys = 7,
+)
+tst_CREATE_TEST_CASE(perfect_hash_generated_keys_many, perfect_hash_generated_keys,
+        .nb_keys = 50000,
+)
+
+tst_CREATE_TEST_SCENARIO(perfect_hash_keywords,
+        {
+            const char *keywords[10];
+        },
+        {
+            perfect_hash table = { 0 };
+            const char *duplicated[3] = { 0 };
+            size_t source_length = 0;
+
+            tst_assert(perfect_hash_build(make_system_allocator(), data->keywords, COUNT_OF(data->keywords), &table), "build failed");
+            tst_assert_equal(FILE_OP_OK, perfect_hash_write_source(TEST_PERFECT_HASH_PATH, &table, "keywords"), "write error %d");
+
+            source_length = file_length(TEST_PERFECT_HASH_PATH);
+            tst_assert(source_length > 0, "empty source");
+            remove(TEST_PERFECT_HASH_PATH);
+
+            perfect_hash_destroy(make_system_allocator(), &table);
+
+            duplicated[0] = data->keywords[0];
+            duplicated[1] = data->keywords[1];
+            duplicated[2] = data->keywords[0];
+            tst_assert(!perfect_hash_build(make_system_allocator(), duplicated, 3, &table), "built a table with duplicate keys");
+        }
+)
+
+tst_CREATE_TEST_CASE(perfect_hash_keywords_c, perfect_hash_keywords,
+        .keywords = { "if", "else", "while", "for", "do", "return", "switch", "case", "break", "continue" },
+)
+
+tst_CREATE_TEST_SCENARIO(perfect_hash_source,
+        {
+            perfect_hash table;
+            const char *expected;
+        },
+        {
+            char source[1024] = { 0 };
+            size_t source_length = 0;
+            size_t expected_length = c_string_length(data->expected, sizeof(source), false);
+            size_t mismatch = 0;
+
+            tst_assert_equal(FILE_OP_OK, perfect_hash_write_source(TEST_PERFECT_HASH_PATH, &data->table, "keywords"), "write error %d");
+            tst_assert_equal(FILE_OP_OK, file_read(TEST_PERFECT_HASH_PATH, (byte *) source, sizeof(source) - 1, &source_length), "read error %d");
+            remove(TEST_PERFECT_HASH_PATH);
+
+            while ((mismatch < source_length) && (mismatch < expected_length) && (source[mismatch] == data->expected[mismatch])) {
+                mismatch += 1;
+            }
+            tst_assert_equal(expected_length, source_length, "source of %ld bytes");
+            tst_assert_equal(expected_length, mismatch, "source differs at byte %ld");
+        }
+)
+
+tst_CREATE_TEST_CASE(perfect_hash_source_wrapped, perfect_hash_source,
+        .table = {
+                .seed = 0xc0ffeeu,
+                .nb_keys = 9,
+                .nb_buckets = 2,
+                .displacements = (u32[]) { 3, 17 },
+                .fingerprints = (u32[]) { 0x1, 0x22, 0x333, 0x4444, 0x55555, 0x666666, 0x7777777, 0x88888888, 0xdeadbeef },
+        },
+        .expected = "// generated by perfect_hash_write_source(), do not edit\n"
+                "\n"
+                "#include <ustd/perfect_hash.h>\n"
+                "\n"
+                "static const u32 keywords_displacements[2] = {\n"
+                "    3, 17,\n"
+                "};\n"
+                "\n"
+                "static const u32 keywords_fingerprints[9] = {\n"
+                "    0x00000001, 0x00000022, 0x00000333, 0x00004444, 0x00055555, 0x00666666, 0x07777777, 0x88888888,\n"
+                "    0xdeadbeef,\n"
+                "};\n"
+                "\n"
+                "const perfect_hash keywords = {\n"
+                "    .seed = 0x00c0ffeeu,\n"
+                "    .nb_keys = 9u,\n"
+                "    .nb_buckets = 2u,\n"
+                "    .displacements = keywords_displacements,\n"
+                "    .fingerprints = keywords_fingerprints,\n"
+                "};\n",
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void perfect_hash_execute_unittests(void)
+{
+    tst_run_test_case(perfect_hash_generated_keys_single);
+    tst_run_test_case(perfect_hash_generated_keys_few);
+    tst_run_test_case(perfect_hash_generated_keys_many);
+    tst_run_test_case(perfect_hash_keywords_c);
+    tst_run_test_case(perfect_hash_source_wrapped);
+}
+
+#endif
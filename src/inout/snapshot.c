@@ -0,0 +1,577 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <ustd/snapshot.h>
+#include <ustd_impl/array_impl.h>
+#include <ustd_impl/hashmap_impl.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// First bytes of every snapshot file.
+#define SNAPSHOT_MAGIC "USTDSNAP"
+/// Written as a native integer, to detect files written with another byte order.
+#define SNAPSHOT_BYTE_ORDER (0x01020304u)
+/// Alignment, in bytes, of the images in the file.
+#define SNAPSHOT_ALIGNMENT (64u)
+
+/**
+ * @brief Kind of container held by a snapshot.
+ */
+enum snapshot_kind {
+    SNAPSHOT_KIND_ARRAY = 1,
+    SNAPSHOT_KIND_HASHMAP = 2,
+};
+
+/**
+ * @brief Header at the start of every snapshot file.
+ */
+struct snapshot_header {
+    char magic[8];
+    u32 version;
+    u32 kind;
+    u32 byte_order;
+    u32 size_word;
+
+    u64 file_size;
+    /// offset of the array image of the keys, or 0 if the snapshot has no keys
+    u64 keys_offset;
+    /// offset of the image of the container
+    u64 image_offset;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Writes a snapshot file : header, keys image (if any), then container image.
+ *
+ * @param path
+ * @param kind
+ * @param keys
+ * @param image_header
+ * @param size_image_header
+ * @param image_data
+ * @param size_image_data
+ * @return i32
+ */
+static i32 snapshot_write(const char *path, enum snapshot_kind kind, const struct array_impl *keys,
+        const void *image_header, size_t size_image_header, const byte *image_data, size_t size_image_data);
+
+/**
+ * @brief Maps a snapshot file and checks its header. The mapping is left writable so it can be patched.
+ *
+ * @param path
+ * @param kind
+ * @param out_snapshot
+ * @return i32
+ */
+static i32 snapshot_map(const char *path, enum snapshot_kind kind, snapshot *out_snapshot);
+
+/**
+ * @brief Writes zeroes to a file until its position is aligned.
+ *
+ * @param file
+ * @return u64 the aligned position
+ */
+static u64 snapshot_pad(FILE *file);
+
+/**
+ * @brief Checks that an image of some length of elements, after a header, fits in a file.
+ * Written so none of the sums and products can wrap around, whatever the file holds.
+ *
+ * @param offset offset of the image in the file
+ * @param size_header size, in bytes, of the header before the elements
+ * @param length number of elements
+ * @param stride size, in bytes, of an element
+ * @param file_size size of the file
+ * @return bool
+ */
+static bool snapshot_fits(u64 offset, u64 size_header, u64 length, u64 stride, u64 file_size);
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+i32 snapshot_write_array(const char *path, const ARRAY_ANY array)
+{
+    struct array_impl *target = nullptr;
+    struct array_impl image = { 0 };
+
+    if (!path || !array) {
+        return FILE_OP_CANNOT_WORK;
+    }
+
+    target = array_impl_of((ARRAY_ANY) array);
+    image = (struct array_impl) { .length = target->length, .capacity = target->length, .stride = target->stride };
+
+    return snapshot_write(path, SNAPSHOT_KIND_ARRAY, nullptr, &image, OFFSET_OF(struct array_impl, data),
+            target->data, target->length * target->stride);
+}
+
+// -----------------------------------------------------------------------------
+
+i32 snapshot_write_hashmap(const char *path, const HASHMAP_ANY map)
+{
+    struct hashmap_impl *target = nullptr;
+    struct hashmap_impl image = { 0 };
+
+    if (!path || !map || hashmap_is_migrating((HASHMAP_ANY) map)) {
+        return FILE_OP_CANNOT_WORK;
+    }
+
+    target = hashmap_impl_of((HASHMAP_ANY) map);
+    image = (struct hashmap_impl) { .migration = nullptr, .keys = nullptr, .length = target->length, .capacity = target->length, .stride = target->stride };
+
+    return snapshot_write(path, SNAPSHOT_KIND_HASHMAP, array_impl_of(target->keys), &image, OFFSET_OF(struct hashmap_impl, data),
+            target->data, target->length * target->stride);
+}
+
+// -----------------------------------------------------------------------------
+
+ARRAY_ANY snapshot_load_array(const char *path, snapshot *out_snapshot, i32 *out_error)
+{
+    struct snapshot_header *header = nullptr;
+    struct array_impl *image = nullptr;
+    i32 error = FILE_OP_OK;
+
+    error = snapshot_map(path, SNAPSHOT_KIND_ARRAY, out_snapshot);
+    if (out_error) {
+        *out_error = error;
+    }
+    if (error != FILE_OP_OK) {
+        return nullptr;
+    }
+
+    header = (struct snapshot_header *) out_snapshot->mapping;
+    image = (struct array_impl *) ((byte *) out_snapshot->mapping + header->image_offset);
+
+    if (mprotect(out_snapshot->mapping, out_snapshot->size, PROT_READ) != 0) {
+        snapshot_unload(out_snapshot);
+        if (out_error) {
+            *out_error = FILE_OP_CANNOT_WORK;
+        }
+        return nullptr;
+    }
+
+    return image->data;
+}
+
+// -----------------------------------------------------------------------------
+
+HASHMAP_ANY snapshot_load_hashmap(const char *path, snapshot *out_snapshot, i32 *out_error)
+{
+    struct snapshot_header *header = nullptr;
+    struct hashmap_impl *image = nullptr;
+    struct array_impl *keys = nullptr;
+    i32 error = FILE_OP_OK;
+
+    error = snapshot_map(path, SNAPSHOT_KIND_HASHMAP, out_snapshot);
+    if (out_error) {
+        *out_error = error;
+    }
+    if (error != FILE_OP_OK) {
+        return nullptr;
+    }
+
+    header = (struct snapshot_header *) out_snapshot->mapping;
+    image = (struct hashmap_impl *) ((byte *) out_snapshot->mapping + header->image_offset);
+    keys = (struct array_impl *) ((byte *) out_snapshot->mapping + header->keys_offset);
+
+    // the only write to the mapping : only the page holding the pointer gets copied
+    image->keys = (ARRAY(u32)) keys->data;
+
+    if (mprotect(out_snapshot->mapping, out_snapshot->size, PROT_READ) != 0) {
+        snapshot_unload(out_snapshot);
+        if (out_error) {
+            *out_error = FILE_OP_CANNOT_WORK;
+        }
+        return nullptr;
+    }
+
+    return image->data;
+}
+
+// -----------------------------------------------------------------------------
+
+void snapshot_unload(snapshot *target)
+{
+    if (!target || !target->mapping) {
+        return;
+    }
+
+    munmap(target->mapping, target->size);
+    *target = (snapshot) { 0 };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static i32 snapshot_write(const char *path, enum snapshot_kind kind, const struct array_impl *keys,
+        const void *image_header, size_t size_image_header, const byte *image_data, size_t size_image_data)
+{
+    FILE *file = nullptr;
+    struct snapshot_header header = { .magic = SNAPSHOT_MAGIC };
+    struct array_impl keys_image = { 0 };
+    bool written = true;
+
+    file = fopen(path, "wb");
+    if (!file) {
+        return FILE_OP_OPEN_FAILED;
+    }
+
+    // the header is written twice : the second time with the offsets known
+    written = written && (fwrite(&header, sizeof(header), 1, file) == 1);
+
+    if (keys) {
+        header.keys_offset = snapshot_pad(file);
+        keys_image = (struct array_impl) { .length = keys->length, .capacity = keys->length, .stride = keys->stride };
+        written = written && (fwrite(&keys_image, OFFSET_OF(struct array_impl, data), 1, file) == 1);
+        written = written && (fwrite(keys->data, keys->stride, keys->length, file) == keys->length);
+    }
+
+    header.image_offset = snapshot_pad(file);
+    written = written && (fwrite(image_header, size_image_header, 1, file) == 1);
+    written = written && (fwrite(image_data, 1, size_image_data, file) == size_image_data);
+
+    header.version = SNAPSHOT_VERSION;
+    header.kind = kind;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.size_word = sizeof(size_t);
+    header.file_size = (u64) ftell(file);
+
+    written = written && (fseek(file, 0, SEEK_SET) == 0);
+    written = written && (fwrite(&header, sizeof(header), 1, file) == 1);
+
+    written = (fclose(file) == 0) && written;
+
+    return written ? FILE_OP_OK : FILE_OP_CANNOT_WORK;
+}
+
+// -----------------------------------------------------------------------------
+
+static i32 snapshot_map(const char *path, enum snapshot_kind kind, snapshot *out_snapshot)
+{
+    int fd = -1;
+    struct stat file_stat = { 0 };
+    struct snapshot_header *header = nullptr;
+    struct array_impl *keys = nullptr;
+    struct array_impl *image = nullptr;
+    size_t size_image_header = 0;
+    void *mapping = nullptr;
+    bool valid = true;
+
+    if (!path || !out_snapshot) {
+        return FILE_OP_CANNOT_WORK;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return FILE_OP_OPEN_FAILED;
+    }
+
+    if ((fstat(fd, &file_stat) != 0) || ((size_t) file_stat.st_size < sizeof(*header))) {
+        close(fd);
+        return FILE_OP_BAD_FORMAT;
+    }
+
+    mapping = mmap(nullptr, (size_t) file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return FILE_OP_OPEN_FAILED;
+    }
+
+    header = (struct snapshot_header *) mapping;
+    size_image_header = (kind == SNAPSHOT_KIND_HASHMAP) ? OFFSET_OF(struct hashmap_impl, data) : OFFSET_OF(struct array_impl, data);
+
+    for (size_t i = 0 ; i < sizeof(header->magic) ; i++) {
+        valid = valid && (header->magic[i] == SNAPSHOT_MAGIC[i]);
+    }
+
+    valid = valid
+            && (header->version == SNAPSHOT_VERSION)
+            && (header->kind == (u32) kind)
+            && (header->byte_order == SNAPSHOT_BYTE_ORDER)
+            && (header->size_word == sizeof(size_t))
+            && (header->file_size == (u64) file_stat.st_size)
+            && ((header->image_offset % SNAPSHOT_ALIGNMENT) == 0)
+            && snapshot_fits(header->image_offset, size_image_header, 0, 0, header->file_size)
+            && ((kind != SNAPSHOT_KIND_HASHMAP)
+                    || (((header->keys_offset % SNAPSHOT_ALIGNMENT) == 0)
+                        && snapshot_fits(header->keys_offset, OFFSET_OF(struct array_impl, data), 0, 0, header->file_size)));
+
+    if (valid) {
+        // the fields shared with arrays sit at the end of the image header
+        // the mapping is read-only once loaded : no room can be left to fill
+        image = (struct array_impl *) ((byte *) mapping + header->image_offset + size_image_header - OFFSET_OF(struct array_impl, data));
+        valid = (image->capacity == image->length)
+                && snapshot_fits(header->image_offset, size_image_header, image->length, image->stride, header->file_size);
+    }
+
+    if (valid && (kind == SNAPSHOT_KIND_HASHMAP)) {
+        // the hashmap reads its keys as u32, one per element, and would follow a migration pointer
+        keys = (struct array_impl *) ((byte *) mapping + header->keys_offset);
+        valid = (((struct hashmap_impl *) ((byte *) mapping + header->image_offset))->migration == nullptr)
+                && (keys->length == image->length)
+                && (keys->capacity == keys->length)
+                && (keys->stride == sizeof(u32))
+                && snapshot_fits(header->keys_offset, OFFSET_OF(struct array_impl, data), keys->length, keys->stride, header->file_size);
+    }
+
+    if (!valid) {
+        munmap(mapping, (size_t) file_stat.st_size);
+        return FILE_OP_BAD_FORMAT;
+    }
+
+    *out_snapshot = (snapshot) { .mapping = mapping, .size = (size_t) file_stat.st_size };
+
+    return FILE_OP_OK;
+}
+
+// -----------------------------------------------------------------------------
+
+static u64 snapshot_pad(FILE *file)
+{
+    long position = ftell(file);
+
+    while ((position % SNAPSHOT_ALIGNMENT) != 0) {
+        fputc(0, file);
+        position += 1;
+    }
+
+    return (u64) position;
+}
+
+// -----------------------------------------------------------------------------
+
+static bool snapshot_fits(u64 offset, u64 size_header, u64 length, u64 stride, u64 file_size)
+{
+    u64 room = 0;
+
+    if ((offset > file_size) || (size_header > (file_size - offset))) {
+        return false;
+    }
+
+    room = file_size - offset - size_header;
+
+    return (stride == 0) || (length <= (room / stride));
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+#define TEST_SNAPSHOT_PATH "ustd_snapshot_test.bin"
+
+tst_CREATE_TEST_SCENARIO(snapshot_array_round_trip,
+        {
+            size_t length;
+        },
+        {
+            ARRAY(u64) array = array_create(make_system_allocator(), sizeof(u64), data->length + 1);
+            ARRAY(u64) loaded = nullptr;
+            snapshot mapped = { 0 };
+            i32 error = FILE_OP_OK;
+            bool same = true;
+
+            for (u64 i = 0 ; i < data->length ; i++) {
+                array_push(array, &(u64) { i * 3u });
+            }
+
+            tst_assert_equal(FILE_OP_OK, snapshot_write_array(TEST_SNAPSHOT_PATH, array), "write error %d");
+            loaded = snapshot_load_array(TEST_SNAPSHOT_PATH, &mapped, &error);
+            tst_assert_equal(FILE_OP_OK, error, "load error %d");
+
+            tst_assert_equal(array_length(array), array_length(loaded), "loaded length of %ld");
+            for (size_t i = 0 ; i < array_length(array) ; i++) {
+                same = same && (array[i] == loaded[i]);
+            }
+            tst_assert(same, "loaded elements differ");
+            tst_assert(!array_push(loaded, &(u64) { 0 }), "pushed in a loaded array");
+
+            snapshot_unload(&mapped);
+            tst_assert(!snapshot_load_hashmap(TEST_SNAPSHOT_PATH, &mapped, &error), "loaded an array as a hashmap");
+            tst_assert_equal(FILE_OP_BAD_FORMAT, error, "load error %d");
+
+            remove(TEST_SNAPSHOT_PATH);
+            array_destroy(make_system_allocator(), (ARRAY_ANY *) &array);
+        }
+)
+
+tst_CREATE_TEST_CASE(snapshot_array_round_trip_nominal, snapshot_array_round_trip,
+        .length = 5000,
+)
+tst_CREATE_TEST_CASE(snapshot_array_round_trip_empty, snapshot_array_round_trip,
+        .length = 0,
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(snapshot_hashmap_round_trip,
+        {
+            const char *keys[8];
+            size_t nb_keys;
+        },
+        {
+            HASHMAP(u32) map = hashmap_create(make_system_allocator(), sizeof(u32), data->nb_keys + 1);
+            HASHMAP(u32) loaded = nullptr;
+            snapshot mapped = { 0 };
+            i32 error = FILE_OP_OK;
+            u32 value = 0;
+
+            for (u32 i = 0 ; i < data->nb_keys ; i++) {
+                hashmap_set(map, data->keys[i], &i);
+            }
+
+            tst_assert_equal(FILE_OP_OK, snapshot_write_hashmap(TEST_SNAPSHOT_PATH, map), "write error %d");
+            loaded = snapshot_load_hashmap(TEST_SNAPSHOT_PATH, &mapped, &error);
+            tst_assert_equal(FILE_OP_OK, error, "load error %d");
+            tst_assert_equal(hashmap_length(map), hashmap_length(loaded), "loaded length of %ld");
+
+            for (u32 i = 0 ; i < data->nb_keys ; i++) {
+                tst_assert(hashmap_get(loaded, hashmap_index_of(loaded, data->keys[i]), &value), "key %s not found", data->keys[i]);
+                tst_assert_equal_ext(i, value, "%d", "value of key %s", data->keys[i]);
+            }
+            tst_assert_equal(hashmap_length(loaded), hashmap_index_of(loaded, "not a key"), "index of a missing key of %ld");
+
+            snapshot_unload(&mapped);
+            remove(TEST_SNAPSHOT_PATH);
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(snapshot_hashmap_round_trip_nominal, snapshot_hashmap_round_trip,
+        .keys = { "alpha", "beta", "gamma", "delta", "epsilon" },
+        .nb_keys = 5,
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(snapshot_hashmap_tampered,
+        {
+            bool in_keys;
+            size_t field_offset;
+            u64 value;
+            size_t value_size;
+        },
+        {
+            HASHMAP(u32) map = hashmap_create(make_system_allocator(), sizeof(u32), 8);
+            struct snapshot_header header = { 0 };
+            snapshot mapped = { 0 };
+            i32 error = FILE_OP_OK;
+            FILE *file = nullptr;
+            u64 position = 0;
+
+            hashmap_set(map, "alpha", &(u32) { 1 });
+            hashmap_set(map, "beta", &(u32) { 2 });
+            tst_assert_equal(FILE_OP_OK, snapshot_write_hashmap(TEST_SNAPSHOT_PATH, map), "write error %d");
+
+            file = fopen(TEST_SNAPSHOT_PATH, "r+b");
+            fread(&header, sizeof(header), 1, file);
+            position = data->in_keys ? header.keys_offset : header.image_offset;
+            fseek(file, (long) (position + data->field_offset), SEEK_SET);
+            fwrite(&data->value, data->value_size, 1, file);
+            fclose(file);
+
+            tst_assert(!snapshot_load_hashmap(TEST_SNAPSHOT_PATH, &mapped, &error), "loaded a tampered file");
+            tst_assert_equal(FILE_OP_BAD_FORMAT, error, "load error %d");
+            tst_assert(!mapped.mapping, "mapping was kept");
+
+            remove(TEST_SNAPSHOT_PATH);
+            hashmap_destroy(make_system_allocator(), (HASHMAP_ANY *) &map);
+        }
+)
+
+tst_CREATE_TEST_CASE(snapshot_hashmap_tampered_keys_stride, snapshot_hashmap_tampered,
+        .in_keys = true,
+        .field_offset = OFFSET_OF(struct array_impl, stride),
+        .value = 1,
+        .value_size = sizeof(u32),
+)
+tst_CREATE_TEST_CASE(snapshot_hashmap_tampered_keys_capacity, snapshot_hashmap_tampered,
+        .in_keys = true,
+        .field_offset = OFFSET_OF(struct array_impl, capacity),
+        .value = 3,
+        .value_size = sizeof(size_t),
+)
+tst_CREATE_TEST_CASE(snapshot_hashmap_tampered_wrapping_length, snapshot_hashmap_tampered,
+        .in_keys = false,
+        .field_offset = OFFSET_OF(struct hashmap_impl, length),
+        .value = 0x4000000000000001u,
+        .value_size = sizeof(u64),
+)
+tst_CREATE_TEST_CASE(snapshot_hashmap_tampered_capacity, snapshot_hashmap_tampered,
+        .in_keys = false,
+        .field_offset = OFFSET_OF(struct hashmap_impl, capacity),
+        .value = 3,
+        .value_size = sizeof(size_t),
+)
+tst_CREATE_TEST_CASE(snapshot_hashmap_tampered_migration, snapshot_hashmap_tampered,
+        .in_keys = false,
+        .field_offset = OFFSET_OF(struct hashmap_impl, migration),
+        .value = 0x1000,
+        .value_size = sizeof(void *),
+)
+
+// -----------------------------------------------------------------------------
+
+tst_CREATE_TEST_SCENARIO(snapshot_load_errors,
+        {
+            const char *content;
+            size_t content_length;
+            i32 expected_error;
+        },
+        {
+            FILE *file = fopen(TEST_SNAPSHOT_PATH, "wb");
+            snapshot mapped = { 0 };
+            i32 error = FILE_OP_OK;
+
+            fwrite(data->content, 1, data->content_length, file);
+            fclose(file);
+
+            tst_assert(!snapshot_load_array(TEST_SNAPSHOT_PATH, &mapped, &error), "loaded a bad file");
+            tst_assert_equal(data->expected_error, error, "load error %d");
+            tst_assert(!mapped.mapping, "mapping was kept");
+
+            remove(TEST_SNAPSHOT_PATH);
+        }
+)
+
+tst_CREATE_TEST_CASE(snapshot_load_errors_text, snapshot_load_errors,
+        .content = "this is not a snapshot, but it is long enough to hold a header",
+        .content_length = 63,
+        .expected_error = FILE_OP_BAD_FORMAT,
+)
+tst_CREATE_TEST_CASE(snapshot_load_errors_short, snapshot_load_errors,
+        .content = "USTDSNAP",
+        .content_length = 8,
+        .expected_error = FILE_OP_BAD_FORMAT,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void snapshot_execute_unittests(void)
+{
+    tst_run_test_case(snapshot_array_round_trip_nominal);
+    tst_run_test_case(snapshot_array_round_trip_empty);
+
+    tst_run_test_case(snapshot_hashmap_round_trip_nominal);
+    tst_run_test_case(snapshot_hashmap_tampered_keys_stride);
+    tst_run_test_case(snapshot_hashmap_tampered_keys_capacity);
+    tst_run_test_case(snapshot_hashmap_tampered_wrapping_length);
+    tst_run_test_case(snapshot_hashmap_tampered_capacity);
+    tst_run_test_case(snapshot_hashmap_tampered_migration);
+
+    tst_run_test_case(snapshot_load_errors_text);
+    tst_run_test_case(snapshot_load_errors_short);
+}
+
+#endif
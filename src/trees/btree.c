@@ -0,0 +1,909 @@
+
+#include <ustd/btree.h>
+
+#ifdef UNITTESTING
+#include <ustd/testutilities.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/// Maximum height of a tree. Nodes are at least half full, so this is far above any reachable height.
+#define BTREE_MAX_DEPTH (48u)
+/// Minimum number of keys a node is made to hold, whatever the size of the keys and values.
+#define BTREE_MIN_CAPACITY (4u)
+
+/**
+ * @brief Node header, followed by the keys, then by the values (leaves) or the children (internal nodes).
+ * Nodes hold room for one more key than their capacity, so they can overflow for the time of a split.
+ */
+struct btree_node {
+    u16 nb_keys;
+    bool is_leaf;
+    /// next leaf, in the order of the keys (leaves)
+    struct btree_node *next;
+    _Alignas(8) byte data[];
+};
+
+/**
+ * @brief Tree header. The layout of the nodes is computed once, from the size of the keys and values.
+ */
+struct btree {
+    /// NULL for trees of `u64` keys
+    comparator_f comparator;
+    u32 key_size;
+    u32 value_size;
+    size_t length;
+    struct btree_node *root;
+
+    u16 leaf_capacity;
+    u16 internal_capacity;
+    /// offset of the values in the data of a leaf
+    size_t values_offset;
+    /// offset of the children in the data of an internal node
+    size_t children_offset;
+    size_t leaf_size;
+    size_t internal_size;
+};
+
+/**
+ * @brief Step of the path from the root to a leaf : a node, and the index of the child taken in it.
+ */
+struct btree_step {
+    struct btree_node *node;
+    size_t index;
+};
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Creates a tree holding an empty leaf as root.
+ *
+ * @param alloc
+ * @param key_size
+ * @param value_size
+ * @param comparator
+ * @return btree*
+ */
+static btree *btree_create_with(allocator alloc, u32 key_size, u32 value_size, comparator_f comparator);
+
+/**
+ * @brief Allocates an empty node.
+ *
+ * @param alloc
+ * @param tree
+ * @param is_leaf
+ * @return struct btree_node*
+ */
+static struct btree_node *btree_node_create(allocator alloc, const btree *tree, bool is_leaf);
+
+/**
+ * @brief Frees a node and all of its descendants.
+ *
+ * @param alloc
+ * @param tree
+ * @param node
+ */
+static void btree_node_destroy(allocator alloc, const btree *tree, struct btree_node *node);
+
+/**
+ * @brief Finds the position of the first key of a node greater than or equal to a key.
+ *
+ * @param tree
+ * @param node
+ * @param key
+ * @param out_found receives true if the key at the position is equal to the searched key
+ * @return size_t
+ */
+static size_t btree_node_search(const btree *tree, const struct btree_node *node, const void *key, bool *out_found);
+
+/**
+ * @brief Walks from the root to the leaf where a key is or would be, recording the path.
+ *
+ * @param tree
+ * @param key
+ * @param out_path receives the nodes crossed, the leaf being last, along with the position of the key in each
+ * @param out_found receives true if the key is in the leaf
+ * @return size_t number of steps in the path
+ */
+static size_t btree_descend(const btree *tree, const void *key, struct btree_step *out_path, bool *out_found);
+
+/**
+ * @brief Makes room for one element at a position of a packed run of elements.
+ *
+ * @param base
+ * @param stride
+ * @param index
+ * @param length
+ */
+static void btree_open(byte *base, size_t stride, size_t index, size_t length);
+
+/**
+ * @brief Removes the element at a position of a packed run of elements.
+ *
+ * @param base
+ * @param stride
+ * @param index
+ * @param length
+ */
+static void btree_close(byte *base, size_t stride, size_t index, size_t length);
+
+/**
+ * @brief Moves the last elements of a node to the start of an empty node of the same kind.
+ *
+ * @param tree
+ * @param node
+ * @param right
+ * @param from
+ */
+static void btree_node_move_tail(const btree *tree, struct btree_node *node, struct btree_node *right, size_t from);
+
+/**
+ * @brief Restores the minimum occupancy of an underfull node, borrowing from or merging with a sibling.
+ *
+ * @param alloc
+ * @param tree
+ * @param parent
+ * @param index index of the node among the children of its parent
+ * @return true if the parent lost a key
+ * @return false otherwise
+ */
+static bool btree_rebalance(allocator alloc, btree *tree, struct btree_node *parent, size_t index);
+
+/**
+ * @brief Appends the content of a node to its left sibling, and removes it from their parent.
+ *
+ * @param alloc
+ * @param tree
+ * @param parent
+ * @param index index of the left sibling among the children of the parent
+ */
+static void btree_merge(allocator alloc, btree *tree, struct btree_node *parent, size_t index);
+
+// -----------------------------------------------------------------------------
+
+static inline byte *btree_key(const btree *tree, const struct btree_node *node, size_t index)
+{
+    return (byte *) node->data + (index * tree->key_size);
+}
+
+static inline byte *btree_value(const btree *tree, const struct btree_node *node, size_t index)
+{
+    return (byte *) node->data + tree->values_offset + (index * tree->value_size);
+}
+
+static inline struct btree_node **btree_children(const btree *tree, const struct btree_node *node)
+{
+    return (struct btree_node **) ((byte *) node->data + tree->children_offset);
+}
+
+static inline bool btree_is_full(const btree *tree, const struct btree_node *node)
+{
+    return node->nb_keys == (node->is_leaf ? tree->leaf_capacity : tree->internal_capacity);
+}
+
+static inline size_t btree_min_keys(const btree *tree, const struct btree_node *node)
+{
+    return (node->is_leaf ? tree->leaf_capacity : tree->internal_capacity) / 2u;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+btree *btree_create(allocator alloc, u32 key_size, u32 value_size, comparator_f comparator)
+{
+    if ((key_size == 0) || !comparator) {
+        return nullptr;
+    }
+
+    return btree_create_with(alloc, key_size, value_size, comparator);
+}
+
+// -----------------------------------------------------------------------------
+
+btree *btree_create_u64(allocator alloc, u32 value_size)
+{
+    return btree_create_with(alloc, sizeof(u64), value_size, nullptr);
+}
+
+// -----------------------------------------------------------------------------
+
+void btree_destroy(allocator alloc, btree **tree)
+{
+    if (!tree || !*tree) {
+        return;
+    }
+
+    btree_node_destroy(alloc, *tree, (*tree)->root);
+    alloc.free(alloc, *tree);
+
+    *tree = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void *btree_insert(allocator alloc, btree *tree, const void *key, const void *value)
+{
+    struct btree_step path[BTREE_MAX_DEPTH] = { 0 };
+    struct btree_node *spares[BTREE_MAX_DEPTH + 1u] = { 0 };
+    struct btree_node *node = nullptr;
+    struct btree_node *right = nullptr;
+    struct btree_node *new_root = nullptr;
+    const void *separator = nullptr;
+    size_t depth = 0;
+    size_t nb_spares = 0;
+    size_t index = 0;
+    size_t middle = 0;
+    byte *inserted = nullptr;
+    bool found = false;
+
+    if (!tree || !key) {
+        return nullptr;
+    }
+
+    depth = btree_descend(tree, key, path, &found);
+    node = path[depth - 1].node;
+
+    if (found) {
+        inserted = btree_value(tree, node, path[depth - 1].index);
+        if (value) {
+            bytewise_copy(inserted, value, tree->value_size);
+        }
+        return inserted;
+    }
+
+    // every full node from the leaf up splits : allocate them all first, so a failure leaves the tree intact
+    while ((nb_spares < depth) && btree_is_full(tree, path[depth - 1u - nb_spares].node)) {
+        spares[nb_spares] = btree_node_create(alloc, tree, nb_spares == 0);
+        if (!spares[nb_spares]) {
+            break;
+        }
+        nb_spares += 1;
+    }
+    if (nb_spares == depth) {
+        new_root = btree_node_create(alloc, tree, false);
+    }
+    if (((nb_spares < depth) && btree_is_full(tree, path[depth - 1u - nb_spares].node))
+            || ((nb_spares == depth) && !new_root)) {
+        for (size_t i = 0 ; i < nb_spares ; i++) {
+            alloc.free(alloc, spares[i]);
+        }
+        return nullptr;
+    }
+
+    // insertion in the leaf
+    index = path[depth - 1].index;
+    btree_open(btree_key(tree, node, 0), tree->key_size, index, node->nb_keys);
+    btree_open(btree_value(tree, node, 0), tree->value_size, index, node->nb_keys);
+    bytewise_copy(btree_key(tree, node, index), key, tree->key_size);
+    if (value) {
+        bytewise_copy(btree_value(tree, node, index), value, tree->value_size);
+    }
+    node->nb_keys += 1;
+    tree->length += 1;
+    inserted = btree_value(tree, node, index);
+
+    if (node->nb_keys <= tree->leaf_capacity) {
+        return inserted;
+    }
+
+    right = spares[0];
+    middle = node->nb_keys / 2u;
+    btree_node_move_tail(tree, node, right, middle);
+    right->next = node->next;
+    node->next = right;
+    if (index >= middle) {
+        inserted = btree_value(tree, right, index - middle);
+    }
+    separator = btree_key(tree, right, 0);
+
+    // insertion of the separators in the parents, splitting them in turn
+    for (size_t level = depth - 1 ; level > 0 ; level--) {
+        node = path[level - 1].node;
+        index = path[level - 1].index;
+
+        btree_open(btree_key(tree, node, 0), tree->key_size, index, node->nb_keys);
+        btree_open((byte *) btree_children(tree, node), sizeof(struct btree_node *), index + 1u, node->nb_keys + 1u);
+        bytewise_copy(btree_key(tree, node, index), separator, tree->key_size);
+        btree_children(tree, node)[index + 1u] = right;
+        node->nb_keys += 1;
+
+        if (node->nb_keys <= tree->internal_capacity) {
+            return inserted;
+        }
+
+        // the middle key goes up, and stays readable in the left node until the parent copies it
+        right = spares[depth - level];
+        middle = node->nb_keys / 2u;
+        btree_node_move_tail(tree, node, right, middle + 1u);
+        node->nb_keys = (u16) middle;
+        separator = btree_key(tree, node, middle);
+    }
+
+    new_root->nb_keys = 1;
+    bytewise_copy(btree_key(tree, new_root, 0), separator, tree->key_size);
+    btree_children(tree, new_root)[0] = tree->root;
+    btree_children(tree, new_root)[1] = right;
+    tree->root = new_root;
+
+    return inserted;
+}
+
+// -----------------------------------------------------------------------------
+
+void *btree_find(const btree *tree, const void *key)
+{
+    struct btree_step path[BTREE_MAX_DEPTH] = { 0 };
+    size_t depth = 0;
+    bool found = false;
+
+    if (!tree || !key) {
+        return nullptr;
+    }
+
+    depth = btree_descend(tree, key, path, &found);
+    if (!found) {
+        return nullptr;
+    }
+
+    return btree_value(tree, path[depth - 1].node, path[depth - 1].index);
+}
+
+// -----------------------------------------------------------------------------
+
+bool btree_remove(allocator alloc, btree *tree, const void *key, void *out_value)
+{
+    struct btree_step path[BTREE_MAX_DEPTH] = { 0 };
+    struct btree_node *node = nullptr;
+    struct btree_node *old_root = nullptr;
+    size_t depth = 0;
+    size_t index = 0;
+    bool found = false;
+
+    if (!tree || !key) {
+        return false;
+    }
+
+    depth = btree_descend(tree, key, path, &found);
+    if (!found) {
+        return false;
+    }
+
+    node = path[depth - 1].node;
+    index = path[depth - 1].index;
+    if (out_value) {
+        bytewise_copy(out_value, btree_value(tree, node, index), tree->value_size);
+    }
+    btree_close(btree_key(tree, node, 0), tree->key_size, index, node->nb_keys);
+    btree_close(btree_value(tree, node, 0), tree->value_size, index, node->nb_keys);
+    node->nb_keys -= 1;
+    tree->length -= 1;
+
+    for (size_t level = depth - 1 ; level > 0 ; level--) {
+        if (path[level].node->nb_keys >= btree_min_keys(tree, path[level].node)) {
+            break;
+        }
+        if (!btree_rebalance(alloc, tree, path[level - 1].node, path[level - 1].index)) {
+            break;
+        }
+    }
+
+    if (!tree->root->is_leaf && (tree->root->nb_keys == 0)) {
+        old_root = tree->root;
+        tree->root = btree_children(tree, old_root)[0];
+        alloc.free(alloc, old_root);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t btree_length(const btree *tree)
+{
+    if (!tree) {
+        return 0;
+    }
+
+    return tree->length;
+}
+
+// -----------------------------------------------------------------------------
+
+bool btree_first(const btree *tree, btree_iterator *out_iterator)
+{
+    const struct btree_node *node = nullptr;
+
+    if (!tree || !out_iterator) {
+        return false;
+    }
+
+    node = tree->root;
+    while (!node->is_leaf) {
+        node = btree_children(tree, node)[0];
+    }
+
+    *out_iterator = (btree_iterator) { .leaf = node, .index = 0, .tree = tree };
+    if (node->nb_keys == 0) {
+        out_iterator->leaf = nullptr;
+    }
+
+    return out_iterator->leaf != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool btree_lower_bound(const btree *tree, const void *key, btree_iterator *out_iterator)
+{
+    struct btree_step path[BTREE_MAX_DEPTH] = { 0 };
+    const struct btree_node *node = nullptr;
+    size_t depth = 0;
+    size_t index = 0;
+    bool found = false;
+
+    if (!tree || !key || !out_iterator) {
+        return false;
+    }
+
+    depth = btree_descend(tree, key, path, &found);
+    node = path[depth - 1].node;
+    index = path[depth - 1].index;
+
+    // every key of the next leaf is greater than the searched one
+    if (index == node->nb_keys) {
+        node = node->next;
+        index = 0;
+    }
+
+    *out_iterator = (btree_iterator) { .leaf = node, .index = index, .tree = tree };
+
+    return node != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool btree_iterator_next(btree_iterator *iterator)
+{
+    const struct btree_node *node = nullptr;
+
+    if (!iterator || !iterator->leaf) {
+        return false;
+    }
+
+    node = iterator->leaf;
+    iterator->index += 1;
+    if (iterator->index == node->nb_keys) {
+        iterator->leaf = node->next;
+        iterator->index = 0;
+    }
+
+    return iterator->leaf != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+const void *btree_iterator_key(const btree_iterator *iterator)
+{
+    if (!iterator || !iterator->leaf) {
+        return nullptr;
+    }
+
+    return btree_key(iterator->tree, iterator->leaf, iterator->index);
+}
+
+// -----------------------------------------------------------------------------
+
+void *btree_iterator_value(const btree_iterator *iterator)
+{
+    if (!iterator || !iterator->leaf) {
+        return nullptr;
+    }
+
+    return btree_value(iterator->tree, iterator->leaf, iterator->index);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+static btree *btree_create_with(allocator alloc, u32 key_size, u32 value_size, comparator_f comparator)
+{
+    btree *new_tree = nullptr;
+    size_t header_size = sizeof(struct btree_node);
+    size_t leaf_capacity = 0;
+    size_t internal_capacity = 0;
+
+    new_tree = alloc.malloc(alloc, sizeof(*new_tree));
+    if (!new_tree) {
+        return nullptr;
+    }
+
+    leaf_capacity = (BTREE_NODE_SIZE - header_size) / ((size_t) key_size + value_size);
+    internal_capacity = (BTREE_NODE_SIZE - header_size - sizeof(struct btree_node *)) / (key_size + sizeof(struct btree_node *));
+
+    *new_tree = (btree) {
+            .comparator = comparator,
+            .key_size = key_size,
+            .value_size = value_size,
+            .length = 0,
+            .leaf_capacity = (u16) MIN(MAX(leaf_capacity, BTREE_MIN_CAPACITY), UINT16_MAX - 1u),
+            .internal_capacity = (u16) MIN(MAX(internal_capacity, BTREE_MIN_CAPACITY), UINT16_MAX - 1u),
+    };
+
+    new_tree->values_offset = CEIL_DIV((new_tree->leaf_capacity + 1u) * (size_t) key_size, 8u) * 8u;
+    new_tree->children_offset = CEIL_DIV((new_tree->internal_capacity + 1u) * (size_t) key_size, 8u) * 8u;
+    new_tree->leaf_size = header_size + new_tree->values_offset + ((new_tree->leaf_capacity + 1u) * (size_t) value_size);
+    new_tree->internal_size = header_size + new_tree->children_offset
+            + ((new_tree->internal_capacity + 2u) * sizeof(struct btree_node *));
+
+    new_tree->root = btree_node_create(alloc, new_tree, true);
+    if (!new_tree->root) {
+        alloc.free(alloc, new_tree);
+        return nullptr;
+    }
+
+    return new_tree;
+}
+
+// -----------------------------------------------------------------------------
+
+static struct btree_node *btree_node_create(allocator alloc, const btree *tree, bool is_leaf)
+{
+    struct btree_node *new_node = nullptr;
+
+    new_node = alloc.malloc(alloc, is_leaf ? tree->leaf_size : tree->internal_size);
+    if (!new_node) {
+        return nullptr;
+    }
+
+    new_node->nb_keys = 0;
+    new_node->is_leaf = is_leaf;
+    new_node->next = nullptr;
+
+    return new_node;
+}
+
+// -----------------------------------------------------------------------------
+
+static void btree_node_destroy(allocator alloc, const btree *tree, struct btree_node *node)
+{
+    if (!node->is_leaf) {
+        for (size_t i = 0 ; i <= node->nb_keys ; i++) {
+            btree_node_destroy(alloc, tree, btree_children(tree, node)[i]);
+        }
+    }
+
+    alloc.free(alloc, node);
+}
+
+// -----------------------------------------------------------------------------
+
+static size_t btree_node_search(const btree *tree, const struct btree_node *node, const void *key, bool *out_found)
+{
+    size_t low = 0;
+    size_t high = node->nb_keys;
+    size_t middle = 0;
+    const u64 *keys = nullptr;
+    u64 searched = 0;
+
+    if (!tree->comparator) {
+        keys = (const u64 *) node->data;
+        bytewise_copy(&searched, key, sizeof(searched));
+
+        while (low < high) {
+            middle = low + ((high - low) / 2u);
+            if (keys[middle] < searched) {
+                low = middle + 1u;
+            } else {
+                high = middle;
+            }
+        }
+
+        *out_found = (low < node->nb_keys) && (keys[low] == searched);
+        return low;
+    }
+
+    while (low < high) {
+        middle = low + ((high - low) / 2u);
+        if (tree->comparator(btree_key(tree, node, middle), key) < 0) {
+            low = middle + 1u;
+        } else {
+            high = middle;
+        }
+    }
+
+    *out_found = (low < node->nb_keys) && (tree->comparator(btree_key(tree, node, low), key) == 0);
+    return low;
+}
+
+// -----------------------------------------------------------------------------
+
+static size_t btree_descend(const btree *tree, const void *key, struct btree_step *out_path, bool *out_found)
+{
+    struct btree_node *node = tree->root;
+    size_t depth = 0;
+    size_t index = 0;
+
+    while (!node->is_leaf) {
+        index = btree_node_search(tree, node, key, out_found);
+        // keys equal to a separator live in the right subtree
+        index += (*out_found) ? 1u : 0u;
+        out_path[depth++] = (struct btree_step) { .node = node, .index = index };
+        node = btree_children(tree, node)[index];
+    }
+
+    index = btree_node_search(tree, node, key, out_found);
+    out_path[depth++] = (struct btree_step) { .node = node, .index = index };
+
+    return depth;
+}
+
+// -----------------------------------------------------------------------------
+
+static void btree_open(byte *base, size_t stride, size_t index, size_t length)
+{
+    for (size_t i = length * stride ; i > index * stride ; i--) {
+        base[i - 1u + stride] = base[i - 1u];
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+static void btree_close(byte *base, size_t stride, size_t index, size_t length)
+{
+    bytewise_copy(base + (index * stride), base + ((index + 1u) * stride), (length - index - 1u) * stride);
+}
+
+// -----------------------------------------------------------------------------
+
+static void btree_node_move_tail(const btree *tree, struct btree_node *node, struct btree_node *right, size_t from)
+{
+    size_t nb_moved = node->nb_keys - from;
+
+    bytewise_copy(btree_key(tree, right, 0), btree_key(tree, node, from), nb_moved * tree->key_size);
+    if (node->is_leaf) {
+        bytewise_copy(btree_value(tree, right, 0), btree_value(tree, node, from), nb_moved * tree->value_size);
+    } else {
+        bytewise_copy(btree_children(tree, right), btree_children(tree, node) + from,
+                (nb_moved + 1u) * sizeof(struct btree_node *));
+    }
+
+    right->nb_keys = (u16) nb_moved;
+    node->nb_keys = (u16) from;
+}
+
+// -----------------------------------------------------------------------------
+
+static bool btree_rebalance(allocator alloc, btree *tree, struct btree_node *parent, size_t index)
+{
+    struct btree_node **children = btree_children(tree, parent);
+    struct btree_node *node = children[index];
+    struct btree_node *left = (index > 0) ? children[index - 1u] : nullptr;
+    struct btree_node *right = (index < parent->nb_keys) ? children[index + 1u] : nullptr;
+    size_t last = 0;
+
+    if (left && (left->nb_keys > btree_min_keys(tree, left))) {
+        last = left->nb_keys - 1u;
+        btree_open(btree_key(tree, node, 0), tree->key_size, 0, node->nb_keys);
+        if (node->is_leaf) {
+            btree_open(btree_value(tree, node, 0), tree->value_size, 0, node->nb_keys);
+            bytewise_copy(btree_key(tree, node, 0), btree_key(tree, left, last), tree->key_size);
+            bytewise_copy(btree_value(tree, node, 0), btree_value(tree, left, last), tree->value_size);
+            bytewise_copy(btree_key(tree, parent, index - 1u), btree_key(tree, node, 0), tree->key_size);
+        } else {
+            btree_open((byte *) btree_children(tree, node), sizeof(struct btree_node *), 0, node->nb_keys + 1u);
+            bytewise_copy(btree_key(tree, node, 0), btree_key(tree, parent, index - 1u), tree->key_size);
+            btree_children(tree, node)[0] = btree_children(tree, left)[last + 1u];
+            bytewise_copy(btree_key(tree, parent, index - 1u), btree_key(tree, left, last), tree->key_size);
+        }
+        left->nb_keys -= 1;
+        node->nb_keys += 1;
+        return false;
+    }
+
+    if (right && (right->nb_keys > btree_min_keys(tree, right))) {
+        last = node->nb_keys;
+        if (node->is_leaf) {
+            bytewise_copy(btree_key(tree, node, last), btree_key(tree, right, 0), tree->key_size);
+            bytewise_copy(btree_value(tree, node, last), btree_value(tree, right, 0), tree->value_size);
+            btree_close(btree_key(tree, right, 0), tree->key_size, 0, right->nb_keys);
+            btree_close(btree_value(tree, right, 0), tree->value_size, 0, right->nb_keys);
+            bytewise_copy(btree_key(tree, parent, index), btree_key(tree, right, 0), tree->key_size);
+        } else {
+            bytewise_copy(btree_key(tree, node, last), btree_key(tree, parent, index), tree->key_size);
+            btree_children(tree, node)[last + 1u] = btree_children(tree, right)[0];
+            bytewise_copy(btree_key(tree, parent, index), btree_key(tree, right, 0), tree->key_size);
+            btree_close(btree_key(tree, right, 0), tree->key_size, 0, right->nb_keys);
+            btree_close((byte *) btree_children(tree, right), sizeof(struct btree_node *), 0, right->nb_keys + 1u);
+        }
+        right->nb_keys -= 1;
+        node->nb_keys += 1;
+        return false;
+    }
+
+    btree_merge(alloc, tree, parent, left ? (index - 1u) : index);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+static void btree_merge(allocator alloc, btree *tree, struct btree_node *parent, size_t index)
+{
+    struct btree_node *left = btree_children(tree, parent)[index];
+    struct btree_node *right = btree_children(tree, parent)[index + 1u];
+    size_t start = left->nb_keys;
+
+    if (left->is_leaf) {
+        bytewise_copy(btree_key(tree, left, start), btree_key(tree, right, 0), right->nb_keys * tree->key_size);
+        bytewise_copy(btree_value(tree, left, start), btree_value(tree, right, 0), right->nb_keys * tree->value_size);
+        left->nb_keys = (u16) (start + right->nb_keys);
+        left->next = right->next;
+    } else {
+        // the separator comes down between the two halves
+        bytewise_copy(btree_key(tree, left, start), btree_key(tree, parent, index), tree->key_size);
+        bytewise_copy(btree_key(tree, left, start + 1u), btree_key(tree, right, 0), right->nb_keys * tree->key_size);
+        bytewise_copy(btree_children(tree, left) + start + 1u, btree_children(tree, right),
+                (right->nb_keys + 1u) * sizeof(struct btree_node *));
+        left->nb_keys = (u16) (start + 1u + right->nb_keys);
+    }
+
+    btree_close(btree_key(tree, parent, 0), tree->key_size, index, parent->nb_keys);
+    btree_close((byte *) btree_children(tree, parent), sizeof(struct btree_node *), index + 1u, parent->nb_keys + 1u);
+    parent->nb_keys -= 1;
+
+    alloc.free(alloc, right);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+#ifdef UNITTESTING
+
+static i32 test_compare_descending(const void *lhs, const void *rhs)
+{
+    i32 a = *(const i32 *) lhs;
+    i32 b = *(const i32 *) rhs;
+
+    return (a < b) - (a > b);
+}
+
+tst_CREATE_TEST_SCENARIO(btree_ordered_map,
+        {
+            u64 nb_keys;
+            u64 step;
+        },
+        {
+            btree *tree = btree_create_u64(make_system_allocator(), sizeof(u64));
+            btree_iterator it = { 0 };
+            u64 key = 0;
+            u64 value = 0;
+            u64 expected = 0;
+            u64 *found = nullptr;
+            bool in_order = true;
+            bool valid = false;
+
+            // keys are inserted in a scattered order : step is coprime with nb_keys
+            for (u64 i = 0 ; i < data->nb_keys ; i++) {
+                key = (i * data->step) % data->nb_keys;
+                value = key * 3u;
+                tst_assert(btree_insert(make_system_allocator(), tree, &key, &value), "insertion of %ld failed", key);
+            }
+            key = 0;
+            value = 7;
+            tst_assert_equal(7, *(u64 *) btree_insert(make_system_allocator(), tree, &key, &value), "replaced value of %ld");
+            tst_assert_equal(data->nb_keys, btree_length(tree), "length of %ld");
+
+            expected = 0;
+            for (valid = btree_first(tree, &it) ; valid ; valid = btree_iterator_next(&it)) {
+                in_order = in_order && (*(const u64 *) btree_iterator_key(&it) == expected);
+                expected += 1;
+            }
+            tst_assert(in_order, "keys are not iterated in order");
+            tst_assert_equal(data->nb_keys, expected, "iterated over %ld keys");
+
+            for (u64 i = 1 ; i < data->nb_keys ; i++) {
+                found = btree_find(tree, &i);
+                tst_assert(found && (*found == i * 3u), "key %ld not found", i);
+            }
+
+            for (u64 i = 0 ; i < data->nb_keys ; i++) {
+                key = (i * data->step) % data->nb_keys;
+                if ((key % 2u) == 0) {
+                    tst_assert(btree_remove(make_system_allocator(), tree, &key, nullptr), "removal of %ld failed", key);
+                }
+            }
+            for (u64 i = 0 ; i < data->nb_keys ; i += 2) {
+                tst_assert(btree_remove(make_system_allocator(), tree, &i, nullptr) == false, "key %ld removed twice", i);
+                tst_assert(btree_find(tree, &i) == nullptr, "removed key %ld found", i);
+            }
+            tst_assert_equal(data->nb_keys / 2u, btree_length(tree), "length after removals of %ld");
+
+            for (u64 i = 0 ; i + 1u < data->nb_keys ; i += 2) {
+                valid = btree_lower_bound(tree, &i, &it);
+                tst_assert(valid && (*(const u64 *) btree_iterator_key(&it) == i + 1u), "lower bound of %ld", i);
+            }
+
+            in_order = true;
+            expected = 1;
+            for (valid = btree_lower_bound(tree, &expected, &it) ; valid ; valid = btree_iterator_next(&it)) {
+                in_order = in_order && (*(const u64 *) btree_iterator_key(&it) == expected)
+                        && (*(const u64 *) btree_iterator_value(&it) == expected * 3u);
+                expected += 2;
+            }
+            tst_assert(in_order, "remaining keys are not iterated in order");
+
+            for (u64 i = 1 ; i < data->nb_keys ; i += 2) {
+                tst_assert(btree_remove(make_system_allocator(), tree, &i, &value) && (value == i * 3u), "removal of %ld failed", i);
+            }
+            tst_assert_equal(0, btree_length(tree), "final length of %ld");
+            tst_assert(btree_first(tree, &it) == false, "empty tree has a first key");
+
+            btree_destroy(make_system_allocator(), &tree);
+            tst_assert(tree == nullptr, "tree was not reset");
+        }
+)
+
+tst_CREATE_TEST_CASE(btree_ordered_map_small, btree_ordered_map,
+        .nb_keys = 10,
+        .step = 3,
+)
+tst_CREATE_TEST_CASE(btree_ordered_map_large, btree_ordered_map,
+        .nb_keys = 20000,
+        .step = 7919,
+)
+tst_CREATE_TEST_CASE(btree_ordered_map_sequential, btree_ordered_map,
+        .nb_keys = 5000,
+        .step = 1,
+)
+
+tst_CREATE_TEST_SCENARIO(btree_comparator_keys,
+        {
+            i32 nb_keys;
+        },
+        {
+            btree *tree = btree_create(make_system_allocator(), sizeof(i32), 0, &test_compare_descending);
+            btree_iterator it = { 0 };
+            i32 key = 0;
+            i32 expected = 0;
+            bool in_order = true;
+            bool valid = false;
+
+            for (i32 i = 0 ; i < data->nb_keys ; i++) {
+                key = (i * 37) % data->nb_keys;
+                tst_assert(btree_insert(make_system_allocator(), tree, &key, nullptr), "insertion of %d failed", key);
+            }
+
+            expected = data->nb_keys - 1;
+            for (valid = btree_first(tree, &it) ; valid ; valid = btree_iterator_next(&it)) {
+                in_order = in_order && (*(const i32 *) btree_iterator_key(&it) == expected);
+                expected -= 1;
+            }
+            tst_assert(in_order, "keys are not iterated in descending order");
+            tst_assert_equal(-1, expected, "last expected key of %d");
+
+            key = data->nb_keys / 2;
+            tst_assert(btree_remove(make_system_allocator(), tree, &key, nullptr), "removal of %d failed", key);
+            tst_assert(btree_lower_bound(tree, &key, &it), "no lower bound for %d", key);
+            tst_assert_equal(key - 1, *(const i32 *) btree_iterator_key(&it), "lower bound of %d");
+
+            btree_destroy(make_system_allocator(), &tree);
+        }
+)
+
+tst_CREATE_TEST_CASE(btree_comparator_keys_nominal, btree_comparator_keys,
+        .nb_keys = 1000,
+)
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+void btree_execute_unittests(void)
+{
+    tst_run_test_case(btree_ordered_map_small);
+    tst_run_test_case(btree_ordered_map_large);
+    tst_run_test_case(btree_ordered_map_sequential);
+    tst_run_test_case(btree_comparator_keys_nominal);
+}
+
+#endif